@@ -0,0 +1,262 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file async_io.h
+/// \brief building blocks of the asynchronous streams: aligned buffers, O_DIRECT files and a lock-free buffer ring
+///
+/// An O_DIRECT transfer bypasses the page cache, but requires the buffer address, the file offset and the length to be aligned.
+/// The streams thus transfer whole units of lcm(DIRECT_IO_ALIGN, sizeof(value_type)) bytes,
+/// such that a buffer boundary never splits an element.
+/// If the file system refuses O_DIRECT, the file is opened for buffered I/O instead.
+///
+/// \author Yi Wu
+/// \date 2017.1
+///////////////////////////////////////////////////////////
+
+#ifndef __ASYNC_IO_H
+#define __ASYNC_IO_H
+
+#include "common.h"
+
+#include <algorithm>
+
+#include <atomic>
+
+#include <cerrno>
+
+#include <cstdio>
+
+#include <cstdlib>
+
+#include <iostream>
+
+#include <string>
+
+#include <thread>
+
+#include <fcntl.h>
+
+#include <unistd.h>
+
+NAMESPACE_UTILITY_BEG
+
+static const uint64 DIRECT_IO_ALIGN = 4096; ///< alignment of O_DIRECT transfers in bytes
+
+/// \brief number of bytes in a transfer unit, a multiple of both DIRECT_IO_ALIGN and _elem_size
+inline uint64 direct_io_unit(const uint64 _elem_size) {
+
+	uint64 a = DIRECT_IO_ALIGN, b = _elem_size;
+
+	while (b != 0) {
+
+		const uint64 r = a % b;
+
+		a = b, b = r;
+	}
+
+	return DIRECT_IO_ALIGN / a * _elem_size;
+}
+
+/// \brief allocate _bytes bytes aligned to DIRECT_IO_ALIGN
+inline char* aligned_alloc_bytes(const uint64 _bytes) {
+
+	void* ptr = nullptr;
+
+	if (posix_memalign(&ptr, DIRECT_IO_ALIGN, std::max<uint64>(_bytes, 1)) != 0) {
+
+		std::cerr << "posix_memalign failed\n";
+
+		std::exit(EXIT_FAILURE);
+	}
+
+	return static_cast<char*>(ptr);
+}
+
+/// \brief release memory allocated by aligned_alloc_bytes
+inline void aligned_free_bytes(char* _ptr) {
+
+	std::free(_ptr);
+}
+
+/// \brief open a file for O_DIRECT transfers, or for buffered I/O if the file system refuses O_DIRECT
+///
+/// \param _flags flags of open() besides O_DIRECT
+/// \param _is_direct set to whether O_DIRECT is in effect
+inline int open_direct(const std::string& _fn, const int _flags, bool& _is_direct) {
+
+	int fd = open(_fn.c_str(), _flags | O_DIRECT, 0644);
+
+	_is_direct = (fd != -1);
+
+	if (fd == -1 && errno == EINVAL) fd = open(_fn.c_str(), _flags, 0644);
+
+	if (fd == -1) {
+
+		std::perror(_fn.c_str());
+
+		std::exit(EXIT_FAILURE);
+	}
+
+	return fd;
+}
+
+/// \brief total bytes read by the asynchronous streams, the bucket readers and the bucket queues, which are not counted by stxxl
+///
+/// The reads are counted as they complete, including those of the chunks never consumed.
+inline std::atomic<uint64>& io_read_volume() {
+
+	static std::atomic<uint64> volume(0);
+
+	return volume;
+}
+
+/// \brief total bytes written by the asynchronous streams and the bucket queues, which are not counted by stxxl
+inline std::atomic<uint64>& io_write_volume() {
+
+	static std::atomic<uint64> volume(0);
+
+	return volume;
+}
+
+/// \brief read _bytes bytes at _offset unless the end of file is met, return the number of bytes read, which are counted in io_read_volume()
+inline uint64 pread_full(const int _fd, char* _dst, const uint64 _bytes, const uint64 _offset, const std::string& _fn) {
+
+	uint64 done = 0;
+
+	while (done < _bytes) {
+
+		const ssize_t ret = pread(_fd, _dst + done, _bytes - done, _offset + done);
+
+		if (ret == 0) break; // end of file
+
+		if (ret < 0) {
+
+			if (errno == EINTR) continue;
+
+			std::perror(_fn.c_str());
+
+			std::exit(EXIT_FAILURE);
+		}
+
+		done += ret;
+	}
+
+	io_read_volume().fetch_add(done, std::memory_order_relaxed);
+
+	return done;
+}
+
+/// \brief lock-free handoff of a ring of buffers between one producer and one consumer
+///
+/// The producer fills the buffers in the order 0, 1, ..., size - 1, 0, ... and the consumer drains them in the same order.
+/// Two counters suffice: the number of buffers published and the number released.
+/// Each counter is written by one side only, and a release store on it publishes the buffer content to the other side.
+/// A waiting side spins briefly and then yields, no lock or condition variable is involved.
+class spsc_ring {
+
+private:
+
+	const uint64 m_size; ///< number of buffers
+
+	std::atomic<uint64> m_published; ///< number of buffers filled by the producer
+
+	char m_pad[64]; ///< keep the two counters in separate cache lines, alignas is not honored by new in C++11
+
+	std::atomic<uint64> m_released; ///< number of buffers drained by the consumer
+
+	std::atomic<bool> m_closed; ///< the producer publishes no more buffers
+
+	std::atomic<bool> m_stopped; ///< the consumer drains no more buffers
+
+	/// \brief back off while waiting
+	static void pause(uint64& _spins) {
+
+		if (++_spins < 64) return;
+
+		std::this_thread::yield();
+	}
+
+public:
+
+	/// \brief ctor
+	spsc_ring(const uint64 _size) : m_size(_size), m_published(0), m_released(0), m_closed(false), m_stopped(false) {}
+
+	/// \brief number of buffers
+	uint64 size() const {
+
+		return m_size;
+	}
+
+	/// \brief producer: wait for a free buffer and return its index, return false if the consumer has stopped
+	bool acquire_free(uint64& _slot) {
+
+		const uint64 published = m_published.load(std::memory_order_relaxed);
+
+		for (uint64 spins = 0; published - m_released.load(std::memory_order_acquire) == m_size; pause(spins)) {
+
+			if (m_stopped.load(std::memory_order_acquire)) return false;
+		}
+
+		_slot = published % m_size;
+
+		return !m_stopped.load(std::memory_order_acquire);
+	}
+
+	/// \brief producer: get the index of the _ahead-th free buffer after the one to be published next without waiting,
+	/// return false if not free yet or the consumer has stopped
+	///
+	/// The producer may fill several buffers at once, e.g., by reads in flight, but publishes them in order.
+	bool try_acquire_free(const uint64 _ahead, uint64& _slot) {
+
+		const uint64 published = m_published.load(std::memory_order_relaxed);
+
+		if (published + _ahead - m_released.load(std::memory_order_acquire) >= m_size) return false;
+
+		_slot = (published + _ahead) % m_size;
+
+		return !m_stopped.load(std::memory_order_acquire);
+	}
+
+	/// \brief producer: hand the buffer acquired last to the consumer
+	void publish() {
+
+		m_published.store(m_published.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	/// \brief producer: no more buffers
+	void close() {
+
+		m_closed.store(true, std::memory_order_release);
+	}
+
+	/// \brief consumer: wait for the next full buffer and return its index, return false if the producer has closed and all are drained
+	bool acquire_full(uint64& _slot) {
+
+		const uint64 released = m_released.load(std::memory_order_relaxed);
+
+		for (uint64 spins = 0; m_published.load(std::memory_order_acquire) == released; pause(spins)) {
+
+			if (m_closed.load(std::memory_order_acquire) && m_published.load(std::memory_order_acquire) == released) return false;
+		}
+
+		_slot = released % m_size;
+
+		return true;
+	}
+
+	/// \brief consumer: return the buffer acquired last to the producer
+	void release() {
+
+		m_released.store(m_released.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	/// \brief consumer: stop draining, the producer then quits
+	void stop() {
+
+		m_stopped.store(true, std::memory_order_release);
+	}
+};
+
+NAMESPACE_UTILITY_END
+
+#endif // __ASYNC_IO_H
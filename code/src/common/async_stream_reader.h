@@ -5,6 +5,11 @@
 ///
 /// \brief read elements from disk file using asychronous I/O operations
 ///
+/// An I/O thread loads a range of the file into a ring of buffers, while the main thread processes the buffers already loaded.
+/// The buffers are handed over by a lock-free ring (see async_io.h), thus loading the next buffer overlaps the processing of the current one.
+/// The file is opened with O_DIRECT and read by aligned transfers, such that a scan does not pollute the page cache.
+/// The range is streamed either from left to right or from right to left.
+///
 /// \author Yi Wu
 /// \date 2016.12
 ///////////////////////////////////////////////////////////
@@ -16,356 +21,400 @@
 
 #include "basicio.h"
 
-#include <algorithm>
+#include "async_io.h"
 
-#include <condition_variable>
+#include "uring_io.h"
 
-#include <mutex>
+#include <algorithm>
+
+#include <string>
 
 #include <thread>
 
+#include <vector>
+
 NAMESPACE_UTILITY_BEG
 
-/// \brief read buffer
-template<typename T>
-struct buffer {
-		
-	T* m_content; ///< pointer to buffer payload
-		
-	uint64 m_size; ///< size of buffer
-		
-	uiint64 m_filled; ///< number of elements in buffer
+/// \brief read data from an external disk file using asynchronous stream
+///
+/// I/O thread continually do the following steps:
+/// (1) retrieve a free buffer from the ring
+/// (2) load the next transfer of the range into the buffer
+/// (3) publish the buffer to the main thread
+/// main thread reads elements as following: if current buffer is not finished reading, then read the next element;
+/// otherwise, release current buffer to the ring and retrieve the next full one.
+///
+/// \note the interface is stxxl-like, i.e., empty(), operator* and operator++, such that the reader replaces a bufreader of a vector
+template<typename value_type>
+class async_stream_reader{
 
-	/// \brief constructor
-	///
-	/// \param _size size of buffer
-	buffer(uint64 _size) {
+private:
 
-		m_size = _size;
+	std::string m_fn; ///< file name
 
-		m_content = new T[m_size];
+	int m_fd; ///< file descriptor
 
-		m_filled = 0;
-	}
+	bool m_reverse; ///< stream from right to left
 
-	/// \brief read a data block from a disk file
-	///
-	/// \param _f file descriptor
-	void read_from_file(std::FILE* _f) {
+	uint64 m_beg; ///< first element of the range
 
-		m_filled = BasicIO::read_from_file(m_content, sizeof(T), m_size, _f);
+	uint64 m_end; ///< last element of the range (exclusive)
 
-		return;
-	}
+	uint64 m_lo; ///< first byte of the aligned range
 
+	uint64 m_hi; ///< last byte of the aligned range (exclusive)
 
-	/// \brief total size of elements in buffer 
-	uint64 size_in_bytes() const {
+	uint64 m_buf_bytes; ///< bytes per buffer, a multiple of the transfer unit
 
-		return sizeof(T) * m_filled;
-	}
+	bool m_use_uring; ///< read by io_uring if the kernel supports it
 
-	/// \brief dtor
-	~buffer() {
+	std::vector<char*> m_buf; ///< aligned buffers
 
-		delete[] m_content;
-	}
-};
+	std::vector<uint64> m_buf_base; ///< index of the element at the start of each buffer
 
-/// \brief queue of buffers
-///
-/// Buffers are orgainzed as a queue. Based on the producer-consumer mechanism,
-/// data are read into buffers and processed in the RAM.
-template<typename buffer_type>
-struct buffer_queue{
+	std::vector<uint64> m_buf_first; ///< index of the first element of the range in each buffer
 
-	std::queue<buffer_type*> m_queue; ///< FIFO queue
-		
-	std::condition_variable m_cv; ///< condition variable for the queue
+	std::vector<uint64> m_buf_num; ///< number of elements of the range in each buffer
 
-	std::mutex m_mutex; ///< mutex for the queue
-	
-	bool m_no_more_full_buffer_signal; ///< no more full buffer will be created
+	spsc_ring m_ring; ///< handoff of the buffers
 
-	/// \brief constructor
-	/// \param _bufnum number of buffers in the queue
-	/// \param _bufsize size of each buffer
-	buffer_queue(uint64 _bufnum = 0, uint64 _bufsize = 0) {
+	std::atomic<uint64> m_bytes_read; ///< number of bytes already read
+
+	std::thread* m_io_thread; ///< io thread
+
+	const value_type* m_cur; ///< current element
 
-		m_no_more_full_buffer_signal = false;
+	uint64 m_cur_left; ///< number of elements left in current buffer, including the current one
 
-		for (uint64 i = 0; i < _bufnum; ++i) {
+	bool m_is_holding; ///< current buffer is acquired from the ring
+
+	bool m_is_empty; ///< all the elements are read
+
+private:
+
+	/// \brief byte range [_chunk_beg, _chunk_end) of the _k-th transfer, which is aligned
+	void chunk_range(const uint64 _k, uint64& _chunk_beg, uint64& _chunk_end) const {
+
+		if (m_reverse) {
+
+			_chunk_end = m_hi - _k * m_buf_bytes, _chunk_beg = (_chunk_end - m_lo > m_buf_bytes) ? _chunk_end - m_buf_bytes : m_lo;
+		}
+		else {
 
-			m_queue.push(new buffer_type(_bufsize));
+			_chunk_beg = m_lo + _k * m_buf_bytes, _chunk_end = std::min(m_hi, _chunk_beg + m_buf_bytes);
 		}
 	}
-	
-	/// \brief destructor
-	~buffer_queue() {
 
-		while (!m_queue.empty()) {
+	/// \brief record the elements of the range loaded into the buffer, _got bytes are read from _chunk_beg
+	void fill_buffer(const uint64 _slot, const uint64 _chunk_beg, const uint64 _chunk_end, const uint64 _got) {
+
+		const uint64 elem_size = sizeof(value_type);
+
+		// collect I/O information
+		m_bytes_read.fetch_add(_got, std::memory_order_relaxed);
 
-			buffer_type* buf = m_queue.front();
+		const uint64 base = _chunk_beg / elem_size, first = std::max(base, m_beg), last = std::min((_chunk_beg + _got) / elem_size, m_end);
 
-			m_queue.pop();
+		if (last < std::min(_chunk_end / elem_size, m_end)) {
 
-			delete buf;
+			std::cerr << m_fn << ": unexpected end of file\n";
+
+			std::exit(EXIT_FAILURE);
 		}
+
+		m_buf_base[_slot] = base, m_buf_first[_slot] = first, m_buf_num[_slot] = last - first;
 	}
 
-	/// \brief use resource, lock must be obtained before calling the function
-	buffer_type* pop() {
+	/// \brief I/O procedure that load data into RAM using aysnchronous I/O operations
+	void io_procedure() {
 
-		buffer_type* front = m_queue.front();
+		const uint64 chunk_num = (m_beg < m_end) ? (m_hi - m_lo + m_buf_bytes - 1) / m_buf_bytes : 0;
 
-		m_queue.pop();
+		io_ring* uring = m_use_uring ? new io_ring(static_cast<unsigned>(m_ring.size())) : nullptr;
 
-		return front;
-	}
+		if (uring != nullptr && uring->is_ready()) {
 
-	/// \brief recycle resource, lock must be obtained during the calling 
-	void push(buffer_type* _buf) {
+			uring->register_buffers(m_buf, m_buf_bytes);
 
-		std::lock_guard<std::mutex> lk(m_mutex);
+			io_procedure_uring(*uring, chunk_num);
+		}
+		else {
 
-		m_queue.push(_buf);
+			io_procedure_pread(chunk_num);
+		}
+
+		delete uring; uring = nullptr;
+
+		m_ring.close();
 
 		return;
 	}
 
-	/// \brief I/O thread send the signal when it reaches the endofbits
-	void send_no_more_full_buffer_signal() {
+	/// \brief load the transfers one by one by blocking reads
+	void io_procedure_pread(const uint64 _chunk_num) {
 
-		std::lock_guard<std::mutex> lk(m_mutex);
+		for (uint64 k = 0; k < _chunk_num; ++k) {
 
-		m_no_more_full_buffer_signal = true;
+			uint64 chunk_beg, chunk_end, slot;
 
-		return;
-	}
+			chunk_range(k, chunk_beg, chunk_end);
 
-	/// \brief check if queue is empty
-	bool empty() const {
+			if (false == m_ring.acquire_free(slot)) return; // the main thread quits
 
-		return m_queue.empty();
+			fill_buffer(slot, chunk_beg, chunk_end, pread_full(m_fd, m_buf[slot], chunk_end - chunk_beg, chunk_beg, m_fn));
+
+			m_ring.publish();
+		}
 	}
-};
 
-/// \brief read data from an external disk file using asynchronous stream
-///
-/// I/O thread continually continually do the following steps: 
-/// (1) retrieve a buffer from empty-buffer queue
-/// (2) load data into buffer
-/// (3) put buffer into full-buffer queue
-/// main thread read elements as following: if current buffer is not finished read, then read the next element; otherwise, put current buffer into empty-buffer queue and retrieve a buffer from full-buffer queue.
-template<typename value_type>
-class async_stream_reader{
+	/// \brief keep a read in flight for every free buffer, and publish the buffers in order as their reads complete
+	///
+	/// A read failed or cut short by the ring is completed by a blocking read, e.g., if the kernel lacks the read operation.
+	void io_procedure_uring(io_ring& _uring, const uint64 _chunk_num) {
 
-private:
+		const uint64 size = m_ring.size();
 
-	//
-	std::FILE* m_file; ///< file pointer
+		std::vector<int64> got(size, -1); // bytes read into each buffer, -1 if in flight
 
-	uint64 m_bytes_read; ///< number of bytes already read
+		uint64 submitted = 0, published = 0;
 
-	uint64 m_cur_buffer_pos; ///<  pos of next element to be read in current buffer
+		bool is_stopped = false;
 
-	uint64 m_cur_buffer_filled; ///< number of elements in current buffer
+		while (published < submitted || (!is_stopped && submitted < _chunk_num)) {
 
-	buffer_type* m_cur_buffer; ///< pointer to current buffer
+			// submit a read for every free buffer, wait for one only if none is in flight
+			for (uint64 slot; !is_stopped && submitted < _chunk_num; ++submitted) {
 
-	std::thread* m_io_thread; ///< io thread
-	
-	uint64 m_items_toread; ///< number of items to read
+				if (submitted == published) {
 
-	uint64 m_items_read; ///< number of items read	
+					if (false == m_ring.acquire_free(slot)) { is_stopped = true; break; }
+				}
+				else if (false == m_ring.try_acquire_free(submitted - published, slot)) {
 
-	//
-	typedef buffer<value_type> buffer_type;
+					break;
+				}
 
-	typedef buffer_queue<value_type> buffer_queue_type;
+				uint64 chunk_beg, chunk_end;
 
-	buffer_queue_type* m_free_buffers; ///< queue of free buffers
+				chunk_range(submitted, chunk_beg, chunk_end);
 
-	buffer_queue_type* m_full_buffers; ///< queue of full buffers
+				got[slot] = -1;
 
-private:
+				if (false == _uring.prep_read(m_fd, m_buf[slot], chunk_end - chunk_beg, chunk_beg, slot, slot)) break;
+			}
 
+			if (published == submitted) continue;
 
-	/// \brief I/O procedure that load data into RAM using aysnchronous I/O operations
-	template<typename T>
-	static void io_procedure(async_stream_reader<T>* _caller) {
+			_uring.submit();
 
-		typedef buffer<T> buffer_type;
+			// reap the completions until the next buffer to publish is loaded
+			const uint64 next_slot = published % size;
 
-		m_items_read = 0;
+			while (got[next_slot] < 0) {
 
-		// if there exists elements remained to be read
-		while (true) {
+				uint64 slot;
 
-			// get lock to m_mutex of m_free_buffer
-			std::unique_lock<std::mutex> lk(_caller->m_free_buffers->m_mutex);
+				int64 res;
 
-			// wait for an empty buffer
-			while (_caller->m_free_buffers->empty()) {
+				if (false == _uring.wait(slot, res)) {
 
-				_caller->m_free_buffers->m_cv.wait(lk);
-			}
+					std::cerr << m_fn << ": io_uring failed\n";
 
-			// retrieve an empty buffer
-			buffer_type* buffer = _caller->m_free_buffers->pop(); 
+					std::exit(EXIT_FAILURE);
+				}
 
-			// unlock
-			lk.unlock();
+				got[slot] = std::max<int64>(0, res);
+			}
 
-			// fill the buffer
-			buffer->read_from_file(_caller->m_file);
+			uint64 chunk_beg, chunk_end;
 
-			// collect I/O information
-			_caller->m_bytes_read += buffer->size_in_bytes();
+			chunk_range(published, chunk_beg, chunk_end);
 
-			// accumulate
-			m_items_read += buffer->m_filled;
+			uint64 bytes = got[next_slot];
 
-			// append the buffer to m_full_buffers and notify main thread if it is waiting
-			_caller->m_full_buffers->push(buffer);
+			if (bytes < chunk_end - chunk_beg) { // failed or short, complete by a blocking read
 
-			_caller->m_full_buffers->m_cv.notify_one();
-			
-			// send signal to main thread, inform no more full buffers
-			if (m_items_toread == m_items_read) {
+				bytes += pread_full(m_fd, m_buf[next_slot] + bytes, chunk_end - chunk_beg - bytes, chunk_beg + bytes, m_fn);
+			}
 
-				_caller->m_full_buffers->send_no_more_full_buffer_signal();
+			fill_buffer(next_slot, chunk_beg, chunk_end, bytes);
 
-				_caller->m_full_buffers->m_cv.notify_one();
+			m_ring.publish();
 
-				break;
-			}					
+			++published;
 		}
 
 		return;
 	}
 
-public:
-
-	/// \brief get a full buffer
+	/// \brief release current buffer and get the next full buffer
 	void get_full_buffer() {
 
-		// recycle current buffer (finished processing)
-		if (m_cur_buffer != nullptr) {
+		if (m_is_holding) {
 
-			// push into queue
-			m_free_buffers->push(m_cur_buffer);
+			m_ring.release();
 
-			// notify the I/O thread if it is waiting for an free buffer
-			m_free_buffers->m_cv.notify_one();
-
-			m_cur_buffer = nullptr;
+			m_is_holding = false;
 		}
 
-		// obtain mutex
-		std::unique_lock<std::mutex> lk(m_full_buffers->m_mutex);
+		uint64 slot;
 
-		// wait if no full buffers and I/O thread may produce more full buffers
-		while(m_full_buffers->empty() && !(m_full_buffers->m_no_more_full_buffer_signal)) {
+		while (m_ring.acquire_full(slot)) {
 
-			m_full_buffers->m_cv.wait(lk);
-		}
+			if (m_buf_num[slot] == 0) { // no element of the range
 
-		m_cur_buffer_pos = 0;
+				m_ring.release();
 
-		if (m_full_buffers->empty()){ // no full buffers, m_cur_buffer_filled = 0
+				continue;
+			}
 
-			lk.unlock();
+			const value_type* content = reinterpret_cast<const value_type*>(m_buf[slot]);
 
-			m_cur_buffer_filled = 0;
-		}
-		else {
+			m_cur = content + (m_reverse ? m_buf_first[slot] + m_buf_num[slot] - 1 : m_buf_first[slot]) - m_buf_base[slot];
 
-			m_cur_buffer = m_full_buffers->pop(); // locked before calling the function
+			m_cur_left = m_buf_num[slot];
 
-			lk.unlock();
+			m_is_holding = true;
 
-			m_cur_buffer_filled = m_cur_buffer->m_filled;
+			return;
 		}
 
+		m_cur_left = 0;
+
+		m_is_empty = true;
+
 		return;
 	}
 
+	/// \brief move to the next element, get the next full buffer if current one is finished
+	void advance(const uint64 _num) {
 
+		m_cur = m_reverse ? m_cur - _num : m_cur + _num;
+
+		m_cur_left -= _num;
+
+		if (m_cur_left == 0) get_full_buffer();
+	}
 
 public:
 
-	/// \brief ctor, available buffer size is given, skip a number of bytes
+	/// \brief ctor, stream elements [_beg, _end) of the file
 	///
 	/// \param _fn filename
+	/// \param _beg first element
+	/// \param _end last element (exclusive)
+	/// \param _reverse stream from right to left
 	/// \param _avail_mem available memory in bytes
-	/// \param _bufnum number of buffers
-	/// \param _skip_bytes number of byts to skip
-	async_stream_reader(const std::string& _fn, const uint64& _avail_mem = (8ul << 20), const uint64& _bufnum = 4ul) {
+	/// \param _bufnum number of buffers, at least 2 for double buffering
+	/// \param _use_uring keep a read in flight per free buffer by io_uring, fall back to blocking reads if not supported
+	async_stream_reader(const std::string& _fn, const uint64 _beg, const uint64 _end, const bool _reverse, const uint64 _avail_mem = (8ul << 20), const uint64 _bufnum = 4ul, const bool _use_uring = false) :
+		m_fn(_fn),
+		m_reverse(_reverse),
+		m_beg(_beg),
+		m_end(std::max(_beg, _end)),
+		m_use_uring(_use_uring),
+		m_ring(std::max<uint64>(2, _bufnum)),
+		m_bytes_read(0),
+		m_cur(nullptr),
+		m_cur_left(0),
+		m_is_holding(false),
+		m_is_empty(false) {
+
+		const uint64 unit = direct_io_unit(sizeof(value_type));
 
-		m_items_toread = BasicIO::file_size(_fn) /  sizeof(value_type);
+		m_buf_bytes = std::max<uint64>(1, _avail_mem / m_ring.size() / unit) * unit;
 
-		m_file = BasicIO::file_open_nobuf(_fn.c_str(), "r");
+		m_lo = m_beg * sizeof(value_type) / unit * unit, m_hi = (m_end * sizeof(value_type) + unit - 1) / unit * unit;
 
-		m_bytes_read = 0;
+		m_buf.resize(m_ring.size());
 
-		m_cur_buffer_pos = 0;
+		for (uint64 i = 0; i < m_ring.size(); ++i) m_buf[i] = aligned_alloc_bytes(m_buf_bytes);
 
-		m_cur_buffer_filled = 0;
+		m_buf_base.resize(m_ring.size(), 0);
 
-		m_cur_buffer = nullptr;
+		m_buf_first.resize(m_ring.size(), 0);
 
-		uint64 bufsize = std::max(1ul, _avail_mem / sizeof(value_type) / _bufnum);
+		m_buf_num.resize(m_ring.size(), 0);
 
-		m_free_buffers = new buffer_queue_type(_bufnum, _bufsize); // initially, all buffers are empty
+		bool is_direct;
 
-		m_full_buffers = new buffer_queue_type();
+		m_fd = open_direct(m_fn, O_RDONLY, is_direct);
 
 		// start I/O thread
-		m_io_thread = new std::thread(io_procedure<value_type>, this);
+		m_io_thread = new std::thread(&async_stream_reader::io_procedure, this);
 
-		return;
-	}	
+		get_full_buffer();
+	}
+
+	/// \brief ctor, stream the whole file from left to right
+	async_stream_reader(const std::string& _fn, const uint64 _avail_mem = (8ul << 20), const uint64 _bufnum = 4ul) :
+		async_stream_reader(_fn, 0, BasicIO::file_size(_fn) / sizeof(value_type), false, _avail_mem, _bufnum) {}
+
+	/// \brief check if empty
+	bool empty() const {
+
+		return m_is_empty;
+	}
+
+	/// \brief current element
+	///
+	/// \note check if empty before calling the function
+	const value_type& operator*() const {
+
+		return *m_cur;
+	}
+
+	/// \brief current element
+	const value_type* operator->() const {
+
+		return m_cur;
+	}
+
+	/// \brief move to the next element
+	async_stream_reader& operator++() {
+
+		advance(1);
+
+		return *this;
+	}
 
 	/// \brief get next element in the stream
 	///
 	/// \note check if empty before calling the function
 	value_type read() {
 
-		if (m_cur_buffer_pos == m_cur_buffer_filled) {
+		const value_type val = *m_cur;
 
-			get_full_buffer(); // get full buffer
-		}
+		advance(1);
 
-		return m_cur_buffer->m_content[m_cur_buffer_pos++];
+		return val;
 	}
 
 	/// \brief read a sequence of items in the stream
-	/// 
+	///
 	/// \param _des target container
 	/// \param _num number of elements to be read
-	/// \note check if empty before calling the function
+	/// \note the stream must hold at least _num elements
 	void read(value_type* _des, uint64 _num) {
 
 		while (_num > 0) {
 
-			if (m_cur_buffer_pos == m_cur_buffer_filled) {
-
-				get_full_buffer(); // get next full buffer
-			}
-
-			uint64 tocopy = std::min(_num, m_cur_buffer_filled - m_cur_buffer_pos);
+			const uint64 tocopy = std::min(_num, m_cur_left);
 
-			for (uint64 i = 0; i < tocopy; ++i) {
+			if (m_reverse) {
 
-				des[i] = m_cur_buffer->m_content[m_cur_buffer_pos + i];
+				for (uint64 i = 0; i < tocopy; ++i) _des[i] = *(m_cur - i);
 			}
+			else {
 
-			m_cur_buffer_pos += tocopy;
+				std::copy(m_cur, m_cur + tocopy, _des);
+			}
 
-			des += tocopy;
+			_des += tocopy;
 
 			_num -= tocopy;
+
+			advance(tocopy);
 		}
 
 		return;
@@ -374,425 +423,131 @@ public:
 	/// \brief skip a sequence of elements in the stream
 	///
 	/// \param _num number of elements to be skipped
+	/// \note the stream must hold at least _num elements
 	void skip(uint64 _num) {
 
 		while (_num > 0) {
 
-			if (m_cur_buffer_pos == m_cur_buffer_filled) {
-
-				get_full_buffer(); 
-			}
-
-			uint64 toskip = std::min(_num, m_cur_buffer_filled - m_cur_buffer_pos);
-
-			m_cur_buffer_pos += toskip;
+			const uint64 toskip = std::min(_num, m_cur_left);
 
 			_num -= toskip;
-		}	
-
-		return;
-	}
-
-	/// \brief check if empty
-	bool empty() {
 
-		if (m_cur_buffer_pos == m_cur_buffer_filled) {
-
-			get_full_buffer();
-
-			if (m_cur_buffer_filled == 0) {
-
-				returnt true;
-			}
+			advance(toskip);
 		}
 
-		return false;
+		return;
 	}
 
 	/// \brief get read bytes
 	uint64 bytes_read() const {
 
-		return m_bytes_read;
+		return m_bytes_read.load(std::memory_order_relaxed);
 	}
 
 	/// \brief destructor
 	~async_stream_reader() {
 
-		m_io_thread->join();
-
-		delete m_free_buffers;
-
-		delete m_full_buffers;
+		m_ring.stop(); // the I/O thread quits if the stream is not read out
 
-		delete m_io_thread;
+		m_io_thread->join();
 
-		std::fclose(m_file);
+		delete m_io_thread; m_io_thread = nullptr;
 
-		if (m_cur_buffer != nullptr) {
+		close(m_fd);
 
-			delete m_cur_buffer;
-		}
+		for (uint64 i = 0; i < m_buf.size(); ++i) aligned_free_bytes(m_buf[i]);
 	}
-
 };
 
 
-/// \brief main thread read multiple disk files simultaneously. 
+/// \brief main thread read multiple disk files simultaneously.
 ///
-/// For the situation (such as mergesort), a set of buffers are 
+/// For the situation (such as mergesort), a set of buffers are
 /// established for each file and an I/O thread is created to continually load data into buffers for fast read by main thread.
 template<typename value_type>
 class async_multi_stream_reader{
-private:
-
-	typedef buffer<value_type> buffer_type;
-
-	typedef buffer_queue<buffer_type> buffer_queue_type;
-
-	uint64* m_bytes_read; ///< io statistics
-
-	uint64 m_bufsize; ///< size of buffer
-
-	uint64 m_bufnum; ///< number of buffers in a queue, orgained as an FIFO queue for each file
-	
-	uint64 m_filenum; ///< number of files
-
-	std::FILE **m_files; ///< pointers to files
-
-	buffer_queue_type** m_full_buffer_queues; ///< pointers to full buffer queues
-
-	buffer_queue_type** m_free_buffer_queues; ///< pointers to free buffer queues
-
-	std::thread **m_io_threads; ///< pointers to I/O threads
-
-	uint64* m_items_toread; ///< items to read in each file
-	
-	uint64* m_items_read; ///< items read in each file
-
-	uint64* m_cur_buffer_pos; ///<  position of next item to be read in current buffer for each file
-
-	uint64* m_cur_buffer_filled; ///< number of items in current buffer for each file
-
-	buffer_type** m_cur_buffer; ///< pointer to current buffer for each file
-	
 
 private:
 
-	/// \brief start an I/O thread for each disk file
-	///
-	/// \param _caller handler managed by main thread
-	/// \param _file_idx file index
-	template<typename T>
-	static void io_procedure(async_multi_stream_reader* _caller, const uint64& _file_idx) {
-
-		typedef buffer<T> buffer_type;
-
-		//
-		if (m_items_toread[_file_idx] == 0) return; // file is empty, no need to continue
-
-		//
-		m_items_read[_file_idx] = 0;
-
-		while(true) {
-
-			// get lock
-			std::unique_lock<std::mutex> lk(_caller->m_free_buffer_queues[_file_idx].m_mutex);
-
-			// wait for an empty buffer
-			while (_caller->m_free_buffer_queues[_file_idx].empty()) {
-
-				_caller->m_free_buffer_queues[_file_idx].m_cv.wait(lk);
-			}
-
-			// get an empty buffer
-			buffer_type* buffer = _caller->m_free_buffer_queues[_file_idx].pop();
-
-			lk.unlock();
-
-			// read a data block
-			buffer->read_from_file(_caller->m_files[_file_idx]);
-
-			// collect I/O information
-			_caller->m_bytes_read[_file_idx] += buffer->size_in_bytes();
-
-			//
-			m_items_read[_file_idx] += buffer->m_filled;
-
-			// recycle buffer and notify main thread		
-			_caller->m_full_buffer_queues[_file_idx].push(buffer);
-
-			_caller->m_full_buffer_queues[_file_idx].m_cv.notify_one();
-
-			// reach endofbit
-			if (m_items_read[_file_idx] == m_items_toread[_file_idx]) {
-
-				_caller->m_full_buffer_queues[_file_idx]->send_no_more_full_buffer_signal();
-
-				_caller->m_full_buffer_queues[_file_idx]->m_cv.notify_one();
-
-				break;
-			}
-		}
-
-		return;
-	}
-
-	/// \brief get a full buffer
-	void get_full_buffer(const uint64& _file_idx) {
-
-		// recycle current buffer if any
-		if (m_cur_buffer[_file_idx] != nullptr) {
-
-			// push into queue
-			m_empty_buffer_queues[_file_idx]->push(m_cur_buffer[_file_idx]);
-
-			//notify the I/O thread
-			m_empty_buffer_queues[_file_idx]->m_cv.notify_one();
-
-			m_cur_buffer[_file_idx] = nullptr;
-		}
-
-		// get mutex
-		std::unique_lock<std::mutex> lk(m_full_buffer_queues[_file_idx]->m_mutex);
-
-		// wait a full buffer
-		while(m_full_buffer_queues[_file_idx]->empty() && !(m_full_buffer_queues[_file_idx]->m_no_more_full_buffer_signal)) {
-	
-			m_full_buffer_queues[_file_idx]->m_cv.wait(lk);
-		}
-
-		m_cur_buffer_pos[_file_idx] = 0;
-
-		// get a full buffer
-		if (m_full_buffer_queues[_file_idx]->empty()) {
-
-			lk.unlock();
-		
-			m_cur_buffer_filled[_file_idx] = 0;
-		}
-		else {
-
-			m_cur_buffer[_file_idx] = m_full_buffers_queues[_file_idx]->pop();
-
-			lk.unlock();
-
-			m_cur_buffer_filled[_file_idx] = m_cur_buffer[_file_idx]->m_filled;
-		}
-
-		return;
-	}
+	typedef async_stream_reader<value_type> reader_type;
 
+	std::vector<reader_type*> m_readers; ///< one stream per file
 
 public:
 
 	/// \brief constructor
-	async_multi_stream_reader(const std::string& _fn_prefix, const uint64& _filenum, const uint64& _mem_avail = (8ul << 20), const uint64& _bufnum = 4ul) {
-
-		m_filenum = _filenum;
-
-		m_bufnum = _bufnum;
-
-		m_bufsize = std::max(1UL, _mem_avail / _filenum / _bufnum / sizeof(value_type));
-
-		//
-		m_bytes_read = new uint64[m_filenum];
-
-		m_items_toread = new uint64[m_filenum];
-	
-		m_items_read = new uint64[m_filenum];
-
-		m_files = new std::FILE*[m_filenum];
-
-		m_cur_buffer_pos = new uint64[m_filenum];
-
-		m_cur_buffer_filled = new uint64[m_filenum];
-
-		m_cur_buffer = new buffer_type*[m_filenum];
-
-		m_full_buffer_queues = new buffer_queue_type*[m_filenum];
-
-		m_free_buffer_queues = new buffer_queue_type*[m_filenum];
-
-		m_io_threads = new std::thread*[m_filenum];
-
-		for (uint64 i = 0; i < m_filenum; ++i) {
-	
-			//
-			m_bytes_read[i] = 0;
-		
-			//
-			std::string fn = _fn_prefix.append(std::to_string(i)); // prefix + file_idx
-
-			m_items_toread[i] = BasicIO::file_size(_fn) / sizeof(value_type);
-	
-			//
-			m_items_read[i] = 0;
-
-			// 	
-			m_files[i] = BasicIO::file_open_nobuf(fn.c_str(), "r");
-
-			//
-			m_cur_buffer_pos[i] = 0;
+	///
+	/// \param _fn_prefix file i is named _fn_prefix + i
+	/// \param _filenum number of files
+	/// \param _mem_avail available memory in bytes, shared by the files
+	/// \param _bufnum number of buffers per file
+	async_multi_stream_reader(const std::string& _fn_prefix, const uint64 _filenum, const uint64 _mem_avail = (8ul << 20), const uint64 _bufnum = 4ul) {
 
-			//
-			m_cur_buffer_filled[i] = 0;
-			
-			//
-			m_cur_buffer[i] = nullptr;
+		const uint64 mem_per_file = std::max<uint64>(1, _mem_avail / std::max<uint64>(1, _filenum));
 
-			//
-			m_full_buffer_queues[i] = new buffer_queue_type(m_bufnum, m_bufsize);
+		for (uint64 i = 0; i < _filenum; ++i) {
 
-			m_free_buffer_queues[i] = new buffer_queue_type();
-		
-			//
-			m_io_threads[i] = new std::thread(io_procedure<value_type>, this, i);
+			m_readers.push_back(new reader_type(_fn_prefix + std::to_string(i), mem_per_file, _bufnum));
 		}
 	}
 
-public:
-
-	/// \brief read an element	
+	/// \brief read an element
 	///
 	/// \param _file_idx file index, start from 0
 	/// \note check if the stream is empty before calling the function
-	value_type read(const uint64& _file_idx) {
-
-		if (m_cur_buffer_pos[_file_idx] == m_cur_buffer_filled[_file_idx]) {
-
-			get_full_buffer(_file_idx);
-		}
+	value_type read(const uint64 _file_idx) {
 
-		return m_cur_buffer[_file_idx]->m_content[m_cur_buffer_pos++];
+		return m_readers[_file_idx]->read();
 	}
 
 	/// \brief read a sequence of elements
 	///
 	/// \param _file_idx file index
 	/// \param _des destination array
-	/// \param _num _number of files to read
-	/// \note check if the stream is empty before calling the function
-	void read(const uint64& _file_idx, value_type* _des, uint64 _num) {
-
-		while (_num > 0) {
-
-			if (m_cur_buffer_pos[_file_idx] == m_cur_buffer_filled[_file_idx]) {
+	/// \param _num number of elements to read
+	void read(const uint64 _file_idx, value_type* _des, const uint64 _num) {
 
-				get_full_buffer(_file_idx);
-			}
-
-			uint64 tocopy = std::min(_num, m_cur_buffer_filled[_file_idx] - m_cur_buffer_pos[_file_idx]);
-
-			for (uint64 i = 0; i < tocopy; ++i) {
-
-				_des[i] = m_cur_buffer[_file_idx]->m_content[m_cur_buffer_pos + i];
-			}
-
-			m_cur_buffer_pos[_file_idx] += tocopy;
-
-			_des += tocopy;
-
-			_num -= tocopy;
-		}
-
-		return;
-	}	
+		m_readers[_file_idx]->read(_des, _num);
+	}
 
 	/// \brief skip a sequence of elements
-	/// 
+	///
 	/// \param _file_idx file index
 	/// \param _num number of elements to skip
-	/// \note check if the stream is empty before calling the function
-	void skip(const uint64& _file_idx, uint64 _num) {
+	void skip(const uint64 _file_idx, const uint64 _num) {
 
-		while (_num > 0) {
-
-			if (m_cur_buffer_pos[_file_idx] == m_cur_buffer_filled[_file_idx]) {
-
-				get_full_buffer(_file_idx);
-			}
-
-			uint64 toskip = std::min(_num, m_cur_buffer_filled[_file_idx] - m_cur_buffer_pos[_file_idx]);
-
-			m_cur_buffer_pos[_file_idx] += toskip;
-
-			_num -= toskip;	
-		}
-		
-		return;
+		m_readers[_file_idx]->skip(_num);
 	}
 
 	/// \brief report bytes read
-	uint64 bytes_read() {
+	uint64 bytes_read() const {
 
 		uint64 total_bytes_read = 0;
 
-		for (uint64 i = 0; i < m_filenum; ++i) {
+		for (uint64 i = 0; i < m_readers.size(); ++i) {
 
-			total_byts_read += m_byts_read[i];			
+			total_bytes_read += m_readers[i]->bytes_read();
 		}
 
 		return total_bytes_read;
 	}
 
-	/// \brief check if the stream is empty (reach endofit)
-	bool empty(const uint64& _file_idx) {
-
-		if (m_cur_buffer_pos[_file_idx] == m_cur_buffer_filled[_file_idx]) {
-
-			get_full_buffer(_file_idx);
-
-			if (m_cur_buffer_filled[_file_idx] == 0) return true;
-		}
-
-		return false;
+	/// \brief check if the stream is empty
+	bool empty(const uint64 _file_idx) const {
 
+		return m_readers[_file_idx]->empty();
 	}
 
 	/// \brief destructor
-	~async_multi_stream_vbyte_reader() {
-
-		// wait for I/O to finish
-		for (uint64 i = 0; i < m_filenum; ++i) {
+	~async_multi_stream_reader() {
 
-			m_io_threads[i]->join();
+		for (uint64 i = 0; i < m_readers.size(); ++i) {
 
-			delete m_io_threads[i];
-
-			delete m_full_buffer_queues[i];
-
-			delete m_free_buffer_queues[i];
-
-			std::fclose(m_files[i]);
-
-			delete m_files[i];
-
-			if (m_cur_buffer[i] != nullptr) {
-
-				delete m_cur_buffer[i];
-			}
+			delete m_readers[i]; m_readers[i] = nullptr;
 		}
-
-		delete[] m_bytes_read;
-
-		delete[] m_io_threads;
-
-		delete[] m_full_buffer_queues;
-
-		delete[] m_free_buffer_queues;
-
-		delete[] m_files;
-		
-		delete[] m_cur_buffer;	
-	
-		delete[] m_items_toread;
-
-		delete[] m_items_read;
-
-		delete[] m_cur_buffer_pos;
-
-		delete[] m_cur_buffer_filled;	
 	}
 };
 
-#endif
+NAMESPACE_UTILITY_END
+
+#endif // __ASYNC_STREAM_READER_H
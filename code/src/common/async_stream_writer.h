@@ -3,9 +3,14 @@
 /// All rights reserved
 /// \file async_stream_writer.h
 ///
-/// \brief write elements into disk file using asynchronous I/O operations. 
-/// 
-///   
+/// \brief write elements into disk file using asynchronous I/O operations.
+///
+/// The main thread fills a ring of aligned buffers, while an I/O thread writes the full ones to the file.
+/// The buffers are handed over by a lock-free ring (see async_io.h), thus producing the next buffer overlaps writing the current one.
+/// The file is written by O_DIRECT transfers except the unaligned tail, which is written after clearing O_DIRECT.
+/// A failed write is recorded by the I/O thread and reported by finish(), the remaining elements are then discarded.
+/// finish() returns once all the buffers are handed to the kernel, no fsync is issued.
+///
 /// \author Yi Wu
 /// \date 2016.12
 ///////////////////////////////////////////////////////////
@@ -13,356 +18,247 @@
 #ifndef __ASYNC_STREAM_WRITER_H
 #define __ASYNC_STREAM_WRITER_H
 
-#include "common/common.h"
+#include "common.h"
 
-#include "basicio.h"
+#include "async_io.h"
 
 #include <algorithm>
 
-#include <condition_variable>
-
-#include <mutex>
+#include <string>
 
 #include <thread>
 
+#include <vector>
+
 NAMESPACE_UTILITY_BEG
 
+/// \brief write data into a disk file using an asynchronous stream
+///
+/// main thread writes elements as following: if current buffer is not full, then append the element;
+/// otherwise, publish current buffer to the ring and retrieve a free one.
+/// I/O thread continually do the following steps:
+/// (1) retrieve a full buffer from the ring
+/// (2) write the buffer to the file at the next offset
+/// (3) release the buffer to the main thread
+template<typename value_type>
+class async_stream_writer{
 
-/// \brief buffer structure 
-template<typename T>
-struct buffer{
-		
-	T* m_content; ///< payload
+private:
 
-	uint64 m_size; ///< size of buffer
+	std::string m_fn; ///< file name
 
-	uint64 m_filled; ///< number of elements in buffer
+	int m_fd; ///< file descriptor
 
-	/// \brief default ctor
-	///
-	/// \param _size buffer size
-	buffer(uint64 _size) {
+	uint64 m_buf_cap; ///< number of elements per buffer, the buffer bytes are a multiple of the transfer unit
 
-		m_size = size;
-	
-		m_content = new T[m_size];
+	std::vector<char*> m_buf; ///< aligned buffers
 
-		m_filled = 0;
-	}
+	std::vector<uint64> m_buf_num; ///< number of elements in each published buffer
 
-	/// \brief write to file
-	///
-	/// \param _f file descriptor
-	void write_to_file(std::FILE* _f) {
+	spsc_ring m_ring; ///< handoff of the buffers
 
-		BasicIO::write_to_file(m_content, m_filled, _f);
+	std::atomic<uint64> m_bytes_written; ///< number of bytes already written
 
-		m_filled = 0;
-	}
-		
-	/// \brief dtor
-	~buffer() {
+	std::atomic<int> m_error; ///< errno of the first failed write, 0 if none
 
-		delete[] m_content;
-	}
-
-	/// \brief return occupied space (in bytes) in buffer
-	uint64 size_in_bytes() const {
+	std::thread* m_io_thread; ///< io thread
 
-		return sizeof(T) * m_filled;
-	}
+	value_type* m_cur; ///< current buffer, nullptr after finish()
 
-	/// \brief remaing space in the buffer
-	uint64 free_space() const {
+	uint64 m_cur_slot; ///< index of current buffer
 
-		return m_size - m_filled;
-	}
-};
+	uint64 m_cur_filled; ///< number of elements in current buffer
 
+private:
 
-/// \brief buffer queue
-template<typename buffer_type>
-struct buffer_queue{
-	
-	std::queue<buffer_type*> m_queue; ///< buffer queue
+	/// \brief I/O procedure that flush data into disk using aysnchronous I/O operations
+	void io_procedure() {
 
-	std::condition_variable m_cv; ///< condition variable
+		uint64 offset = 0, slot;
 
-	std::mutex m_mutex; ///< mutex
+		while (m_ring.acquire_full(slot)) {
 
-	bool m_no_more_full_buffer_signal; ///< main thread inform I/O thread
+			const uint64 bytes = m_buf_num[slot] * sizeof(value_type);
 
-	/// \brief a queue of write buffer
-	///
-	/// \param number of buffers
-	/// \param size of each buffer
-	buffer_queue(const uint64& _bufnum = 0, const uint64& _bufsize = 0) {
+			if (bytes % DIRECT_IO_ALIGN != 0) { // unaligned tail, only the last buffer
 
-		m_no_more_full_buffer_signal = false;
+				fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) & ~O_DIRECT);
+			}
 
-		for (uint64 i = 0; i < _bufnum; ++i) {
+			for (uint64 done = 0; done < bytes; ) {
 
-			m_queue.push(new buffer_type(_bufsize));
-		}
-	}
+				const ssize_t ret = pwrite(m_fd, m_buf[slot] + done, bytes - done, offset + done);
 
-	/// \brief dtor
-	~buffer_queue() {
+				if (ret < 0 && errno == EINTR) continue;
 
-		while(!m_queue.empty()) {
+				if (ret <= 0) {
 
-			buffer_type* buf = m_queue.front();
+					m_error.store((ret < 0) ? errno : EIO, std::memory_order_relaxed);
 
-			m_queue.pop();
+					m_ring.stop(); // discard the remaining buffers
 
-			delete buf;
-		}
-	}
+					return;
+				}
 
-	/// \brief pop the front buffer in the queue
-	///
-	/// \note lock is obtained before calling the function in the code
-	buffer_type* pop() {
+				done += ret;
+			}
 
-		buffer_type* front = m_queue.front();
+			offset += bytes;
 
-		m_queue.pop();
+			m_bytes_written.fetch_add(bytes, std::memory_order_relaxed);
 
-		return front;
-	}
+			io_write_volume().fetch_add(bytes, std::memory_order_relaxed);
 
-	/// \brief push a buffer
-	///
-	/// \param ptr to buffer
-	/// \note lock before pushing
-	void push(buffer_type* _buf) {
+			m_ring.release();
+		}
 
-		std::lock_guard<std::mutex> lk(m_mutex);
-			
-		m_queue.push(buf);
+		return;
 	}
 
-	/// \brief stop writting
-	/// \note lock before adapting
-	void send_no_more_full_buffer_signal() {
+	/// \brief publish current buffer and get a free buffer
+	void flush_buffer() {
 
-		std::lock_guard<std::mutex> lk(m_mutex);
+		m_buf_num[m_cur_slot] = m_cur_filled;
 
-		m_no_more_full_buffer_signal = true;
-	}
+		m_ring.publish();
 
-	/// \brief check if empty
-	bool empty() const {
-			
-		return m_queue.empty();
+		get_free_buffer();
 	}
-};
-
 
-/// \brief write data into a disk file using an asynchronous stream 
-template<typename value_type>
-class async_stream_writer{
+	/// \brief get a free buffer, reuse current one if the I/O thread has failed
+	void get_free_buffer() {
 
-private:
+		uint64 slot;
 
-	typedef buffer<value_type> buffer_type;
+		if (m_ring.acquire_free(slot)) m_cur_slot = slot;
 
-	typedef buffer_queue<buffer_type> buffer_queue_type;
+		m_cur = reinterpret_cast<value_type*>(m_buf[m_cur_slot]);
 
-	buffer_queue_type* m_free_buffers; ///< empty-buffer queue
-
-	buffer_queue_type* m_full_buffers; ///< full-buffer queue
-
-	std::FILE* m_file; ///< file handler
-
-	uint64 m_bytes_written; ///< I/O statistics
-
-	uint64 m_bufsize; ///< buffer size
-
-	buffer_type* m_cur_buffer; ///< pointer to current buffer 
-
-	std::thread* m_io_thread; ///< pointer to I/O thread
-
-private:
-
-	/// \brief I/O thread procedure
-	template<typename T>
-	static void io_procedure(async_stream_writer<T>* _caller) {
+		m_cur_filled = 0;
+	}
 
-		typedef buffer<T> buffer_type;
+public:
 
-		while(true) {
+	/// \brief constructor
+	///
+	/// \param _fn filename, truncated if exists
+	/// \param _avail_mem available memory in bytes
+	/// \param _bufnum number of buffers, at least 2 for double buffering
+	async_stream_writer(const std::string& _fn, const uint64 _avail_mem = (8ul << 20), const uint64 _bufnum = 4ul) :
+		m_fn(_fn),
+		m_ring(std::max<uint64>(2, _bufnum)),
+		m_bytes_written(0),
+		m_error(0),
+		m_cur_slot(0) {
 
-			// lock the full-buffer queue
-			std::unique_lock<std::mutex> lk(_caller->m_full_buffers->m_mutex);
+		const uint64 unit = direct_io_unit(sizeof(value_type));
 
-			// wait for a full buffer
-			while(_caller->m_full_buffers->empty() && !(_caller->m_full_buffers->m_no_more_full_buffer_signal)) {
+		const uint64 buf_bytes = std::max<uint64>(1, _avail_mem / m_ring.size() / unit) * unit;
 
-				_caller->m_full_buffers->m_cv.wait(lk);
-			}
+		m_buf_cap = buf_bytes / sizeof(value_type);
 
-			// if currently empty and no more full buffers
-			if (_caller->m_full_buffers->empty() && _caller->m_full_buffers->m_no_more_full_buffer_signal) {
+		m_buf.resize(m_ring.size());
 
-				lk.unlock();
+		for (uint64 i = 0; i < m_ring.size(); ++i) m_buf[i] = aligned_alloc_bytes(buf_bytes);
 
-				break;
-			}
+		m_buf_num.resize(m_ring.size(), 0);
 
-			// fetch a full-buffer 
-			buffer_type* buffer = _caller->m_full_buffers->pop();
+		bool is_direct;
 
-			lk.unlock();
+		m_fd = open_direct(m_fn, O_WRONLY | O_CREAT | O_TRUNC, is_direct);
 
-			// write to disk
-			buffer->write_to_file(_caller->m_file);
-	
-			// recycle and notify
-			_caller->m_free_buffers->push(buffer);
+		get_free_buffer();
 
-			_caller->m_free_buffers->m_cv.notify_one();
-		}
+		// start I/O thread
+		m_io_thread = new std::thread(&async_stream_writer::io_procedure, this);
 	}
-	
-	/// \brief get a free buffer
-	/// 
-	/// \note can always get an empty buffer
-	buffer_type* get_free_buffer() {
 
-		// lock
-		std::unique_lock<std::mutex> lk(m_free_buffers->m_mutex);
+	/// \brief write an element into stream
+	void write(const value_type& _item) {
 
-		// wait for an empty buffe
-		while(m_free_buffers->empty()) {
+		m_cur[m_cur_filled++] = _item;
 
-			m_free_buffers->m_cv.wait(lk);
-		}
+		if (m_cur_filled == m_buf_cap) flush_buffer();
+	}
 
-		// get an empty buffer
-		buffer_type* front = m_free_buffers->pop();
+	/// \brief write an element into stream
+	async_stream_writer& operator<<(const value_type& _item) {
 
-		// unlock
-		lk.unlock();
+		write(_item);
 
-		return front;
+		return *this;
 	}
 
-public:
-
-	/// \brief constructor
-	async_stream_writer(const std::string _fn, const uint64& _avail_mem = (8ul << 20), const uint64& _bufnum = 4ul, const std::string& _mode = std::string("w")) {
+	/// \brief write a sequence of items into the stream
+	void write(const value_type* _src, uint64 _num) {
 
-		m_file = BasicIO::file_open_nobuf(_fn.c_str(), _mode);
+		while (_num > 0) {
 
-		m_bufsize = std::max(1ul, _avail_mem / sizeof(value_type) / _bufnum);
+			const uint64 tocopy = std::min(_num, m_buf_cap - m_cur_filled);
 
-		m_free_buffers = new buffer_queue_type(_bufnum, _bufsize);
+			std::copy(_src, _src + tocopy, m_cur + m_cur_filled);
 
-		m_full_buffers = new buffer_queue_type();
+			m_cur_filled += tocopy;
 
-		// initialize empty buffer
-		m_cur_buffer = get_free_buffer();
+			_src += tocopy;
 
-		m_bytes_written = 0;
+			_num -= tocopy;
 
-		m_io_thread = new std::thread(consumer<value_type>, this);	
+			if (m_cur_filled == m_buf_cap) flush_buffer();
+		}
 	}
-	
-	/// \brief write an element into stream
-	void write(const value_type& _item) {
-
-		// collect I/O consumption
-		m_bytes_written += sizeof(value_type);
 
-		// fill
-		m_cur_buffer->m_content[m_cur_buffer->m_filled++] = _item;
+	/// \brief write the remaining elements and wait for the I/O thread, return false if a write failed
+	///
+	/// \note no element can be written afterwards
+	bool finish() {
 
-		// if full, then push full-buffer into m_full_buffers
-		if (m_cur_buffer->full()) {
+		if (m_io_thread == nullptr) return error() == 0;
 
-			m_full_buffers->push(m_cur_buffer); // lock
+		if (m_cur_filled != 0) {
 
-			m_full_buffers->m_cv.noify_one(); // notify
+			m_buf_num[m_cur_slot] = m_cur_filled;
 
-			m_cur_buffer = get_empty_buffer();
+			m_ring.publish();
 		}
 
-		return;
-	}
+		m_ring.close();
 
-	/// \brief write a sequence of items into the stream
-	void write(const value_type* _src, uint64 _num) {
-
-		// collect I/O consumption
-		m_bytes_written += _num * sizeof(value_type);
-
-		// fill
-		while (_num > 0) {
-		
-			uint64 tocopy = std::min(_num, m_cur_buffer->free_space());
-
-			std::copy(_src, _src + tocopy, m_cur_buffer->m_content + m_cur_buffer->m_filled);
-
-			m_cur_buffer->m_filled += tocopy;
+		m_io_thread->join();
 
-			_src += tocopy;
+		delete m_io_thread; m_io_thread = nullptr;
 
-			_num -= tocopy;
+		m_cur = nullptr, m_cur_filled = 0;
 
-			if (m_cur_buffer->full()) {
+		return error() == 0;
+	}
 
-				m_full_buffers->push(m_cur_buffer);
+	/// \brief errno of the first failed write, 0 if none
+	int error() const {
 
-				m_full_buffers->m_cv.notify_one();
+		return m_error.load(std::memory_order_relaxed);
+	}
 
-				m_cur_buffer = get_free_buffer();
-			}	
-		}	
+	/// \brief file name
+	const std::string& file_name() const {
 
-		return;
+		return m_fn;
 	}
 
 	/// \brief collect I/O bytes
 	uint64 bytes_written() const {
 
-		return m_byts_written;
+		return m_bytes_written.load(std::memory_order_relaxed);
 	}
 
 	/// \brief dtor
 	~async_stream_writer() {
 
-		// current buffer may be non-empty, flush it
-		if (!m_cur_buffer->empty()) {
+		finish();
 
-			m_full_buffers->push(m_cur_buffer);
+		close(m_fd);
 
-			m_full_buffers->m_cv.notify_one();
-
-			m_cur_buffer = nullptr;
-		}
-			
-		// send no more full buffer signal
-		m_full_buffers->send_no_more_full_buffer_signal();
-
-		m_full_buffers->m_cv.notify_one();
-
-		// join
-		m_io_thread->join();
-
-		// dealloc
-		delete m_empty_buffers;
-
-		delete m_full_buffers;
-
-		delete m_io_thread;
-
-		std::fclose(m_file);
-
-		if (m_cur_buffer != nullptr) {
-			
-			delete m_cur_buffer;
-		}
+		for (uint64 i = 0; i < m_buf.size(); ++i) aligned_free_bytes(m_buf[i]);
 	}
 };
 
@@ -376,190 +272,67 @@ class async_multi_stream_writer {
 
 private:
 
-	typedef buffer<value_type> buffer_type;
-
-	typedef buffer_queue_type<buffer_type> buffer_queue_type;
+	typedef async_stream_writer<value_type> writer_type;
 
-	uint64* m_bytes_written; ///< I/O statistics
-
-	uint64 m_filenum; ///< number of files
-
-	uint64 m_bufsize; ///< size of buffer
-
-	uint64 m_bufnum; ///< number of buffers in a buffer queue for each file
-
-	std::FILE** m_files; ///< handlers of files
-
-	buffer_type* cur_buffers; ///< pointer to current buffer for each file	
-
-	buffer_queue_type** m_full_buffer_queues; ///< full buffer queue
-
-	buffer_queue_type** m_free_buffer_queues; ///< free buffer queue
-	
-	std::thread** m_io_threads; ///< queue of io threads
-
-private:
-
-	/// \brief I/O thread that flush data into disk
-	template<typename T>
-	static void io_procedure(async_stream_writer<T>* _caller, const uint64& _file_idx) {
-
-		typedef buffer<T> buffer_type;
-
-		while (true) {
-
-			// lock
-			std::unique_lock<std::mutex> lk(_caller->m_full_buffer_queues[_file_idx]);
-
-			// wait for a full buffer
-			while (_caller->m_full_buffer_queues[_file_idx].empty() && !(_caller->m_full_buffer_queues[_file_idx].m_no_more_full_buffer_signal) {
-
-				_caller->m_full_buffer_queues[_file_idx].m_cv.wait(lk);
-			}
-			
-			// currently no full buffer and no more full buffer will be produced
-			if (_caller->m_full_buffer_queues[_file_idx].empty() && _caller->m_full_buffer_queues[_file_idx].m_no_more_full_buffer_signal) {
-
-				lk.unlock();
-
-				break;
-			}
-
-			// get a full buffer
-			buffer_type* buffer = _caller->m_full_buffer_queues[_file_idx]->pop();
-
-			lk.unlock();
-
-			// write to disk
-			buffer->write_to_file(_caller->m_files[_file_idx]);
-
-			// recycle
-			_caller->m_empty_buffer_queues[_file_idx]->push(buffer);
-
-			_caller->m_empty_buffer_queues[_file_idx]->m_cv.notify_one();
-		}
-
-		return;
-	}
-
-	/// \brief get a free buffer from the queue
-	buffer_type* get_free_buffer(const uint64& _file_idx) {
-
-		std::unique_lock<std::mutex> lk(m_free_buffer_queues[_file_idx].m_mutex);
-
-		while (m_free_buffer_queues[_file_idx].empty()) {
-
-			m_free_buffer_queues[_file_idx].m_cv.wait(lk);
-		}
-
-		buffer_type* front = m_free_buffer_queues[_file_idx].pop();
-
-		lk.unlock();
-
-		return front;
-	}
+	std::vector<writer_type*> m_writers; ///< one stream per file
 
 public:
 
 	/// \brief constructor
-	async_multi_stream_writer(const std::string& _fn_prefix, const uint64& _filenum, const uint64& _mem_avail = (8ul << 20), const uint64& _bufnum = 4ul) {
-
-		m_filenum = _filenum;
-
-		m_bufnum = _bufnum;
-
-		m_bufsize = std::max(1ul, _mem_avail / _filenum / _bufnum / sizeof(value_type));
-
-		//
-		m_bytes_written = new uint64[m_filenum];
-		
-		m_files = new std::FILE*[m_filenum];
-
-		m_cur_buffers = new buffer_type*[m_filnum];
-
-		m_full_buffer_queues = new buffer_queue_type*[m_filenum];
-			
-		m_free_buffer_queues = new buffer_queue_type*[m_filenum];
-
-		m_io_threads = new std::thread*[m_filenum];
-
-		for (uint64 i = 0; i < m_filenum; ++i) {
-
-			//
-			m_bytes_written[i] = 0;
-
-			//
-			m_files[i] = _f_arr[i];
+	///
+	/// \param _fn_prefix file i is named _fn_prefix + i
+	/// \param _filenum number of files
+	/// \param _mem_avail available memory in bytes, shared by the files
+	/// \param _bufnum number of buffers per file
+	async_multi_stream_writer(const std::string& _fn_prefix, const uint64 _filenum, const uint64 _mem_avail = (8ul << 20), const uint64 _bufnum = 4ul) {
 
-			m_cur_buffers[i] = get_empty_buffer(i);
+		const uint64 mem_per_file = std::max<uint64>(1, _mem_avail / std::max<uint64>(1, _filenum));
 
-			m_full_buffers_queues[i] = new buffer_queue_type(_bufnum, m_bufsize);
+		for (uint64 i = 0; i < _filenum; ++i) {
 
-			m_free_buffers_queues[i] = new buffer_queue_type();
-		
-			m_io_threads[i] = new std::thread(io_procedure<value_type>, this, i);
+			m_writers.push_back(new writer_type(_fn_prefix + std::to_string(i), mem_per_file, _bufnum));
 		}
 	}
 
-
 	/// \brief write an item
-	void write(const uint64& _file_id, const value_type& _item) {
+	void write(const uint64 _file_idx, const value_type& _item) {
 
-		m_bytes_write += sizeof(value_type);
-
-		m_cur_buffers[_file_id]->m_content[m_cur_buffers[_file_id]->m_filled++] = _item;
-
-		if (m_buffers[_file_id]->full()) {
-
-			m_full_buffers_queues[_file_id]->push(m_buffers[_file_id]);
-			
-			m_full_buffers_queues[_file_id]->m_cv.notify_one();
-
-			m_cur_buffers[_file_id] = get_free_buffer(_file_id); 
-		}		
-
-		return;
+		m_writers[_file_idx]->write(_item);
 	}
 
 	/// \brief write a sequence of items
-	void write(const uint64& _file_id, const value_type* _src, const uint64& _num) {
-	
-		m_byte_written += _num * sizeof(value_type);
-
-		while (_num > 0) {
-
-			uint64 tocopy = std::min(_num, m_cur_buffers[_file_id]->free_space());
-
-			std::copy(_src, _src + towrite, m_cur_buffers[_file_id]->m_content + m_cur_buffers[_file_id]->m_filled);
-
-			m_buffers[i]->m_filled += tocopy;
-
-			_num -= tocopy;
+	void write(const uint64 _file_idx, const value_type* _src, const uint64 _num) {
 
-			_src += tocopy;
+		m_writers[_file_idx]->write(_src, _num);
+	}
 
-			if (m_cur_buffers[_file_idx]->full()) {
+	/// \brief write the remaining elements of all the files, return false if a write failed
+	bool finish() {
 
-				m_full_buffer_queues[_file_id]->push(m_cur_buffers[_file_id]);
+		bool is_ok = true;
 
-				m_full_buffer_queues[_file_id]->m_cv.notify_one();
+		for (uint64 i = 0; i < m_writers.size(); ++i) {
 
-				m_cur_buffers[_file_id] = get_free_buffer(_file_id);
-			}
+			if (false == m_writers[i]->finish()) is_ok = false;
 		}
 
-		return;
+		return is_ok;
 	}
 
+	/// \brief errno of the first failed write of the file, 0 if none
+	int error(const uint64 _file_idx) const {
+
+		return m_writers[_file_idx]->error();
+	}
 
 	/// \brief return performed I/O in bytes
-	std::uint64 bytes_written() const {
+	uint64 bytes_written() const {
 
 		uint64 total_bytes_written = 0;
 
-		for (uint64 i = 0; i < m_filenum; ++i) {
-		
-			total_bytes_written += m_bytes_writte[i];			
+		for (uint64 i = 0; i < m_writers.size(); ++i) {
+
+			total_bytes_written += m_writers[i]->bytes_written();
 		}
 
 		return total_bytes_written;
@@ -568,65 +341,13 @@ public:
 	/// \brief destructor
 	~async_multi_stream_writer() {
 
-		// flush last non-empty buffers
-		for (uint64 i = 0; i < m_filenum; ++i) {
-
-			if (!(m_cur_buffers[i]->empty()) {
-
-				m_full_buffer_queues[i]->push(m_cur_buffers[i]);
-
-				std::unique_lock<std::mutex> lk(m_full_buffer_queues[i].m_mutex);
-
-				m_full_buffer_queues[i].m_no_more_full_buffer_signal = true;
+		for (uint64 i = 0; i < m_writers.size(); ++i) {
 
-				lk.unlock();
-
-				m_full_buffer_queues[i].notify_one();
-			}
-		}
-
-		// join
-		for (uint64 i = 0; i < m_filenum; ++i) {
-
-			m_io_threads[i]->join();
-		}
-	
-		// clear
-		for (uint64 i = 0; i < m_filenum; ++i) {
-
-			delete m_cur_buffers[i];
-
-			std::fclose(m_files[i]);
-
-			delete m_files[i];
-
-			delete m_full_buffer_queues[i];
-
-			delete m_free_buffer_queues[i];
-
-			delete m_io_threads[i];	
+			delete m_writers[i]; m_writers[i] = nullptr;
 		}
-
-		delete[] m_bytes_written;
-
-		delete[] m_cur_buffers;
-	
-		delete[] m_files;
-
-		delete[] m_full_buffer_queues;
-
-		delete[] m_free_buffer_queues;
-
-		delete[] m_io_threads;
-	}	
+	}
 };
 
-
 NAMESPACE_UTILITY_END
 
-
-
-
-
-
-#endif // __ASYNCIO_H
+#endif // __ASYNC_STREAM_WRITER_H
@@ -0,0 +1,261 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file bucket_queue.h
+/// \brief one FIFO queue per bucket, stored in the range of the bucket in a file
+///
+/// The elements pushed into a bucket occupy the consecutive positions of its range, from left to right (or right to left if reversed),
+/// and are popped in the same order. Thus the file ends up with every element at its position.
+/// Each bucket collects the pushed elements in a buffer, which is written back by a positioned write when full.
+/// Another buffer holds the elements to be popped, loaded by a positioned read.
+/// An element not written back yet is popped from the former buffer directly, such that each element is read at most once.
+/// The bytes read and written are added to utility::io_read_volume() and utility::io_write_volume().
+/// The buffers of a bucket take a share of the budget in proportion to the bucket size, but never more than the bucket.
+///
+/// \note The file must store the elements contiguously, as an stxxl vector mapped to a file does.
+///
+/// \author Yi Wu
+/// \date 2017.1
+///////////////////////////////////////////////////////////
+
+#ifndef __BUCKET_QUEUE_H
+#define __BUCKET_QUEUE_H
+
+#include "common.h"
+
+#include "async_io.h"
+
+#include <algorithm>
+
+#include <cstdio>
+
+#include <cstdlib>
+
+#include <string>
+
+#include <vector>
+
+#include <fcntl.h>
+
+#include <unistd.h>
+
+/// \brief file-backed queues for buckets
+///
+/// \param value_type type of elements
+template<typename value_type>
+class BucketQueuePool {
+
+private:
+
+	static const uint64 MIN_CHUNK = 4096; ///< minimum number of elements per buffer
+
+	/// \brief state of a bucket
+	struct Bucket {
+
+		uint64 beg; ///< first position of the range
+
+		uint64 num; ///< number of positions in the range
+
+		uint64 chunk; ///< capacity of each buffer
+
+		uint64 pushed; ///< number of elements pushed so far
+
+		uint64 popped; ///< number of elements popped so far
+
+		uint64 flushed; ///< number of elements written back so far
+
+		std::vector<value_type> in; ///< pushed elements not written back, i.e., the flushed-th to the (pushed - 1)-th ones
+
+		std::vector<value_type> out; ///< loaded elements, i.e., the out_beg-th to the (out_beg + out.size() - 1)-th ones
+
+		uint64 out_beg; ///< index of the first loaded element
+	};
+
+	std::string m_fn; ///< file name
+
+	int m_fd; ///< file descriptor
+
+	bool m_reverse; ///< fill each bucket from right to left
+
+	std::vector<Bucket> m_bkt; ///< buckets
+
+public:
+
+	/// \brief ctor
+	///
+	/// \param _fn file name, the file must cover all the ranges
+	/// \param _beg starting position of each bucket, in elements
+	/// \param _num number of elements in each bucket
+	/// \param _reverse fill each bucket from right to left
+	/// \param _budget memory budget in bytes
+	BucketQueuePool(const std::string& _fn, const std::vector<uint64>& _beg, const std::vector<uint64>& _num, const bool _reverse, const uint64 _budget) :
+		m_fn(_fn), m_reverse(_reverse) {
+
+		m_fd = open(m_fn.c_str(), O_RDWR);
+
+		if (m_fd == -1) {
+
+			std::perror(m_fn.c_str());
+
+			std::exit(EXIT_FAILURE);
+		}
+
+		uint64 total_num = 0;
+
+		for (uint64 i = 0; i < _num.size(); ++i) total_num += _num[i];
+
+		const uint64 budget = std::max<uint64>(1, _budget / sizeof(value_type));
+
+		m_bkt.resize(_num.size());
+
+		for (uint64 i = 0; i < _num.size(); ++i) {
+
+			Bucket& bkt = m_bkt[i];
+
+			bkt.beg = _beg[i], bkt.num = _num[i];
+
+			const uint64 share = (total_num == 0) ? 0 : static_cast<uint64>(static_cast<double>(budget) * _num[i] / total_num);
+
+			bkt.chunk = std::max<uint64>(1, std::min(_num[i], std::max(MIN_CHUNK, share / 2))); // two buffers per bucket
+
+			bkt.pushed = bkt.popped = bkt.flushed = bkt.out_beg = 0;
+		}
+	}
+
+	/// \brief dtor
+	~BucketQueuePool() {
+
+		close(m_fd);
+	}
+
+	/// \brief append an element to the specified bucket, return false if the bucket is full
+	bool push(const uint64 _bkt, const value_type& _val) {
+
+		Bucket& bkt = m_bkt[_bkt];
+
+		if (bkt.pushed == bkt.num) return false;
+
+		bkt.in.push_back(_val), ++bkt.pushed;
+
+		if (bkt.in.size() == bkt.chunk) flush(bkt);
+
+		return true;
+	}
+
+	/// \brief remove the first element of the specified bucket
+	///
+	/// \note the bucket must not be empty
+	value_type pop(const uint64 _bkt) {
+
+		Bucket& bkt = m_bkt[_bkt];
+
+		if (bkt.popped == bkt.pushed) {
+
+			std::cerr << m_fn << ": pop from an empty bucket\n";
+
+			std::exit(EXIT_FAILURE);
+		}
+
+		const uint64 idx = bkt.popped++;
+
+		if (idx >= bkt.flushed) return bkt.in[idx - bkt.flushed]; // not written back yet
+
+		if (idx >= bkt.out_beg + bkt.out.size()) { // load the next chunk
+
+			bkt.out_beg = idx;
+
+			bkt.out.resize(std::min(bkt.chunk, bkt.flushed - idx));
+
+			read_at(bkt, bkt.out, idx);
+		}
+
+		const value_type val = bkt.out[idx - bkt.out_beg];
+
+		if (bkt.popped == bkt.num) std::vector<value_type>().swap(bkt.out); // read out, release the buffer
+
+		return val;
+	}
+
+	/// \brief write back the elements remaining in the buffers, return false if some bucket is not full
+	bool finish() {
+
+		bool is_full = true;
+
+		for (uint64 i = 0; i < m_bkt.size(); ++i) {
+
+			flush(m_bkt[i]);
+
+			if (m_bkt[i].pushed != m_bkt[i].num) is_full = false;
+		}
+
+		return is_full;
+	}
+
+private:
+
+	/// \brief first position in the file of the elements indexed [_idx, _idx + _num) in the bucket
+	uint64 file_pos(const Bucket& _bkt, const uint64 _idx, const uint64 _num) const {
+
+		return m_reverse ? _bkt.beg + _bkt.num - _idx - _num : _bkt.beg + _idx;
+	}
+
+	/// \brief write back the buffered elements of the bucket
+	void flush(Bucket& _bkt) {
+
+		if (_bkt.in.empty()) return;
+
+		if (m_reverse) std::reverse(_bkt.in.begin(), _bkt.in.end());
+
+		write_at(_bkt.in, file_pos(_bkt, _bkt.flushed, _bkt.in.size()));
+
+		_bkt.flushed += _bkt.in.size();
+
+		_bkt.in.clear();
+
+		if (_bkt.flushed == _bkt.num) std::vector<value_type>().swap(_bkt.in); // full, release the buffer
+	}
+
+	/// \brief load _buf.size() elements starting from the _idx-th one of the bucket, in the popping order
+	void read_at(const Bucket& _bkt, std::vector<value_type>& _buf, const uint64 _idx) const {
+
+		const uint64 bytes = _buf.size() * sizeof(value_type);
+
+		if (utility::pread_full(m_fd, reinterpret_cast<char*>(_buf.data()), bytes, file_pos(_bkt, _idx, _buf.size()) * sizeof(value_type), m_fn) < bytes) {
+
+			std::cerr << m_fn << ": unexpected end of file\n";
+
+			std::exit(EXIT_FAILURE);
+		}
+
+		if (m_reverse) std::reverse(_buf.begin(), _buf.end());
+	}
+
+	/// \brief write the elements of _buf to the file starting at the _pos-th element
+	void write_at(const std::vector<value_type>& _buf, const uint64 _pos) const {
+
+		const char* src = reinterpret_cast<const char*>(_buf.data());
+
+		uint64 offset = _pos * sizeof(value_type), left = _buf.size() * sizeof(value_type);
+
+		while (left > 0) {
+
+			const ssize_t ret = pwrite(m_fd, src, left, offset);
+
+			if (ret <= 0) {
+
+				std::perror(m_fn.c_str());
+
+				std::exit(EXIT_FAILURE);
+			}
+
+			src += ret, offset += ret, left -= ret;
+		}
+
+		utility::io_write_volume().fetch_add(_buf.size() * sizeof(value_type), std::memory_order_relaxed);
+	}
+};
+
+template<typename value_type>
+const uint64 BucketQueuePool<value_type>::MIN_CHUNK;
+
+#endif // __BUCKET_QUEUE_H
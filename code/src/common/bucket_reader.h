@@ -0,0 +1,414 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file bucket_reader.h
+/// \brief read many disjoint ranges (buckets) of a file under one memory budget
+///
+/// One stxxl reader per bucket brings its own prefetch buffers, thus the memory grows with the number of buckets
+/// and a tiny bucket occupies as much memory as a huge one.
+/// Instead, BucketReaderPool keeps one buffer per bucket and refills it by a positioned read when drained.
+/// The first buffer of a bucket takes half of its share of the budget in proportion to the bucket size, but never more than the bucket.
+/// Afterwards, the share follows the consumption rate: a bucket drained while the pool handed out D elements in total
+/// gets buf.size() / D of the budget for its next buffer, thus the chunks of the hot buckets grow and those of the cold ones shrink.
+/// A chunk never exceeds the free budget. One element per bucket is held back from the chunks,
+/// such that a drained bucket finding no free budget still reads one element to make progress without exceeding the budget,
+/// as long as the budget is at least the number of buckets.
+/// A buffer is released once its bucket has been read out.
+///
+/// With io_uring, each bucket keeps the next chunk in flight in a second buffer while its current buffer is read,
+/// the reads of all the buckets share one ring and are submitted in batches. The positions of a chunk are reserved when it is queued.
+/// The second buffer is counted in the budget and is skipped if the free budget is too small for it.
+/// A read failed or cut short by the ring is completed by pread, which is also used if the kernel lacks io_uring.
+/// The bytes read either way are added to utility::io_read_volume() by the ring and by pread_full().
+///
+/// If the file is memory mapped (see mmap_io.h), the buckets are read from the mapping in place and no buffer is kept, the elements handed out are added to utility::mapped_read_volume().
+///
+/// \note The file must store the elements contiguously, as an stxxl vector mapped to a file does.
+///
+/// \author Yi Wu
+/// \date 2017.1
+///////////////////////////////////////////////////////////
+
+#ifndef __BUCKET_READER_H
+#define __BUCKET_READER_H
+
+#include "common.h"
+
+#include "async_io.h"
+
+#include "uring_io.h"
+
+#include "mmap_io.h"
+
+#include <algorithm>
+
+#include <cstdio>
+
+#include <cstdlib>
+
+#include <string>
+
+#include <vector>
+
+#include <fcntl.h>
+
+#include <unistd.h>
+
+/// \brief buffer pool for reading buckets
+///
+/// \param value_type type of elements
+template<typename value_type>
+class BucketReaderPool {
+
+private:
+
+	static const uint64 MIN_CHUNK = 4096; ///< minimum number of elements of a chunk by share, and of a chunk read ahead
+
+	static const uint64 URING_DEPTH = 256; ///< maximum number of reads in flight
+
+	static const uint64 SUBMIT_BATCH = 8; ///< number of reads queued before submitting them
+
+	/// \brief state of a bucket
+	struct Bucket {
+
+		uint64 beg; ///< first element not loaded yet
+
+		uint64 end; ///< one past the last element not loaded yet
+
+		uint64 chunk; ///< number of elements to load by the next refill
+
+		uint64 refill_num; ///< number of refills so far
+
+		uint64 mark; ///< number of elements handed out by the pool at the last refill
+
+		uint64 cur; ///< next element in the buffer
+
+		std::vector<value_type> buf; ///< loaded elements in the reading order
+
+		std::vector<value_type> ahead; ///< next chunk in the file order, being read by io_uring if is_ahead
+
+		uint64 ahead_pos; ///< position of the next chunk
+
+		int64 ahead_got; ///< bytes of the next chunk read by io_uring, -1 if in flight
+
+		bool is_ahead; ///< the next chunk is reserved
+	};
+
+	std::string m_fn; ///< file name
+
+	int m_fd; ///< file descriptor
+
+	bool m_reverse; ///< read each bucket from right to left
+
+	uint64 m_budget; ///< maximum number of buffered elements
+
+	uint64 m_used; ///< number of buffered elements
+
+	uint64 m_peak; ///< maximum of m_used
+
+	uint64 m_consumed; ///< number of elements handed out so far
+
+	std::vector<Bucket> m_bkt; ///< buckets
+
+	utility::io_ring* m_uring; ///< ring of the read-ahead chunks, nullptr if not used
+
+	uint64 m_uring_depth; ///< maximum number of reads in flight
+
+	uint64 m_queued; ///< number of reads queued but not submitted
+
+	utility::span<value_type> m_mapped; ///< elements of the mapped file
+
+	bool m_is_mapped; ///< the file is mapped, read in place
+
+public:
+
+	/// \brief ctor
+	///
+	/// \param _fn file name
+	/// \param _beg starting position of each bucket, in elements
+	/// \param _num number of elements in each bucket
+	/// \param _reverse read each bucket from right to left
+	/// \param _budget memory budget in bytes
+	/// \param _use_uring read ahead by io_uring, fall back to pread if not supported
+	BucketReaderPool(const std::string& _fn, const std::vector<uint64>& _beg, const std::vector<uint64>& _num, const bool _reverse, const uint64 _budget, const bool _use_uring = false) :
+		m_fn(_fn), m_reverse(_reverse), m_budget(std::max<uint64>(1, _budget / sizeof(value_type))), m_used(0), m_peak(0), m_consumed(0), m_uring(nullptr), m_uring_depth(0), m_queued(0) {
+
+		m_is_mapped = utility::find_mapped(m_fn, m_mapped);
+
+		m_fd = open(m_fn.c_str(), O_RDONLY);
+
+		if (m_fd == -1) {
+
+			std::perror(m_fn.c_str());
+
+			std::exit(EXIT_FAILURE);
+		}
+
+		uint64 total_num = 0;
+
+		for (uint64 i = 0; i < _num.size(); ++i) total_num += _num[i];
+
+		m_bkt.resize(_num.size());
+
+		for (uint64 i = 0; i < _num.size(); ++i) {
+
+			Bucket& bkt = m_bkt[i];
+
+			bkt.beg = _beg[i], bkt.end = _beg[i] + _num[i];
+
+			const uint64 share = (total_num == 0) ? 0 : static_cast<uint64>(static_cast<double>(m_budget) * _num[i] / total_num);
+
+			bkt.chunk = std::min(_num[i], std::max(MIN_CHUNK, share / 2));
+
+			bkt.refill_num = 0, bkt.mark = 0, bkt.cur = 0;
+
+			bkt.ahead_pos = 0, bkt.ahead_got = 0, bkt.is_ahead = false;
+		}
+
+		if (_use_uring && !m_is_mapped && !_num.empty()) {
+
+			m_uring_depth = std::min<uint64>(URING_DEPTH, _num.size());
+
+			m_uring = new utility::io_ring(static_cast<unsigned>(m_uring_depth));
+
+			if (false == m_uring->is_ready()) {
+
+				delete m_uring; m_uring = nullptr;
+			}
+		}
+	}
+
+	/// \brief dtor
+	~BucketReaderPool() {
+
+		if (m_uring != nullptr) {
+
+			// the buffers of the reads in flight are released afterwards
+			while (m_uring->inflight() > 0) reap();
+
+			delete m_uring; m_uring = nullptr;
+		}
+
+		if (m_is_mapped) utility::mapped_read_volume().fetch_add(m_consumed * sizeof(value_type), std::memory_order_relaxed);
+
+		close(m_fd);
+	}
+
+	/// \brief return the next element of the specified bucket
+	///
+	/// \note the bucket must not be read out
+	value_type next(const uint64 _bkt) {
+
+		Bucket& bkt = m_bkt[_bkt];
+
+		++m_consumed;
+
+		if (m_is_mapped) return m_reverse ? m_mapped[--bkt.end] : m_mapped[bkt.beg++];
+
+		if (bkt.cur == bkt.buf.size()) refill(bkt, _bkt);
+
+		const value_type val = bkt.buf[bkt.cur++];
+
+		if (bkt.cur == bkt.buf.size() && bkt.beg == bkt.end && !bkt.is_ahead) { // read out, release the buffer
+
+			m_used -= bkt.buf.size();
+
+			std::vector<value_type>().swap(bkt.buf);
+
+			bkt.cur = 0;
+		}
+
+		return val;
+	}
+
+	/// \brief maximum memory in bytes occupied by the buffers so far
+	uint64 peak() const {
+
+		return m_peak * sizeof(value_type);
+	}
+
+private:
+
+	/// \brief reserve the next chunk of the bucket within the free budget and return its number of elements
+	///
+	/// \param _pos position of the chunk
+	/// \param _is_ahead the chunk is read ahead, return 0 if the free budget is below MIN_CHUNK elements (or the rest of the bucket)
+	uint64 reserve(Bucket& _bkt, uint64& _pos, const bool _is_ahead) {
+
+		const uint64 held = std::min<uint64>(m_bkt.size(), m_budget / 2); // for the reads of one element
+
+		const uint64 free = (m_used + held < m_budget) ? m_budget - held - m_used : 0, left = _bkt.end - _bkt.beg;
+
+		uint64 num = std::min(left, std::min(_bkt.chunk, free));
+
+		if (_is_ahead) {
+
+			if (num < std::min(left, MIN_CHUNK)) return 0;
+		}
+		else if (num == 0) {
+
+			if (left == 0) {
+
+				std::cerr << m_fn << ": read beyond the bucket\n";
+
+				std::exit(EXIT_FAILURE);
+			}
+
+			num = 1; // the budget is held by the other buckets, read one element to make progress
+		}
+
+		if (m_reverse) {
+
+			_pos = _bkt.end - num, _bkt.end -= num;
+		}
+		else {
+
+			_pos = _bkt.beg, _bkt.beg += num;
+		}
+
+		++_bkt.refill_num;
+
+		m_used += num;
+
+		m_peak = std::max(m_peak, m_used);
+
+		return num;
+	}
+
+	/// \brief share the budget by consumption rate, given that the bucket has drained its buffer of _drained elements
+	void rebalance(Bucket& _bkt, const uint64 _drained) {
+
+		if (_bkt.refill_num > 0 && m_consumed > _bkt.mark) {
+
+			const uint64 buf_num = (m_uring != nullptr) ? 2 : 1; // the buffer and the one read ahead
+
+			const double rate = static_cast<double>(_drained) / (m_consumed - _bkt.mark);
+
+			_bkt.chunk = std::max(MIN_CHUNK, static_cast<uint64>(rate * m_budget / buf_num));
+		}
+
+		_bkt.mark = m_consumed;
+	}
+
+	/// \brief load the next chunk of the bucket
+	void refill(Bucket& _bkt, const uint64 _bkt_idx) {
+
+		rebalance(_bkt, _bkt.buf.size());
+
+		m_used -= _bkt.buf.size();
+
+		if (_bkt.is_ahead) { // read ahead, wait for the completion
+
+			while (_bkt.ahead_got < 0) reap();
+
+			const uint64 bytes = _bkt.ahead.size() * sizeof(value_type), got = _bkt.ahead_got;
+
+			if (got < bytes) { // failed or short
+
+				read_bytes(reinterpret_cast<char*>(_bkt.ahead.data()) + got, _bkt.ahead_pos * sizeof(value_type) + got, bytes - got);
+			}
+
+			_bkt.buf.swap(_bkt.ahead);
+
+			_bkt.is_ahead = false;
+		}
+		else {
+
+			uint64 pos;
+
+			const uint64 num = reserve(_bkt, pos, false);
+
+			_bkt.buf.resize(num);
+
+			read_at(_bkt.buf.data(), pos, num);
+		}
+
+		if (m_reverse) std::reverse(_bkt.buf.begin(), _bkt.buf.end());
+
+		_bkt.cur = 0;
+
+		if (m_uring == nullptr || _bkt.beg == _bkt.end || m_uring->inflight() == m_uring_depth || false == read_ahead(_bkt, _bkt_idx)) {
+
+			std::vector<value_type>().swap(_bkt.ahead);
+		}
+	}
+
+	/// \brief queue the read of the next chunk of the bucket, submit the queued reads by batch
+	///
+	/// Return false if the free budget is too small for the chunk.
+	bool read_ahead(Bucket& _bkt, const uint64 _bkt_idx) {
+
+		const uint64 num = reserve(_bkt, _bkt.ahead_pos, true);
+
+		if (num == 0) return false;
+
+		_bkt.ahead.resize(num);
+
+		_bkt.is_ahead = true;
+
+		_bkt.ahead_got = -1;
+
+		if (false == m_uring->prep_read(m_fd, reinterpret_cast<char*>(_bkt.ahead.data()), num * sizeof(value_type), _bkt.ahead_pos * sizeof(value_type), _bkt_idx)) {
+
+			_bkt.ahead_got = 0; // not queued, read by pread on refill
+
+			return true;
+		}
+
+		if (++m_queued == SUBMIT_BATCH) {
+
+			m_uring->submit();
+
+			m_queued = 0;
+		}
+
+		return true;
+	}
+
+	/// \brief reap a completed read, the queued reads are submitted first
+	void reap() {
+
+		uint64 bkt_idx;
+
+		int64 res;
+
+		m_queued = 0;
+
+		if (false == m_uring->submit() || false == m_uring->wait(bkt_idx, res)) {
+
+			std::cerr << m_fn << ": io_uring failed\n";
+
+			std::exit(EXIT_FAILURE);
+		}
+
+		m_bkt[bkt_idx].ahead_got = std::max<int64>(0, res);
+	}
+
+	/// \brief read _num elements starting from the _pos-th one
+	void read_at(value_type* _dst, const uint64 _pos, const uint64 _num) {
+
+		read_bytes(reinterpret_cast<char*>(_dst), _pos * sizeof(value_type), _num * sizeof(value_type));
+	}
+
+	/// \brief read _left bytes starting from _offset
+	void read_bytes(char* _dst, const uint64 _offset, const uint64 _left) {
+
+		if (utility::pread_full(m_fd, _dst, _left, _offset, m_fn) < _left) {
+
+			std::cerr << m_fn << ": unexpected end of file\n";
+
+			std::exit(EXIT_FAILURE);
+		}
+	}
+};
+
+template<typename value_type>
+const uint64 BucketReaderPool<value_type>::MIN_CHUNK;
+
+template<typename value_type>
+const uint64 BucketReaderPool<value_type>::URING_DEPTH;
+
+template<typename value_type>
+const uint64 BucketReaderPool<value_type>::SUBMIT_BATCH;
+
+#endif // __BUCKET_READER_H
@@ -0,0 +1,331 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file checkpoint.h
+/// \brief sampled prefix fingerprints stored in a sidecar file of the input string
+///
+/// The sidecar file consists of a header followed by fp[0, j * step - 1] for j = 0, 1, ..., len / step.
+/// Given the samples, fp[0, i - 1] is obtained by reading at most step - 1 characters,
+/// and a scan of T can start from any multiple of step.
+///
+/// The header records the inode and the modification time of T, a sidecar file of another or a modified T is rejected on loading.
+/// The fingerprint of the whole T is also recorded as a content key. A full scan of T using loaded samples compares
+/// the samples it passes and, if reaching the end, the content key with the recomputed ones. On a mismatch, the samples are recorded afresh.
+///
+/// \author Yi Wu
+/// \date 2016.12
+///////////////////////////////////////////////////////////
+
+#ifndef __CHECKPOINT_H
+#define __CHECKPOINT_H
+
+#include "common.h"
+
+#include "basicio.h"
+
+#include "fingerprint.h"
+
+#include <cstdio>
+
+#include <cstddef>
+
+#include <cstring>
+
+#include <vector>
+
+#include <sys/stat.h>
+
+/// \brief sampled prefix fingerprints
+///
+/// \param alphabet_vector_type stxxl vector for the input string
+/// \param fingerprint_type fingerprinting backend
+template<typename alphabet_vector_type, typename fingerprint_type>
+class FingerprintCheckpoint {
+
+private:
+
+	typedef typename alphabet_vector_type::value_type alphabet_type;
+
+	typedef typename fingerprint_type::value_type fp_value_type;
+
+	/// \brief header of the sidecar file
+	struct Header {
+
+		char magic[8]; ///< "KRFPIDX"
+
+		uint64 version; ///< format version
+
+		uint64 len; ///< length of input string
+
+		uint64 step; ///< sampling step
+
+		uint64 alphabet_size; ///< sizeof(alphabet_type)
+
+		uint64 mod; ///< modulus
+
+		uint64 base; ///< radix
+
+		char backend[16]; ///< name of the fingerprinting backend
+
+		uint64 t_ino; ///< inode of the file of T
+
+		int64 t_mtime_sec; ///< modification time of the file of T, seconds
+
+		int64 t_mtime_nsec; ///< modification time of the file of T, nanoseconds
+
+		uint64 t_fp; ///< fp[0, len - 1], content key of T, not compared on loading
+	};
+
+	static const uint64 VERSION = 2;
+
+	std::string m_fn; ///< sidecar filename
+
+	std::string m_t_fn; ///< file of T, empty if unknown
+
+	fp_value_type m_t_fp; ///< fp[0, len - 1] recorded in the sidecar file
+
+	uint64 m_len; ///< length of input string
+
+	uint64 m_step; ///< sampling step
+
+	std::vector<fp_value_type> m_samples; ///< m_samples[j] = fp[0, j * m_step - 1]
+
+	bool m_ready; ///< whether m_samples are complete
+
+	RInterval<fingerprint_type>* m_rinterval; ///< R^k mod P for 0 <= k <= m_step
+
+public:
+
+	/// \brief ctor, load the sidecar file if it exists and matches T, otherwise the samples must be recorded by a scan
+	///
+	/// \param _len length of input string
+	/// \param _fn sidecar filename
+	/// \param _step sampling step, overridden by the one in an existing sidecar file
+	/// \param _t_fn file of T, whose inode and modification time must match those in the sidecar file
+	FingerprintCheckpoint(const uint64 _len, const std::string& _fn, const uint64 _step, const std::string& _t_fn) : m_fn(_fn), m_t_fn(_t_fn), m_t_fp(0) {
+
+		m_len = _len;
+
+		m_step = (_step == 0) ? 1 : _step;
+
+		m_ready = load();
+
+		if (m_ready) {
+
+			std::cerr << "Fingerprint checkpoints loaded from " << m_fn << ", step: " << m_step << std::endl;
+		}
+		else {
+
+			m_samples.assign(m_len / m_step + 1, 0);
+		}
+
+		m_rinterval = new RInterval<fingerprint_type>(m_step);
+	}
+
+	/// \brief dtor
+	~FingerprintCheckpoint() {
+
+		delete m_rinterval; m_rinterval = nullptr;
+	}
+
+	/// \brief whether the samples are available
+	bool is_ready() const {
+
+		return m_ready;
+	}
+
+	/// \brief sampling step
+	uint64 step() const {
+
+		return m_step;
+	}
+
+	/// \brief get fp[0, _j * step - 1]
+	fp_value_type sample(const uint64 _j) const {
+
+		return m_samples[_j];
+	}
+
+	/// \brief record fp[0, _j * step - 1] during a scan
+	///
+	/// If the samples are loaded, the recorded one is compared with the loaded one. On a mismatch, the samples are no longer ready
+	/// and the scan must proceed to the end of T to record all of them.
+	void record(const uint64 _j, const fp_value_type _fp) {
+
+		if (m_ready && m_samples[_j] != _fp) mismatch();
+
+		m_samples[_j] = _fp;
+	}
+
+	/// \brief compare fp[0, len - 1] computed by a scan with the content key loaded
+	void verify(const fp_value_type _t_fp) {
+
+		if (m_ready && m_t_fp != _t_fp) mismatch();
+	}
+
+	/// \brief all samples are recorded by a scan, write them to the sidecar file
+	///
+	/// \param _t_fp fp[0, len - 1]
+	void finish(const fp_value_type _t_fp) {
+
+		m_ready = true;
+
+		m_t_fp = _t_fp;
+
+		save();
+	}
+
+	/// \brief get fp[0, _pos - 1] by reading at most step - 1 characters
+	///
+	/// \param _t input string
+	/// \param _pos position
+	fp_value_type prefix(const alphabet_vector_type& _t, const uint64 _pos) const {
+
+		const uint64 pos = std::min(_pos, m_len);
+
+		const uint64 beg = pos / m_step * m_step;
+
+		fp_value_type fp = m_samples[pos / m_step];
+
+		if (beg < pos) {
+
+			std::vector<alphabet_type> buf(pos - beg);
+
+			typename alphabet_vector_type::bufreader_type reader(_t.begin() + beg, _t.begin() + pos);
+
+			for (uint64 i = 0; i < pos - beg; ++i, ++reader) {
+
+				buf[i] = *reader;
+			}
+
+			fp = FingerprintKernel<fingerprint_type, alphabet_type>::advance(fp, buf.data(), pos - beg);
+		}
+
+		return fp;
+	}
+
+	/// \brief get fp[_beg, _end - 1], reading at most 2 * (step - 1) characters
+	///
+	/// \param _t input string
+	/// \param _beg starting position
+	/// \param _end ending position (exclusive)
+	fp_value_type range(const alphabet_vector_type& _t, const uint64 _beg, const uint64 _end) const {
+
+		return fingerprint_type::interval(prefix(_t, _end), prefix(_t, _beg), m_rinterval->compute(_end - _beg)); // square-and-multiply if _end - _beg > step
+	}
+
+private:
+
+	/// \brief fill a header describing the current setting
+	void make_header(Header& _header) const {
+
+		std::memset(&_header, 0, sizeof(Header));
+
+		std::strncpy(_header.magic, "KRFPIDX", sizeof(_header.magic));
+
+		_header.version = VERSION;
+
+		_header.len = m_len;
+
+		_header.step = m_step;
+
+		_header.alphabet_size = sizeof(alphabet_type);
+
+		_header.mod = fingerprint_type::MOD;
+
+		_header.base = fingerprint_type::BASE;
+
+		std::strncpy(_header.backend, fingerprint_type::name(), sizeof(_header.backend) - 1);
+
+		struct stat st;
+
+		if (!m_t_fn.empty() && 0 == stat(m_t_fn.c_str(), &st)) {
+
+			_header.t_ino = st.st_ino;
+
+			_header.t_mtime_sec = st.st_mtim.tv_sec, _header.t_mtime_nsec = st.st_mtim.tv_nsec;
+		}
+
+		_header.t_fp = m_t_fp;
+	}
+
+	/// \brief the loaded samples do not match T
+	void mismatch() {
+
+		m_ready = false;
+
+		std::cerr << "Fingerprint checkpoints in " << m_fn << " do not match the input, rebuild them.\n";
+	}
+
+	/// \brief load the sidecar file, return false if it is missing or does not match T
+	bool load() {
+
+		if (m_fn.empty() || !BasicIO::file_exists(m_fn)) return false;
+
+		const uint64 step = m_step;
+
+		std::FILE* f = BasicIO::file_open(m_fn, "rb");
+
+		Header header, expected;
+
+		bool is_match = (1 == std::fread(&header, sizeof(Header), 1, f));
+
+		if (is_match && header.step != 0) {
+
+			m_step = header.step; // adopt the step of the existing file
+
+			make_header(expected);
+
+			is_match = (0 == std::memcmp(&header, &expected, offsetof(Header, t_fp)));
+		}
+		else {
+
+			is_match = false;
+		}
+
+		if (is_match) {
+
+			m_t_fp = header.t_fp;
+
+			m_samples.resize(m_len / m_step + 1);
+
+			is_match = (m_samples.size() == std::fread(m_samples.data(), sizeof(fp_value_type), m_samples.size(), f));
+		}
+
+		std::fclose(f);
+
+		if (!is_match) {
+
+			m_step = step;
+
+			std::cerr << "Fingerprint checkpoints in " << m_fn << " do not match the input, rebuild them.\n";
+		}
+
+		return is_match;
+	}
+
+	/// \brief write the header and the samples to the sidecar file
+	void save() const {
+
+		if (m_fn.empty()) return;
+
+		std::FILE* f = BasicIO::file_open(m_fn, "wb");
+
+		Header header;
+
+		make_header(header);
+
+		if (1 != std::fwrite(&header, sizeof(Header), 1, f) || m_samples.size() != std::fwrite(m_samples.data(), sizeof(fp_value_type), m_samples.size(), f)) {
+
+			std::perror(m_fn.c_str());
+
+			std::exit(EXIT_FAILURE);
+		}
+
+		std::fclose(f);
+
+		std::cerr << "Fingerprint checkpoints written to " << m_fn << ", step: " << m_step << std::endl;
+	}
+};
+
+#endif // __CHECKPOINT_H
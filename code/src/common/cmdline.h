@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file cmdline.h
+/// \brief a tiny command line parser
+///
+/// Arguments of the form --name=value (or --name) are options, the others are positional arguments.
+///
+/// \author Yi Wu
+/// \date 2016.12
+///////////////////////////////////////////////////////////
+
+#ifndef __CMDLINE_H
+#define __CMDLINE_H
+
+#include <string>
+
+#include <vector>
+
+#include <map>
+
+/// \brief parse command line arguments
+struct CmdLine {
+
+	std::vector<std::string> m_positional; ///< positional arguments in the given order
+
+	std::map<std::string, std::string> m_options; ///< options, indexed by name
+
+	/// \brief ctor
+	CmdLine(int _argc, char** _argv) {
+
+		for (int i = 1; i < _argc; ++i) {
+
+			std::string arg(_argv[i]);
+
+			if (arg.size() > 2 && arg[0] == '-' && arg[1] == '-') {
+
+				size_t pos = arg.find('=');
+
+				if (pos == std::string::npos) {
+
+					m_options[arg.substr(2)] = "";
+				}
+				else {
+
+					m_options[arg.substr(2, pos - 2)] = arg.substr(pos + 1);
+				}
+			}
+			else {
+
+				m_positional.push_back(arg);
+			}
+		}
+	}
+
+	/// \brief number of positional arguments
+	size_t positional_num() const {
+
+		return m_positional.size();
+	}
+
+	/// \brief get the _idx-th positional argument
+	const std::string& positional(const size_t _idx) const {
+
+		return m_positional[_idx];
+	}
+
+	/// \brief check if option _name is given
+	bool has(const std::string& _name) const {
+
+		return m_options.find(_name) != m_options.end();
+	}
+
+	/// \brief get value of option _name, return _default if not given
+	std::string get(const std::string& _name, const std::string& _default) const {
+
+		std::map<std::string, std::string>::const_iterator it = m_options.find(_name);
+
+		return (it == m_options.end()) ? _default : it->second;
+	}
+};
+
+#endif // __CMDLINE_H
@@ -41,6 +41,10 @@ static const fpa_type P = 2047824239;
 
 static const fpa_type R = 1732327371;
 
+static const uint64 P61 = (1ull << 61) - 1; ///< Mersenne prime 2^61 - 1
+
+static const uint64 R61 = 1530948321947284197ull; ///< radix for P61
+
 static const uint_type MAIN_MEM_AVAIL = 3 * 1024 * 1024 * 1024ull; 
 
 static const uint_type BUFF_MEM_AVAIL = 8 * 1024 * 1024ull; // 8 mb for buffer
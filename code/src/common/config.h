@@ -0,0 +1,162 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file config.h
+/// \brief run-time settings shared by the validators
+///
+///
+/// \author Yi Wu
+/// \date 2016.12
+///////////////////////////////////////////////////////////
+
+#ifndef __CONFIG_H
+#define __CONFIG_H
+
+#include "common.h"
+
+#include "cmdline.h"
+
+#include <cstdlib>
+
+#include <string>
+
+#include <thread>
+
+/// \brief run-time settings
+struct Config {
+
+	uint64 thread_num; ///< number of worker threads
+
+	uint64 fp_window_size; ///< number of characters loaded into RAM per window when computing prefix fingerprints
+
+	uint64 fp_batch_size; ///< maximum number of fingerprint requests answered per batch
+
+	std::string fp_index_fn; ///< sidecar file of sampled prefix fingerprints, empty if not used
+
+	uint64 fp_index_step; ///< sampling step of the sidecar file
+
+	uint64 fp_extra_num; ///< number of extra fingerprints with random (P, R) pairs, 0 if not used
+
+	uint64 fp_seed; ///< seed for generating the (P, R) pairs of extra fingerprints
+
+	bool rmq_dense; ///< use the dense vectorized RMQ on at most 128 buckets (--rmq=auto), otherwise the monotone stack (--rmq=stack)
+
+	uint64 bkt_buf_size; ///< memory budget in bytes for reading the buckets of SA and LCP in place
+
+	bool concurrent_scan; ///< run the two induction scans of Validate4 in two threads
+
+	bool build_lcp; ///< build LCP from T and SA instead of validating it
+
+	bool sa_only; ///< validate SA alone, no LCP is given
+
+	std::string t_fn; ///< file of the input string, read by the asynchronous streams
+
+	bool async_io; ///< scan T, SA and LCP by asynchronous O_DIRECT streams instead of the stxxl readers
+
+	uint64 async_buf_num; ///< number of buffers per asynchronous stream
+
+	uint64 async_buf_size; ///< bytes per buffer of an asynchronous stream
+
+	bool io_uring; ///< queue the reads of the asynchronous streams and of the bucket readers by io_uring, if the kernel supports it
+
+	std::string mmap_mode; ///< map the input files and read them in place: "on", "off", or "auto" if they fit in the available memory
+
+	/// \brief default settings
+	Config() {
+
+		thread_num = std::thread::hardware_concurrency();
+
+		if (thread_num == 0) thread_num = 1;
+
+		fp_window_size = 64 * 1024 * 1024ull;
+
+		fp_batch_size = 4 * 1024 * 1024ull;
+
+		fp_index_step = 16 * 1024ull;
+
+		fp_extra_num = 0;
+
+		fp_seed = 0x5eed5eed5eed5eedull;
+
+		rmq_dense = true;
+
+		bkt_buf_size = MAIN_MEM_AVAIL / 8;
+
+		concurrent_scan = false;
+
+		build_lcp = false;
+
+		sa_only = false;
+
+		async_io = false;
+
+		async_buf_num = 4;
+
+		async_buf_size = 4 * 1024 * 1024ull;
+
+		io_uring = false;
+
+		mmap_mode = "auto";
+	}
+
+	/// \brief default settings overridden by options --threads=N, --fp-window=N, --fp-batch=N, --fp-index[=FILE], --fp-index-step=N,
+	/// --fp-extra=K, --fp-seed=S, --rmq=auto|stack, --bkt-buf=N, --concurrent-scan, --build-lcp, --sa-only,
+	/// --async-io, --async-bufs=N, --async-buf=N, --io-uring and --mmap=auto|on|off
+	///
+	/// --fp-index without a value uses the file named after the input string (the first positional argument) plus ".fpidx".
+	Config(const CmdLine& _cmdline) : Config() {
+
+		thread_num = std::strtoull(_cmdline.get("threads", std::to_string(thread_num)).c_str(), nullptr, 10);
+
+		fp_window_size = std::strtoull(_cmdline.get("fp-window", std::to_string(fp_window_size)).c_str(), nullptr, 10);
+
+		fp_batch_size = std::strtoull(_cmdline.get("fp-batch", std::to_string(fp_batch_size)).c_str(), nullptr, 10);
+
+		fp_index_fn = _cmdline.get("fp-index", "");
+
+		if (_cmdline.has("fp-index") && fp_index_fn.empty() && _cmdline.positional_num() > 0) {
+
+			fp_index_fn = _cmdline.positional(0) + ".fpidx";
+		}
+
+		fp_index_step = std::strtoull(_cmdline.get("fp-index-step", std::to_string(fp_index_step)).c_str(), nullptr, 10);
+
+		fp_extra_num = std::strtoull(_cmdline.get("fp-extra", std::to_string(fp_extra_num)).c_str(), nullptr, 10);
+
+		fp_seed = std::strtoull(_cmdline.get("fp-seed", std::to_string(fp_seed)).c_str(), nullptr, 0);
+
+		rmq_dense = (_cmdline.get("rmq", "auto") != "stack");
+
+		bkt_buf_size = std::strtoull(_cmdline.get("bkt-buf", std::to_string(bkt_buf_size)).c_str(), nullptr, 10);
+
+		concurrent_scan = _cmdline.has("concurrent-scan");
+
+		build_lcp = _cmdline.has("build-lcp");
+
+		sa_only = _cmdline.has("sa-only");
+
+		if (_cmdline.positional_num() > 0) t_fn = _cmdline.positional(0);
+
+		async_io = _cmdline.has("async-io");
+
+		async_buf_num = std::strtoull(_cmdline.get("async-bufs", std::to_string(async_buf_num)).c_str(), nullptr, 10);
+
+		async_buf_size = std::strtoull(_cmdline.get("async-buf", std::to_string(async_buf_size)).c_str(), nullptr, 10);
+
+		io_uring = _cmdline.has("io-uring");
+
+		mmap_mode = _cmdline.get("mmap", mmap_mode);
+
+		if (thread_num == 0) thread_num = 1;
+
+		if (fp_window_size < thread_num) fp_window_size = thread_num;
+
+		if (fp_batch_size == 0) fp_batch_size = 1;
+
+		if (fp_index_step == 0) fp_index_step = 1;
+
+		if (async_buf_num < 2) async_buf_num = 2; // double buffering at least
+	}
+};
+
+#endif // __CONFIG_H
@@ -0,0 +1,459 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file fingerprint.h
+/// \brief facilities for the Karp-Rabin fingerprinting function
+///
+/// The fingerprint of T[i, j] is computed by fp[0, j] - fp[0, i - 1] * R^(j - i + 1) mod P,
+/// thus each range fingerprint requires a power R^k mod P.
+/// Two backends are provided: PrimeFingerprint (31-bit P) and MersenneFingerprint (P = 2^61 - 1).
+///
+/// \author Yi Wu
+/// \date 2016.12
+///////////////////////////////////////////////////////////
+
+#ifndef __FINGERPRINT_H
+#define __FINGERPRINT_H
+
+#include "common.h"
+
+#include "modarith.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define FP_X86
+#include <immintrin.h>
+#endif
+
+/// \brief check if the CPU supports AVX2, the CPUID is queried on the first call
+///
+/// The AVX2 kernels are compiled with function-level target attributes, thus no global -m flag is required.
+inline bool fp_has_avx2() {
+
+#ifdef FP_X86
+	static const bool is_supported = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+
+	return is_supported;
+#else
+	return false;
+#endif
+}
+
+/// \brief powers of R for consuming 8 characters per step
+///
+/// m_pow[k] = R^k mod P for 0 <= k <= 8 and m_ones = R^0 + R^1 + ... + R^7 mod P.
+template<typename fingerprint_type>
+struct WordPower {
+
+	typedef typename fingerprint_type::value_type value_type;
+
+	value_type m_pow[9]; ///< R^0, R^1, ..., R^8 mod P
+
+	value_type m_ones; ///< fingerprint of 8 zero characters
+
+	/// \brief ctor
+	WordPower() {
+
+		m_pow[0] = 1;
+
+		for (int k = 1; k <= 8; ++k) {
+
+			m_pow[k] = fingerprint_type::mul(m_pow[k - 1], fingerprint_type::BASE);
+		}
+
+		m_ones = 0;
+
+		for (int k = 0; k < 8; ++k) {
+
+			m_ones = fingerprint_type::append(m_ones, 0);
+		}
+	}
+
+	/// \brief get the table, constructed on the first call
+	static const WordPower& get() {
+
+		static const WordPower table;
+
+		return table;
+	}
+};
+
+/// \brief Karp-Rabin fingerprinting function modulo a 31-bit prime P
+///
+/// A product of two residues fits in 64 bits and is reduced by ModArith, see common/modarith.h.
+///
+/// \param reduction_type DivisionReduction, BarrettReduction or MontgomeryReduction
+template<typename reduction_type>
+struct BasicPrimeFingerprint {
+
+	typedef fpa_type value_type; ///< residue type
+
+	typedef ModArith<P, reduction_type> arith_type; ///< arithmetic modulo P
+
+	static const value_type MOD = P; ///< modulus
+
+	static const value_type BASE = R; ///< radix
+
+	/// \brief backend name, the same for all the reduction strategies as the fingerprints are identical
+	static const char* name() { return "prime31"; }
+
+	/// \brief compute _a * _b mod P
+	static value_type mul(const value_type _a, const value_type _b) {
+
+		return arith_type::mul(_a, _b);
+	}
+
+	/// \brief compute fp[0, i] from fp[0, i - 1] and t[i]
+	///
+	/// \note t[i] + 1 to guarantee non-zero
+	static value_type append(const value_type _fp, const uint64 _ch) {
+
+		return arith_type::reduce(static_cast<fpb_type>(_fp) * BASE + (_ch + 1));
+	}
+
+	/// \brief compute fp[0, i + 7] from fp[0, i - 1] and t[i, i + 7] with a single reduction
+	///
+	/// fp[0, i + 7] = fp[0, i - 1] * R^8 + sum_{k = 0}^{7} (t[i + k] + 1) * R^(7 - k).
+	/// The sum is below 2^62 + 2^43 < P * 2^32 and thus fits in 64 bits.
+	static value_type append8(const value_type _fp, const uint8* _chars) {
+
+		const WordPower<BasicPrimeFingerprint>& power = WordPower<BasicPrimeFingerprint>::get();
+
+		fpb_type sum = static_cast<fpb_type>(_fp) * power.m_pow[8] + power.m_ones;
+
+		for (int k = 0; k < 8; ++k) {
+
+			sum += static_cast<fpb_type>(_chars[k]) * power.m_pow[7 - k];
+		}
+
+		return arith_type::reduce(sum);
+	}
+
+	/// \brief compute fp[0, i + 8 * _words - 1] from fp[0, i - 1] and t[i, i + 8 * _words - 1], 8 characters per step
+	static value_type advance8(value_type _fp, const uint8* _chars, const uint64 _words) {
+
+#ifdef FP_X86
+		if (fp_has_avx2()) return advance8_avx2(_fp, _chars, _words);
+#endif
+
+		for (uint64 i = 0; i < _words; ++i) {
+
+			_fp = append8(_fp, _chars + 8 * i);
+		}
+
+		return _fp;
+	}
+
+#ifdef FP_X86
+	/// \brief append8(), the eight products are computed by _mm256_mul_epu32
+	__attribute__((target("avx2")))
+	static value_type append8_avx2(const value_type _fp, const uint8* _chars) {
+
+		const WordPower<BasicPrimeFingerprint>& power = WordPower<BasicPrimeFingerprint>::get();
+
+		fpb_type sum = static_cast<fpb_type>(_fp) * power.m_pow[8] + power.m_ones;
+
+		const __m128i chars = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(_chars));
+
+		const __m256i prod1 = _mm256_mul_epu32(_mm256_cvtepu8_epi64(chars), _mm256_set_epi64x(power.m_pow[4], power.m_pow[5], power.m_pow[6], power.m_pow[7]));
+
+		const __m256i prod2 = _mm256_mul_epu32(_mm256_cvtepu8_epi64(_mm_srli_si128(chars, 4)), _mm256_set_epi64x(power.m_pow[0], power.m_pow[1], power.m_pow[2], power.m_pow[3]));
+
+		const __m256i prod = _mm256_add_epi64(prod1, prod2);
+
+		const __m128i half = _mm_add_epi64(_mm256_castsi256_si128(prod), _mm256_extracti128_si256(prod, 1));
+
+		sum += static_cast<fpb_type>(_mm_cvtsi128_si64(half)) + static_cast<fpb_type>(_mm_extract_epi64(half, 1));
+
+		return arith_type::reduce(sum);
+	}
+
+	/// \brief advance8() by the AVX2 kernel
+	__attribute__((target("avx2")))
+	static value_type advance8_avx2(value_type _fp, const uint8* _chars, const uint64 _words) {
+
+		for (uint64 i = 0; i < _words; ++i) {
+
+			_fp = append8_avx2(_fp, _chars + 8 * i);
+		}
+
+		return _fp;
+	}
+#endif
+
+	/// \brief compute _a - _b mod P
+	static value_type sub(const value_type _a, const value_type _b) {
+
+		return arith_type::sub(_a, _b);
+	}
+
+	/// \brief compute fp[i, j] = fp[0, j] - fp[0, i - 1] * R^(j - i + 1) mod P
+	///
+	/// \param _fp_end fp[0, j]
+	/// \param _fp_beg fp[0, i - 1]
+	/// \param _r_pow R^(j - i + 1) mod P
+	static value_type interval(const value_type _fp_end, const value_type _fp_beg, const value_type _r_pow) {
+
+		return arith_type::sub(_fp_end, arith_type::mul(_fp_beg, _r_pow));
+	}
+
+	/// \brief compute fp[i, k] = fp[i, j] * R^(k - j) + fp[j + 1, k] mod P
+	///
+	/// \param _fp_left fp[i, j]
+	/// \param _fp_right fp[j + 1, k]
+	/// \param _r_pow R^(k - j) mod P
+	static value_type concat(const value_type _fp_left, const value_type _fp_right, const value_type _r_pow) {
+
+		return arith_type::add(arith_type::mul(_fp_left, _r_pow), _fp_right);
+	}
+};
+
+// reduction strategy of PrimeFingerprint, override by -DFP_PRIME_REDUCTION=BarrettReduction or MontgomeryReduction for benchmarking
+#ifndef FP_PRIME_REDUCTION
+#define FP_PRIME_REDUCTION DivisionReduction
+#endif
+
+typedef BasicPrimeFingerprint<FP_PRIME_REDUCTION> PrimeFingerprint; ///< the default 31-bit backend
+
+/// \brief Karp-Rabin fingerprinting function modulo the Mersenne prime 2^61 - 1
+///
+/// A product of two residues is stored in 128 bits and reduced by shift-and-add instead of division.
+/// The collision probability is roughly 2^30 times lower than that of PrimeFingerprint.
+struct MersenneFingerprint {
+
+	typedef uint64 value_type; ///< residue type
+
+	static const value_type MOD = P61; ///< modulus
+
+	static const value_type BASE = R61; ///< radix
+
+	/// \brief backend name
+	static const char* name() { return "mersenne61"; }
+
+	/// \brief reduce _x < 2^122 modulo 2^61 - 1
+	static value_type reduce(const unsigned __int128 _x) {
+
+		value_type ret = static_cast<value_type>(_x & MOD) + static_cast<value_type>(_x >> 61); // ret < 2^62
+
+		ret = (ret & MOD) + (ret >> 61); // ret <= MOD
+
+		return ret >= MOD ? ret - MOD : ret;
+	}
+
+	/// \brief compute _a * _b mod (2^61 - 1)
+	static value_type mul(const value_type _a, const value_type _b) {
+
+		return reduce(static_cast<unsigned __int128>(_a) * _b);
+	}
+
+	/// \brief compute fp[0, i] from fp[0, i - 1] and t[i]
+	///
+	/// \note t[i] + 1 to guarantee non-zero
+	static value_type append(const value_type _fp, const uint64 _ch) {
+
+		return reduce(static_cast<unsigned __int128>(_fp) * BASE + (_ch + 1));
+	}
+
+	/// \brief compute fp[0, i + 7] from fp[0, i - 1] and t[i, i + 7] with a single reduction
+	///
+	/// fp[0, i + 7] = fp[0, i - 1] * R^8 + sum_{k = 0}^{7} (t[i + k] + 1) * R^(7 - k), accumulated in 128 bits.
+	static value_type append8(const value_type _fp, const uint8* _chars) {
+
+		const WordPower<MersenneFingerprint>& power = WordPower<MersenneFingerprint>::get();
+
+		unsigned __int128 sum = static_cast<unsigned __int128>(_fp) * power.m_pow[8] + power.m_ones;
+
+		for (int k = 0; k < 8; ++k) {
+
+			sum += static_cast<unsigned __int128>(_chars[k]) * power.m_pow[7 - k];
+		}
+
+		return reduce(sum);
+	}
+
+	/// \brief compute fp[0, i + 8 * _words - 1] from fp[0, i - 1] and t[i, i + 8 * _words - 1], 8 characters per step
+	static value_type advance8(value_type _fp, const uint8* _chars, const uint64 _words) {
+
+		for (uint64 i = 0; i < _words; ++i) {
+
+			_fp = append8(_fp, _chars + 8 * i);
+		}
+
+		return _fp;
+	}
+
+	/// \brief compute _a - _b mod (2^61 - 1)
+	static value_type sub(const value_type _a, const value_type _b) {
+
+		return _a >= _b ? _a - _b : _a + MOD - _b;
+	}
+
+	/// \brief compute fp[i, j] = fp[0, j] - fp[0, i - 1] * R^(j - i + 1) mod (2^61 - 1)
+	///
+	/// \param _fp_end fp[0, j]
+	/// \param _fp_beg fp[0, i - 1]
+	/// \param _r_pow R^(j - i + 1) mod (2^61 - 1)
+	static value_type interval(const value_type _fp_end, const value_type _fp_beg, const value_type _r_pow) {
+
+		return sub(_fp_end, mul(_fp_beg, _r_pow));
+	}
+
+	/// \brief compute fp[i, k] = fp[i, j] * R^(k - j) + fp[j + 1, k] mod (2^61 - 1)
+	///
+	/// \param _fp_left fp[i, j]
+	/// \param _fp_right fp[j + 1, k]
+	/// \param _r_pow R^(k - j) mod (2^61 - 1)
+	static value_type concat(const value_type _fp_left, const value_type _fp_right, const value_type _r_pow) {
+
+		value_type ret = mul(_fp_left, _r_pow) + _fp_right; // ret < 2^62
+
+		return ret >= MOD ? ret - MOD : ret;
+	}
+};
+
+/// \brief append a run of characters to a fingerprint
+///
+/// The general version consumes one character per step.
+template<typename fingerprint_type, typename alphabet_type>
+struct FingerprintKernel {
+
+	typedef typename fingerprint_type::value_type value_type;
+
+	/// \brief compute fp[0, i + _num - 1] from fp[0, i - 1] and t[i, i + _num - 1]
+	static value_type advance(value_type _fp, const alphabet_type* _chars, const uint64 _num) {
+
+		for (uint64 i = 0; i < _num; ++i) {
+
+			_fp = fingerprint_type::append(_fp, _chars[i]);
+		}
+
+		return _fp;
+	}
+};
+
+/// \brief append a run of bytes to a fingerprint
+///
+/// Consume 8 bytes per step and fall back to byte steps for the remaining ones.
+template<typename fingerprint_type>
+struct FingerprintKernel<fingerprint_type, uint8> {
+
+	typedef typename fingerprint_type::value_type value_type;
+
+	/// \brief compute fp[0, i + _num - 1] from fp[0, i - 1] and t[i, i + _num - 1]
+	static value_type advance(value_type _fp, const uint8* _chars, const uint64 _num) {
+
+		_fp = fingerprint_type::advance8(_fp, _chars, _num / 8);
+
+		for (uint64 i = _num / 8 * 8; i < _num; ++i) {
+
+			_fp = fingerprint_type::append(_fp, _chars[i]);
+		}
+
+		return _fp;
+	}
+};
+
+/// \brief store R^k mod MOD for any 0 <= k <= len in a two-level table
+///
+/// Let B = 2^m_shift >= sqrt(len + 1). The table consists of two parts:
+/// m_low stores R^0, R^1, ..., R^(B - 1) and m_high stores R^0, R^B, R^(2B), ..., R^(len / B * B).
+/// Then R^k = m_high[k / B] * m_low[k % B] mod MOD, which costs one multiplication and one reduction.
+/// The space consumption is O(sqrt(len)).
+template<typename fingerprint_type = PrimeFingerprint>
+struct RInterval {
+
+	typedef typename fingerprint_type::value_type fp_value_type;
+
+	fp_value_type* m_low; ///< R^0, R^1, ..., R^(B - 1) mod MOD
+
+	fp_value_type* m_high; ///< R^0, R^B, R^(2B), ... mod MOD
+
+	uint64 m_shift; ///< B = 2^m_shift
+
+	uint64 m_mask; ///< B - 1
+
+	uint64 m_max; ///< maximum power supported by the table
+
+	/// \brief ctor
+	///
+	/// \param _len maximum power to be computed, typically the length of input string
+	RInterval(uint64 _len) {
+
+		m_max = _len;
+
+		m_shift = 0;
+
+		while (m_shift < 32 && (1ull << (2 * m_shift)) <= _len) { // guarantee B * B > len
+
+			++m_shift;
+		}
+
+		m_mask = (1ull << m_shift) - 1;
+
+		uint64 low_num = 1ull << m_shift, high_num = (_len >> m_shift) + 1;
+
+		m_low = new fp_value_type[low_num];
+
+		m_low[0] = 1;
+
+		for (uint64 i = 1; i < low_num; ++i) {
+
+			m_low[i] = fingerprint_type::mul(m_low[i - 1], fingerprint_type::BASE);
+		}
+
+		fp_value_type r_b = fingerprint_type::mul(m_low[low_num - 1], fingerprint_type::BASE); // R^B mod MOD
+
+		m_high = new fp_value_type[high_num];
+
+		m_high[0] = 1;
+
+		for (uint64 i = 1; i < high_num; ++i) {
+
+			m_high[i] = fingerprint_type::mul(m_high[i - 1], r_b);
+		}
+
+		return;
+	}
+
+	/// \brief get R^_interval mod MOD
+	///
+	fp_value_type compute(uint64 _interval) const {
+
+		if (_interval > m_max) { // only happens for an invalid input
+
+			return compute_slow(_interval);
+		}
+
+		return fingerprint_type::mul(m_high[_interval >> m_shift], m_low[_interval & m_mask]);
+	}
+
+	/// \brief get R^_interval mod MOD by square-and-multiply, no limitation on _interval
+	///
+	fp_value_type compute_slow(uint64 _interval) const {
+
+		fp_value_type ret = 1, base = fingerprint_type::BASE % fingerprint_type::MOD;
+
+		while (_interval) {
+
+			if (_interval % 2) {
+
+				ret = fingerprint_type::mul(ret, base);
+			}
+
+			base = fingerprint_type::mul(base, base);
+
+			_interval = _interval / 2;
+		}
+
+		return ret;
+	}
+
+	/// \brief dtor
+	~RInterval() {
+
+		delete[] m_low; m_low = nullptr;
+
+		delete[] m_high; m_high = nullptr;
+	}
+};
+
+#endif // __FINGERPRINT_H
@@ -0,0 +1,205 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file lce.h
+/// \brief longest common extension (LCE) of two suffixes of T, by literal comparison if short and by fingerprints if long
+///
+/// A literal comparison reads T at two random positions and costs as many characters as the LCE,
+/// which is prohibitive for a long repeated region.
+/// Instead, FingerprintLCE compares at most step characters literally,
+/// then searches the LCE by galloping and binary search on fp[pos, pos + k - 1], each obtained from the sampled prefix fingerprints.
+/// A query thus reads O(step * log LCE) characters, and the answer is correct with the probability of a fingerprint collision.
+/// The samples are loaded from the sidecar file of --fp-index if available, otherwise recorded in RAM by a scan of T on the first long query.
+/// The powers R^k for 0 <= k <= len are looked up in a two-level table, one per probe shared by the two suffixes.
+/// An instance may share the samples of another one, such that two scans of T running concurrently record them once,
+/// or those of a caller which recorded them by its own scan of T.
+/// fp[0, pos - 1] of the two suffixes is computed once per query, thus a probe only reads around the two ends.
+///
+/// \author Yi Wu
+/// \date 2017.1
+///////////////////////////////////////////////////////////
+
+#ifndef __LCE_H
+#define __LCE_H
+
+#include "common.h"
+
+#include "basicio.h"
+
+#include "checkpoint.h"
+
+#include "config.h"
+
+#include "prefix_fp.h"
+
+#include <algorithm>
+
+#include <utility>
+
+/// \brief LCE queries on T
+///
+/// \param alphabet_vector_type stxxl vector for the input string
+/// \param fingerprint_type fingerprinting backend
+template<typename alphabet_vector_type, typename fingerprint_type>
+class FingerprintLCE {
+
+private:
+
+	typedef typename fingerprint_type::value_type fp_value_type;
+
+	typedef FingerprintCheckpoint<alphabet_vector_type, fingerprint_type> checkpoint_type;
+
+	/// \brief empty request stream, PrefixFingerprint then only records the samples
+	struct NoRequest {
+
+		typedef std::pair<uint64, uint64> value_type;
+
+		bool empty() const { return true; }
+
+		const value_type& operator*() const { return m_dummy; }
+
+		NoRequest& operator++() { return *this; }
+
+		value_type m_dummy;
+	};
+
+	const alphabet_vector_type& m_t; ///< input string
+
+	uint64 m_len; ///< length of input string
+
+	const Config& m_config; ///< run-time settings
+
+	checkpoint_type* m_checkpoint; ///< sampled prefix fingerprints, nullptr until the first long query
+
+	RInterval<fingerprint_type>* m_rinterval; ///< R^k mod P for 0 <= k <= len, nullptr until the first long query
+
+	const bool m_is_owner; ///< whether m_checkpoint and m_rinterval are owned, otherwise shared with another instance
+
+public:
+
+	/// \brief ctor
+	FingerprintLCE(const alphabet_vector_type& _t, const Config& _config) : m_t(_t), m_len(_t.size()), m_config(_config), m_checkpoint(nullptr), m_rinterval(nullptr), m_is_owner(true) {}
+
+	/// \brief ctor, share the samples of _other, which must have been prepared
+	///
+	/// \param _t another vector of the same input string, such that the two instances never read the same vector concurrently
+	/// \param _other instance owning the samples
+	FingerprintLCE(const alphabet_vector_type& _t, const FingerprintLCE& _other) : m_t(_t), m_len(_t.size()), m_config(_other.m_config), m_checkpoint(_other.m_checkpoint), m_rinterval(_other.m_rinterval), m_is_owner(false) {}
+
+	/// \brief ctor, share the samples and the powers of the caller, which must be ready and outlive the instance
+	FingerprintLCE(const alphabet_vector_type& _t, const Config& _config, checkpoint_type* _checkpoint, RInterval<fingerprint_type>* _rinterval) : m_t(_t), m_len(_t.size()), m_config(_config), m_checkpoint(_checkpoint), m_rinterval(_rinterval), m_is_owner(false) {}
+
+	/// \brief dtor
+	~FingerprintLCE() {
+
+		if (m_is_owner) {
+
+			delete m_checkpoint; m_checkpoint = nullptr;
+
+			delete m_rinterval; m_rinterval = nullptr;
+		}
+	}
+
+	/// \brief load or record the samples now instead of on the first long query, the instances sharing them then only read them
+	void prepare() {
+
+		if (m_checkpoint == nullptr) load_or_record();
+	}
+
+	/// \brief LCE of suf(_pos1) and suf(_pos2)
+	uint64 compute(const uint64 _pos1, const uint64 _pos2) {
+
+		const uint64 max_lce = m_len - std::max(_pos1, _pos2);
+
+		// the step of the loaded samples may differ from the setting, as the one in the sidecar file is adopted
+		const uint64 step = (m_checkpoint != nullptr) ? m_checkpoint->step() : m_config.fp_index_step;
+
+		// step 1: compare literally, the LCE-values met by the scans are 0 in most cases
+		uint64 lce = 0;
+
+		{
+			typename alphabet_vector_type::const_iterator it1(m_t.begin() + _pos1), it2(m_t.begin() + _pos2);
+
+			for (const uint64 end = std::min(max_lce, step); lce < end; ++lce, ++it1, ++it2) {
+
+				if (*it1 != *it2) return lce;
+			}
+		}
+
+		if (lce == max_lce) return lce;
+
+		// step 2: the first lce characters match, search by fingerprints
+		return compute(_pos1, _pos2, lce, max_lce, true);
+	}
+
+	/// \brief LCE of suf(_pos1) and suf(_pos2), known to be in [_low, _high], by fingerprints only
+	///
+	/// \param _is_galloping whether to gallop from _low, otherwise search [_low, _high] by bisection
+	uint64 compute(const uint64 _pos1, const uint64 _pos2, uint64 _low, uint64 _high, bool _is_galloping) {
+
+		if (_low >= _high) return _low;
+
+		if (m_checkpoint == nullptr) load_or_record();
+
+		const fp_value_type base1 = m_checkpoint->prefix(m_t, _pos1), base2 = m_checkpoint->prefix(m_t, _pos2);
+
+		while (_low < _high) {
+
+			const uint64 k = _is_galloping ? std::min(_high, std::max<uint64>(1, 2 * _low)) : _low + (_high - _low + 1) / 2;
+
+			if (is_match(_pos1, _pos2, base1, base2, k)) {
+
+				_low = k;
+			}
+			else { // mismatch within the first k characters, stop galloping
+
+				_high = k - 1, _is_galloping = false;
+			}
+		}
+
+		return _low;
+	}
+
+private:
+
+	/// \brief whether fp[_pos1, _pos1 + _k - 1] = fp[_pos2, _pos2 + _k - 1], given _base1 = fp[0, _pos1 - 1] and _base2 = fp[0, _pos2 - 1]
+	bool is_match(const uint64 _pos1, const uint64 _pos2, const fp_value_type _base1, const fp_value_type _base2, const uint64 _k) const {
+
+		const fp_value_type r_pow = m_rinterval->compute(_k);
+
+		const fp_value_type fp1 = fingerprint_type::interval(m_checkpoint->prefix(m_t, _pos1 + _k), _base1, r_pow);
+
+		const fp_value_type fp2 = fingerprint_type::interval(m_checkpoint->prefix(m_t, _pos2 + _k), _base2, r_pow);
+
+		return fp1 == fp2;
+	}
+
+	/// \brief load the samples from the sidecar file, or record them in RAM by a scan of T
+	///
+	/// The sidecar file is only read, such that two scans running concurrently never write it.
+	void load_or_record() {
+
+		m_rinterval = new RInterval<fingerprint_type>(m_len);
+
+		if (!m_config.fp_index_fn.empty() && BasicIO::file_exists(m_config.fp_index_fn)) {
+
+			m_checkpoint = new checkpoint_type(m_len, m_config.fp_index_fn, m_config.fp_index_step, m_config.t_fn);
+
+			if (m_checkpoint->is_ready()) return;
+
+			delete m_checkpoint; m_checkpoint = nullptr;
+		}
+
+		m_checkpoint = new checkpoint_type(m_len, "", m_config.fp_index_step, "");
+
+		PrefixFingerprint<alphabet_vector_type, fingerprint_type> prefix_fp(m_t, m_config, m_checkpoint);
+
+		NoRequest requests;
+
+		prefix_fp.answer(requests, [](const typename NoRequest::value_type&, const fp_value_type, const typename alphabet_vector_type::value_type) {});
+
+		std::cerr << "LCE: fingerprint samples recorded in RAM, step: " << m_checkpoint->step() << std::endl;
+	}
+};
+
+#endif // __LCE_H
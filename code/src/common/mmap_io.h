@@ -0,0 +1,353 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file mmap_io.h
+/// \brief read-only memory mapping of the input files
+///
+/// If T, SA and LCP fit in the available memory, they are mapped once and the readers scan the mappings directly,
+/// thus no block is copied into a buffer and the kernel readahead loads the pages ahead of the scans.
+/// The mappings are advised by their access patterns. T is only scanned, thus it is advised sequential and huge pages are requested.
+/// SA and LCP are also read by the bucket readers at many positions in turn, thus they are only advised willneed,
+/// as the free-behind of a sequential mapping would evict the pages the other buckets still need.
+/// The mapped files are registered by name in mapped_files(), which the readers look up.
+/// The bytes handed out from the mappings are added to mapped_read_volume(), as no read is issued for them.
+///
+/// \note a mapped file must not be modified while mapped
+///
+/// \author Yi Wu
+/// \date 2017.1
+///////////////////////////////////////////////////////////
+
+#ifndef __MMAP_IO_H
+#define __MMAP_IO_H
+
+#include "common.h"
+
+#include <atomic>
+
+#include <cstdio>
+
+#include <cstdlib>
+
+#include <cstring>
+
+#include <map>
+
+#include <string>
+
+#include <fcntl.h>
+
+#include <sys/mman.h>
+
+#include <sys/stat.h>
+
+#include <unistd.h>
+
+NAMESPACE_UTILITY_BEG
+
+/// \brief typed read-only view of contiguous elements
+template<typename value_type>
+class span {
+
+private:
+
+	const value_type* m_data; ///< first element
+
+	uint64 m_size; ///< number of elements
+
+public:
+
+	/// \brief ctor
+	span(const value_type* _data = nullptr, const uint64 _size = 0) : m_data(_data), m_size(_size) {}
+
+	/// \brief first element
+	const value_type* data() const {
+
+		return m_data;
+	}
+
+	/// \brief number of elements
+	uint64 size() const {
+
+		return m_size;
+	}
+
+	/// \brief the _i-th element
+	const value_type& operator[](const uint64 _i) const {
+
+		return m_data[_i];
+	}
+
+	/// \brief sub-view of the elements [_beg, _end)
+	span subspan(const uint64 _beg, const uint64 _end) const {
+
+		return span(m_data + _beg, _end - _beg);
+	}
+};
+
+/// \brief total bytes read from the mappings by the scan readers and the bucket readers
+inline std::atomic<uint64>& mapped_read_volume() {
+
+	static std::atomic<uint64> volume(0);
+
+	return volume;
+}
+
+/// \brief read-only mapping of a whole file
+class mapped_file {
+
+private:
+
+	std::string m_fn; ///< file name
+
+	char* m_data; ///< mapped bytes, nullptr if the file is empty
+
+	uint64 m_bytes; ///< file size in bytes
+
+public:
+
+	/// \brief ctor, exit if the file cannot be mapped
+	///
+	/// \param _is_sequential the file is only scanned from one end to the other
+	mapped_file(const std::string& _fn, const bool _is_sequential) : m_fn(_fn), m_data(nullptr), m_bytes(0) {
+
+		const int fd = open(m_fn.c_str(), O_RDONLY);
+
+		struct stat st;
+
+		if (fd == -1 || fstat(fd, &st) != 0) {
+
+			std::perror(m_fn.c_str());
+
+			std::exit(EXIT_FAILURE);
+		}
+
+		m_bytes = st.st_size;
+
+		if (m_bytes != 0) {
+
+			void* addr = mmap(nullptr, m_bytes, PROT_READ, MAP_SHARED, fd, 0);
+
+			if (addr == MAP_FAILED) {
+
+				std::perror(m_fn.c_str());
+
+				std::exit(EXIT_FAILURE);
+			}
+
+			m_data = static_cast<char*>(addr);
+
+			// hints only, ignore the failures
+			madvise(m_data, m_bytes, MADV_WILLNEED);
+
+			if (_is_sequential) {
+
+				madvise(m_data, m_bytes, MADV_SEQUENTIAL);
+
+#ifdef MADV_HUGEPAGE
+				madvise(m_data, m_bytes, MADV_HUGEPAGE);
+#endif
+			}
+		}
+
+		close(fd); // the mapping stays valid
+	}
+
+	/// \brief dtor
+	~mapped_file() {
+
+		if (m_data != nullptr) munmap(m_data, m_bytes);
+
+		m_data = nullptr;
+	}
+
+	/// \brief file name
+	const std::string& file_name() const {
+
+		return m_fn;
+	}
+
+	/// \brief file size in bytes
+	uint64 bytes() const {
+
+		return m_bytes;
+	}
+
+	/// \brief the file viewed as elements of value_type
+	template<typename value_type>
+	span<value_type> as() const {
+
+		return span<value_type>(reinterpret_cast<const value_type*>(m_data), m_bytes / sizeof(value_type));
+	}
+};
+
+/// \brief files mapped for the run, looked up by name
+class mapped_file_table {
+
+private:
+
+	std::map<std::string, mapped_file*> m_files; ///< mapped files
+
+public:
+
+	/// \brief dtor
+	~mapped_file_table() {
+
+		clear();
+	}
+
+	/// \brief map a file if not mapped yet
+	///
+	/// \param _is_sequential the file is only scanned, see mapped_file
+	void insert(const std::string& _fn, const bool _is_sequential) {
+
+		if (m_files.find(_fn) == m_files.end()) m_files[_fn] = new mapped_file(_fn, _is_sequential);
+	}
+
+	/// \brief return the mapping of a file, nullptr if not mapped
+	const mapped_file* find(const std::string& _fn) const {
+
+		std::map<std::string, mapped_file*>::const_iterator it = m_files.find(_fn);
+
+		return (it == m_files.end()) ? nullptr : it->second;
+	}
+
+	/// \brief unmap all the files
+	void clear() {
+
+		for (std::map<std::string, mapped_file*>::iterator it = m_files.begin(); it != m_files.end(); ++it) {
+
+			delete it->second; it->second = nullptr;
+		}
+
+		m_files.clear();
+	}
+
+	/// \brief total bytes mapped
+	uint64 bytes() const {
+
+		uint64 total_bytes = 0;
+
+		for (std::map<std::string, mapped_file*>::const_iterator it = m_files.begin(); it != m_files.end(); ++it) {
+
+			total_bytes += it->second->bytes();
+		}
+
+		return total_bytes;
+	}
+};
+
+/// \brief files mapped for the run
+///
+/// \note the table is filled before the scans start, thus the concurrent readers only look it up
+inline mapped_file_table& mapped_files() {
+
+	static mapped_file_table table;
+
+	return table;
+}
+
+/// \brief view a mapped file as elements of value_type, return false if the file is not mapped
+template<typename value_type>
+bool find_mapped(const std::string& _fn, span<value_type>& _span) {
+
+	const mapped_file* file = _fn.empty() ? nullptr : mapped_files().find(_fn);
+
+	if (file == nullptr) return false;
+
+	_span = file->as<value_type>();
+
+	return true;
+}
+
+/// \brief available memory in bytes, MemAvailable if reported, otherwise the free physical pages
+inline uint64 available_memory() {
+
+	uint64 kb = 0;
+
+	std::FILE* f = std::fopen("/proc/meminfo", "r");
+
+	if (f != nullptr) {
+
+		char line[256];
+
+		while (std::fgets(line, sizeof(line), f) != nullptr) {
+
+			if (std::strncmp(line, "MemAvailable:", 13) == 0) {
+
+				kb = std::strtoull(line + 13, nullptr, 10);
+
+				break;
+			}
+		}
+
+		std::fclose(f);
+	}
+
+	if (kb != 0) return kb * 1024;
+
+	const long pages = sysconf(_SC_AVPHYS_PAGES), page_size = sysconf(_SC_PAGESIZE);
+
+	return (pages > 0 && page_size > 0) ? static_cast<uint64>(pages) * page_size : 0;
+}
+
+/// \brief scan a span from left to right or from right to left
+///
+/// \note the interface is stxxl-like, i.e., empty(), operator* and operator++
+template<typename value_type>
+class span_reader {
+
+private:
+
+	const value_type* m_cur; ///< current element
+
+	uint64 m_size; ///< number of elements in the span
+
+	uint64 m_left; ///< number of elements left, including the current one
+
+	bool m_reverse; ///< scan from right to left
+
+public:
+
+	/// \brief ctor
+	span_reader(const span<value_type>& _span, const bool _reverse) : m_size(_span.size()), m_left(_span.size()), m_reverse(_reverse) {
+
+		m_cur = (m_reverse && m_left != 0) ? _span.data() + m_left - 1 : _span.data();
+	}
+
+	/// \brief dtor, count the elements scanned
+	~span_reader() {
+
+		mapped_read_volume().fetch_add((m_size - m_left) * sizeof(value_type), std::memory_order_relaxed);
+	}
+
+	/// \brief check if empty
+	bool empty() const {
+
+		return m_left == 0;
+	}
+
+	/// \brief current element
+	const value_type& operator*() const {
+
+		return *m_cur;
+	}
+
+	/// \brief current element
+	const value_type* operator->() const {
+
+		return m_cur;
+	}
+
+	/// \brief move to the next element
+	span_reader& operator++() {
+
+		if (--m_left != 0) m_cur = m_reverse ? m_cur - 1 : m_cur + 1;
+
+		return *this;
+	}
+};
+
+NAMESPACE_UTILITY_END
+
+#endif // __MMAP_IO_H
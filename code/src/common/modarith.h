@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file modarith.h
+/// \brief modular arithmetic over a 31-bit prime fixed at compile time
+///
+/// The reduction strategy is a template parameter, such that the arithmetic can be swapped in one place for benchmarking.
+/// DivisionReduction: x % MOD, which the compiler turns into a multiplication by the reciprocal as MOD is a template constant.
+/// BarrettReduction: x - floor(x * m / 2^64) * MOD with m = floor(2^64 / MOD), followed by at most one subtraction.
+/// MontgomeryReduction: two REDC steps with 2^32 as the Montgomery radix, REDC(REDC(x) * (2^64 mod MOD)) = x mod MOD.
+/// All strategies take and return residues in the ordinary representation, so that the fingerprints are identical.
+/// Measured on the check loop pattern (one multiplication and one subtraction per range fingerprint),
+/// DivisionReduction is the fastest with GCC -O3, followed by BarrettReduction and MontgomeryReduction.
+///
+/// \author Yi Wu
+/// \date 2016.12
+///////////////////////////////////////////////////////////
+
+#ifndef __MODARITH_H
+#define __MODARITH_H
+
+#include "common.h"
+
+/// \brief reduce by a 64-bit division
+struct DivisionReduction {};
+
+/// \brief reduce by Barrett's method
+struct BarrettReduction {};
+
+/// \brief reduce by Montgomery's method
+struct MontgomeryReduction {};
+
+/// \brief Newton's iteration for _mod^(-1) mod 2^32, each step doubles the number of correct bits
+constexpr uint32 mod_inverse32(const uint32 _mod, const uint32 _inv, const int _iter) {
+
+	return _iter == 0 ? _inv : mod_inverse32(_mod, _inv * (2u - _mod * _inv), _iter - 1);
+}
+
+/// \brief reduction of x < MOD * 2^32 modulo MOD, specialized for each strategy
+template<uint32 MOD, typename reduction_type>
+struct ModReduce;
+
+/// \brief reduction by a 64-bit division
+template<uint32 MOD>
+struct ModReduce<MOD, DivisionReduction> {
+
+	static uint32 reduce(const uint64 _x) {
+
+		return static_cast<uint32>(_x % MOD);
+	}
+};
+
+/// \brief Barrett reduction
+template<uint32 MOD>
+struct ModReduce<MOD, BarrettReduction> {
+
+	static constexpr uint64 M = ~0ull / MOD; ///< floor(2^64 / MOD), MOD is odd
+
+	static uint32 reduce(const uint64 _x) {
+
+		const uint64 q = static_cast<uint64>((static_cast<unsigned __int128>(_x) * M) >> 64); // floor(x / MOD) - 1 <= q <= floor(x / MOD)
+
+		const uint32 r = static_cast<uint32>(_x - q * MOD) - MOD; // _x - q * MOD < 2 * MOD, wraps around if below MOD
+
+		return r + (MOD & (0u - (r >> 31)));
+	}
+};
+
+/// \brief Montgomery reduction
+template<uint32 MOD>
+struct ModReduce<MOD, MontgomeryReduction> {
+
+	static constexpr uint32 NEG_INV = 0u - mod_inverse32(MOD, MOD, 5); ///< -MOD^(-1) mod 2^32
+
+	static constexpr uint64 R2 = (~0ull % MOD + 1) % MOD; ///< 2^64 mod MOD
+
+	/// \brief compute x * 2^(-32) mod MOD for x < MOD * 2^32
+	static uint32 redc(const uint64 _x) {
+
+		const uint32 m = static_cast<uint32>(_x) * NEG_INV;
+
+		const uint32 t = static_cast<uint32>((_x + static_cast<uint64>(m) * MOD) >> 32) - MOD; // the quotient is below 2 * MOD, wraps around if below MOD
+
+		return t + (MOD & (0u - (t >> 31)));
+	}
+
+	static uint32 reduce(const uint64 _x) {
+
+		return redc(static_cast<uint64>(redc(_x)) * R2);
+	}
+};
+
+/// \brief arithmetic modulo a 31-bit prime MOD
+///
+/// \param MOD modulus, MOD < 2^31
+/// \param reduction_type DivisionReduction, BarrettReduction or MontgomeryReduction
+template<uint32 MOD, typename reduction_type>
+struct ModArith {
+
+	static_assert(MOD < (1u << 31) && (MOD & 1) == 1, "MOD must be an odd number below 2^31");
+
+	typedef ModReduce<MOD, reduction_type> reduce_type;
+
+	/// \brief compute _x mod MOD for _x < MOD * 2^32
+	static uint32 reduce(const uint64 _x) {
+
+		return reduce_type::reduce(_x);
+	}
+
+	/// \brief compute _a * _b mod MOD
+	static uint32 mul(const uint32 _a, const uint32 _b) {
+
+		return reduce(static_cast<uint64>(_a) * _b);
+	}
+
+	/// \brief compute _a + _b mod MOD, branch-free since the comparison is unpredictable
+	static uint32 add(const uint32 _a, const uint32 _b) {
+
+		const uint32 ret = _a + _b - MOD; // wraps around if _a + _b < MOD
+
+		return ret + (MOD & (0u - (ret >> 31)));
+	}
+
+	/// \brief compute _a - _b mod MOD, branch-free since the comparison is unpredictable
+	static uint32 sub(const uint32 _a, const uint32 _b) {
+
+		const uint32 ret = _a - _b; // wraps around if _a < _b
+
+		return ret + (MOD & (0u - (ret >> 31)));
+	}
+};
+
+#endif // __MODARITH_H
@@ -0,0 +1,396 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file multi_fp.h
+/// \brief k independent Karp-Rabin fingerprints with random (P, R) pairs
+///
+/// The pairs are derived from a seed by splitmix64: each P_j is a prime in [2^60, 2^61) verified by a deterministic
+/// Miller-Rabin test and each R_j is drawn uniformly from [2, P_j - 1).
+/// Two different strings of length at most n collide in the j-th fingerprint with probability at most n / P_j,
+/// thus the probability that any of m comparisons is wrong in all k fingerprints is at most m * prod_j (n / P_j).
+///
+/// \author Yi Wu
+/// \date 2016.12
+///////////////////////////////////////////////////////////
+
+#ifndef __MULTI_FP_H
+#define __MULTI_FP_H
+
+#include "common.h"
+
+#include "tuples.h"
+
+#include "widget.h"
+
+#include <algorithm>
+
+#include <cmath>
+
+#include <cstdlib>
+
+#include <cstring>
+
+#include <iostream>
+
+#include <vector>
+
+/// \brief k fingerprints computed side by side
+class MultiFingerprint {
+
+public:
+
+	static const uint64 MAX_NUM = 4; ///< maximum number of fingerprints
+
+private:
+
+	uint64 m_num; ///< number of fingerprints
+
+	std::vector<uint64> m_mod; ///< P_j
+
+	std::vector<uint64> m_base; ///< R_j
+
+	uint64 m_shift; ///< B = 2^m_shift, B * B > maximum power
+
+	uint64 m_mask; ///< B - 1
+
+	uint64 m_max; ///< maximum power supported by the tables
+
+	std::vector<uint64> m_low; ///< m_low[j * B + i] = R_j^i mod P_j
+
+	std::vector<uint64> m_high; ///< m_high[j * H + i] = R_j^(i * B) mod P_j
+
+public:
+
+	/// \brief ctor
+	///
+	/// \param _num number of fingerprints
+	/// \param _seed seed for generating the (P, R) pairs
+	/// \param _len maximum power to be computed, typically the length of input string
+	MultiFingerprint(const uint64 _num, const uint64 _seed, const uint64 _len) : m_num(_num), m_mod(_num), m_base(_num) {
+
+		if (m_num > MAX_NUM) {
+
+			std::cerr << "At most " << MAX_NUM << " extra fingerprints are supported, " << m_num << " given\n";
+
+			std::exit(EXIT_FAILURE);
+		}
+
+		uint64 state = _seed;
+
+		for (uint64 j = 0; j < m_num; ++j) {
+
+			uint64 p = (splitmix64(state) >> 4) | (1ull << 60); // p in [2^60, 2^61)
+
+			p |= 1;
+
+			while (!is_prime(p)) p += 2;
+
+			m_mod[j] = p;
+
+			m_base[j] = 2 + splitmix64(state) % (p - 3);
+		}
+
+		// two-level tables of powers, see RInterval
+		m_max = _len;
+
+		m_shift = 0;
+
+		while (m_shift < 31 && (1ull << (2 * m_shift)) <= _len) ++m_shift;
+
+		m_mask = (1ull << m_shift) - 1;
+
+		const uint64 low_num = 1ull << m_shift, high_num = (_len >> m_shift) + 1;
+
+		m_low.resize(m_num * low_num);
+
+		m_high.resize(m_num * high_num);
+
+		for (uint64 j = 0; j < m_num; ++j) {
+
+			uint64* low = &m_low[j * low_num], *high = &m_high[j * high_num];
+
+			low[0] = 1;
+
+			for (uint64 i = 1; i < low_num; ++i) low[i] = mul(j, low[i - 1], m_base[j]);
+
+			const uint64 r_b = mul(j, low[low_num - 1], m_base[j]);
+
+			high[0] = 1;
+
+			for (uint64 i = 1; i < high_num; ++i) high[i] = mul(j, high[i - 1], r_b);
+		}
+	}
+
+	/// \brief number of fingerprints
+	uint64 num() const {
+
+		return m_num;
+	}
+
+	/// \brief P_j
+	uint64 mod(const uint64 _j) const {
+
+		return m_mod[_j];
+	}
+
+	/// \brief R_j
+	uint64 base(const uint64 _j) const {
+
+		return m_base[_j];
+	}
+
+	/// \brief compute _a * _b mod P_j
+	uint64 mul(const uint64 _j, const uint64 _a, const uint64 _b) const {
+
+		return static_cast<uint64>(static_cast<unsigned __int128>(_a) * _b % m_mod[_j]);
+	}
+
+	/// \brief compute R_j^_k mod P_j
+	uint64 power(const uint64 _j, uint64 _k) const {
+
+		if (_k <= m_max) {
+
+			const uint64 low_num = m_mask + 1, high_num = (m_max >> m_shift) + 1;
+
+			return mul(_j, m_high[_j * high_num + (_k >> m_shift)], m_low[_j * low_num + (_k & m_mask)]);
+		}
+
+		uint64 ret = 1, base = m_base[_j];
+
+		for (; _k != 0; _k >>= 1) {
+
+			if (_k & 1) ret = mul(_j, ret, base);
+
+			base = mul(_j, base, base);
+		}
+
+		return ret;
+	}
+
+	/// \brief append _num characters to the k fingerprints in _fps
+	template<typename alphabet_type>
+	void advance(uint64* _fps, const alphabet_type* _chars, const uint64 _num) const {
+
+		for (uint64 j = 0; j < m_num; ++j) {
+
+			const unsigned __int128 base = m_base[j];
+
+			const uint64 mod = m_mod[j];
+
+			uint64 fp = _fps[j];
+
+			for (uint64 i = 0; i < _num; ++i) {
+
+				fp = static_cast<uint64>((fp * base + (static_cast<uint64>(_chars[i]) + 1)) % mod); // plus 1 to avoid equal to 0
+			}
+
+			_fps[j] = fp;
+		}
+	}
+
+	/// \brief _left = _left * R_j^_len + _right for each j, where _len is the length of the string fingerprinted by _right
+	void concat(uint64* _left, const uint64* _right, const uint64 _len) const {
+
+		for (uint64 j = 0; j < m_num; ++j) {
+
+			_left[j] = (mul(j, _left[j], power(j, _len)) + _right[j]) % m_mod[j];
+		}
+	}
+
+	/// \brief compute fp_j[i, i + _len - 1] = fp_j[0, i + _len - 1] - fp_j[0, i - 1] * R_j^_len mod P_j
+	uint64 interval(const uint64 _j, const uint64 _fp_end, const uint64 _fp_beg, const uint64 _len) const {
+
+		const uint64 sub = mul(_j, _fp_beg, power(_j, _len));
+
+		return (_fp_end >= sub) ? _fp_end - sub : _fp_end + m_mod[_j] - sub;
+	}
+
+	/// \brief number of extra fingerprints stored per stream record for _num fingerprints, rounded up to 0, 2 or MAX_NUM
+	///
+	/// The records are instantiated for these sizes only, the slots beyond _num are left zero.
+	static uint64 record_num(const uint64 _num) {
+
+		return (_num == 0) ? 0 : ((_num <= 2) ? 2 : MAX_NUM);
+	}
+
+	/// \brief log2 of the probability that any of _comparisons comparisons between strings of length at most _len is wrong in all k fingerprints
+	double log2_error_bound(const uint64 _len, const uint64 _comparisons) const {
+
+		double ret = std::log2(static_cast<double>(std::max<uint64>(_comparisons, 1)));
+
+		for (uint64 j = 0; j < m_num; ++j) {
+
+			ret += std::log2(static_cast<double>(std::max<uint64>(_len, 1))) - std::log2(static_cast<double>(m_mod[j]));
+		}
+
+		return std::min(ret, 0.0);
+	}
+
+	/// \brief splitmix64 generator
+	static uint64 splitmix64(uint64& _state) {
+
+		uint64 z = (_state += 0x9E3779B97F4A7C15ull);
+
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+
+		return z ^ (z >> 31);
+	}
+
+	/// \brief deterministic Miller-Rabin test for 64-bit integers
+	static bool is_prime(const uint64 _n) {
+
+		if (_n < 2) return false;
+
+		static const uint64 bases[12] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+
+		for (int i = 0; i < 12; ++i) {
+
+			if (_n % bases[i] == 0) return _n == bases[i];
+		}
+
+		uint64 d = _n - 1, s = 0;
+
+		while ((d & 1) == 0) d >>= 1, ++s;
+
+		for (int i = 0; i < 12; ++i) {
+
+			uint64 x = pow_mod(bases[i], d, _n);
+
+			if (x == 1 || x == _n - 1) continue;
+
+			bool is_composite = true;
+
+			for (uint64 r = 1; r < s && is_composite; ++r) {
+
+				x = static_cast<uint64>(static_cast<unsigned __int128>(x) * x % _n);
+
+				if (x == _n - 1) is_composite = false;
+			}
+
+			if (is_composite) return false;
+		}
+
+		return true;
+	}
+
+private:
+
+	/// \brief compute _a^_e mod _n
+	static uint64 pow_mod(uint64 _a, uint64 _e, const uint64 _n) {
+
+		uint64 ret = 1;
+
+		for (_a %= _n; _e != 0; _e >>= 1) {
+
+			if (_e & 1) ret = static_cast<uint64>(static_cast<unsigned __int128>(ret) * _a % _n);
+
+			_a = static_cast<uint64>(static_cast<unsigned __int128>(_a) * _a % _n);
+		}
+
+		return ret;
+	}
+};
+
+/// \brief a tuple followed by K extra fingerprints, sorted or permuted back as a whole by its first component
+///
+/// The extra fingerprints are carried in the records of the output streams, such that the index is stored and sorted once
+/// and each stream keeps a single sorter with its full memory budget.
+/// They are stored as bytes to keep the record unaligned like the packed tuple, without padding.
+template<typename tuple_type, uint64 K>
+struct ExtraTuple : public tuple_type {
+
+	uint8 extra[K * sizeof(uint64)]; ///< extra fingerprints
+
+	/// \brief constructor, default
+	ExtraTuple() : tuple_type() {
+
+		std::memset(extra, 0, sizeof(extra));
+	}
+
+	/// \brief constructor, component
+	///
+	/// \param _num number of fingerprints in _extra, at most K
+	ExtraTuple(const tuple_type& _tuple, const uint64* _extra, const uint64 _num) : tuple_type(_tuple) {
+
+		std::memset(extra, 0, sizeof(extra));
+
+		std::memcpy(extra, _extra, _num * sizeof(uint64));
+	}
+
+	/// \brief the _j-th extra fingerprint
+	uint64 get_extra(const uint64 _j) const {
+
+		uint64 ret;
+
+		std::memcpy(&ret, extra + _j * sizeof(uint64), sizeof(uint64));
+
+		return ret;
+	}
+
+	/// \brief min value
+	static ExtraTuple& min_value() {
+
+		static ExtraTuple min_val = ExtraTuple();
+
+		return min_val;
+	}
+
+	/// \brief max value
+	static ExtraTuple& max_value() {
+
+		static ExtraTuple max_val = make_max();
+
+		return max_val;
+	}
+
+private:
+
+	/// \brief all components set to their maximum values
+	static ExtraTuple make_max() {
+
+		ExtraTuple ret;
+
+		static_cast<tuple_type&>(ret) = tuple_type::max_value();
+
+		std::memset(ret.extra, 0xff, sizeof(ret.extra));
+
+		return ret;
+	}
+};
+
+/// \brief no extra fingerprint, the record is the tuple itself
+template<typename tuple_type>
+struct ExtraTuple<tuple_type, 0> : public tuple_type {
+
+	/// \brief constructor, default
+	ExtraTuple() : tuple_type() {}
+
+	/// \brief constructor, component
+	ExtraTuple(const tuple_type& _tuple, const uint64*, const uint64) : tuple_type(_tuple) {}
+
+	/// \brief never called
+	uint64 get_extra(const uint64) const {
+
+		return 0;
+	}
+
+	/// \brief min value
+	static ExtraTuple& min_value() {
+
+		static ExtraTuple min_val = ExtraTuple();
+
+		return min_val;
+	}
+
+	/// \brief max value
+	static ExtraTuple& max_value() {
+
+		static ExtraTuple max_val = ExtraTuple(tuple_type::max_value(), nullptr, 0);
+
+		return max_val;
+	}
+};
+
+#endif // __MULTI_FP_H
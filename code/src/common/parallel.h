@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file parallel.h
+/// \brief helpers for running tasks on multiple threads
+///
+///
+/// \author Yi Wu
+/// \date 2016.12
+///////////////////////////////////////////////////////////
+
+#ifndef __PARALLEL_H
+#define __PARALLEL_H
+
+#include "common.h"
+
+#include <algorithm>
+
+#include <thread>
+
+#include <vector>
+
+/// \brief execute _task(k) for k = 0, 1, ..., _thread_num - 1 in parallel, the calling thread runs _task(0)
+template<typename task_type>
+void run_parallel(const uint64 _thread_num, task_type _task) {
+
+	std::vector<std::thread> threads;
+
+	for (uint64 k = 1; k < _thread_num; ++k) {
+
+		threads.push_back(std::thread(_task, k));
+	}
+
+	_task(0);
+
+	for (uint64 k = 0; k < threads.size(); ++k) {
+
+		threads[k].join();
+	}
+}
+
+/// \brief split [0, _num) into _thread_num chunks of nearly equal sizes, the k-th chunk is [_chunk_beg[k], _chunk_beg[k + 1])
+inline void split_range(const uint64 _num, const uint64 _thread_num, std::vector<uint64>& _chunk_beg) {
+
+	_chunk_beg.resize(_thread_num + 1);
+
+	for (uint64 k = 0; k <= _thread_num; ++k) {
+
+		_chunk_beg[k] = _num / _thread_num * k + std::min(k, _num % _thread_num);
+	}
+}
+
+#endif // __PARALLEL_H
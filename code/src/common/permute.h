@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file permute.h
+/// \brief restore the original order of elements tagged with a dense index
+///
+/// If the indices of n elements form a permutation of [base, base + n), sorting them by index is the same as
+/// writing each element to slot (index - base), which costs O(n) time instead of O(n log n).
+///
+/// \author Yi Wu
+/// \date 2016.12
+///////////////////////////////////////////////////////////
+
+#ifndef __PERMUTE_H
+#define __PERMUTE_H
+
+#include "common.h"
+
+#include "parallel.h"
+
+#include <algorithm>
+
+#include <vector>
+
+/// \brief scatter an in-RAM array by a dense index
+///
+/// \param value_type type of elements
+template<typename value_type>
+struct ParallelScatter {
+
+	/// \brief _dst[_index(_src[i])] = _src[i] for 0 <= i < _num
+	///
+	/// \param _src source array
+	/// \param _dst destination array, _index(e) must be a permutation of [0, _num) over the elements
+	/// \param _num number of elements
+	/// \param _thread_num number of worker threads
+	/// \param _index callable object, _index(e) returns the destination slot of element e
+	template<typename index_func_type>
+	static void scatter(const value_type* _src, value_type* _dst, const uint64 _num, const uint64 _thread_num, index_func_type _index) {
+
+		if (_num == 0) return;
+
+		const uint64 thread_num = std::max<uint64>(1, std::min(_thread_num, _num));
+
+		std::vector<uint64> chunk_beg;
+
+		split_range(_num, thread_num, chunk_beg);
+
+		run_parallel(thread_num, [&](const uint64 _k) {
+
+			for (uint64 i = chunk_beg[_k]; i < chunk_beg[_k + 1]; ++i) {
+
+				_dst[static_cast<uint64>(_index(_src[i]))] = _src[i];
+			}
+		});
+	}
+};
+
+/// \brief in-RAM replacement of an stxxl sorter sorting tuples by their first components
+///
+/// The first components of the pushed tuples must be distinct and lie in [_base, _base + _capacity).
+/// Tuples are scattered to their slots on push, sort() is a no-op and the output lists the first pushed_num slots.
+/// It provides the subset of the stxxl sorter interface used by the validators: push, sort, operator*, operator->, operator++ and empty.
+///
+/// \param tuple_type type of tuples
+template<typename tuple_type>
+class PermuteBack {
+
+private:
+
+	tuple_type* m_data; ///< slots
+
+	uint64 m_base; ///< smallest first component
+
+	uint64 m_capacity; ///< number of slots
+
+	uint64 m_num; ///< number of pushed tuples
+
+	uint64 m_cur; ///< current slot in the output mode
+
+public:
+
+	/// \brief ctor
+	///
+	/// \param _capacity number of slots
+	/// \param _base smallest first component
+	PermuteBack(const uint64 _capacity, const uint64 _base) : m_base(_base), m_capacity(_capacity), m_num(0), m_cur(0) {
+
+		m_data = new tuple_type[m_capacity];
+	}
+
+	/// \brief dtor
+	~PermuteBack() {
+
+		delete[] m_data; m_data = nullptr;
+	}
+
+	/// \brief bytes required for _capacity slots
+	static uint64 memory(const uint64 _capacity) {
+
+		return _capacity * sizeof(tuple_type);
+	}
+
+	/// \brief write the tuple to its slot
+	void push(const tuple_type& _tuple) {
+
+		m_data[static_cast<uint64>(_tuple.first) - m_base] = _tuple;
+
+		++m_num;
+	}
+
+	/// \brief switch to the output mode
+	void sort() {
+
+		m_cur = 0;
+	}
+
+	const tuple_type& operator*() const {
+
+		return m_data[m_cur];
+	}
+
+	const tuple_type* operator->() const {
+
+		return m_data + m_cur;
+	}
+
+	PermuteBack& operator++() {
+
+		++m_cur;
+
+		return *this;
+	}
+
+	bool empty() const {
+
+		return m_cur >= m_num;
+	}
+};
+
+#endif // __PERMUTE_H
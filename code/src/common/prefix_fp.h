@@ -0,0 +1,502 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file prefix_fp.h
+/// \brief multi-threaded computation of prefix fingerprints fp[0, i - 1] over the input string
+///
+/// T is loaded window by window. Each window is split into one chunk per thread.
+/// Step 1: each thread computes the local fingerprint of its chunk, i.e., the fingerprint starting from zero.
+/// Step 2: fp[0, chunk_beg - 1] of each chunk is derived sequentially by concatenating
+/// the local fingerprints from left to right, which costs O(thread_num) per window.
+/// Step 3: each thread rescans its chunk starting from fp[0, chunk_beg - 1] to answer the requests falling in the chunk.
+/// In steps 1 and 3, the characters between two requested positions are consumed by FingerprintKernel in strides.
+///
+/// If a FingerprintCheckpoint is given, windows and chunks are aligned to its sampling step.
+/// When its samples are available, steps 1 and 2 are replaced by looking up the samples and windows without requests are skipped;
+/// otherwise, the samples are recorded in step 1 and the scan proceeds to the end of T to complete them.
+///
+/// If a MultiFingerprint is given, its k fingerprints are computed side by side with the same three steps.
+/// The samples only cover the main fingerprint, so windows are never skipped in this case.
+///
+/// If T is memory mapped (see mmap_io.h), a window points into the mapping instead of being copied.
+///
+/// \author Yi Wu
+/// \date 2016.12
+///////////////////////////////////////////////////////////
+
+#ifndef __PREFIX_FP_H
+#define __PREFIX_FP_H
+
+#include "common.h"
+
+#include "config.h"
+
+#include "fingerprint.h"
+
+#include "checkpoint.h"
+
+#include "multi_fp.h"
+
+#include "async_stream_reader.h"
+
+#include "mmap_io.h"
+
+#include "parallel.h"
+
+#include <algorithm>
+
+#include <vector>
+
+/// \brief answer requests for prefix fingerprints in parallel
+///
+/// \param alphabet_vector_type stxxl vector for the input string
+/// \param fingerprint_type fingerprinting backend
+template<typename alphabet_vector_type, typename fingerprint_type>
+class PrefixFingerprint {
+
+private:
+
+	typedef typename alphabet_vector_type::value_type alphabet_type;
+
+	typedef typename fingerprint_type::value_type fp_value_type;
+
+	typedef FingerprintKernel<fingerprint_type, alphabet_type> kernel_type; ///< consume 8 characters per step if alphabet_type = uint8
+
+	typedef FingerprintCheckpoint<alphabet_vector_type, fingerprint_type> checkpoint_type;
+
+	const alphabet_vector_type& m_t; ///< input string
+
+	uint64 m_len; ///< length of input string
+
+	uint64 m_thread_num; ///< number of worker threads
+
+	uint64 m_batch_size; ///< maximum number of requests answered per batch
+
+	uint64 m_window_size; ///< maximum number of characters per window
+
+	uint64 m_window_beg; ///< starting position of current window
+
+	uint64 m_window_end; ///< ending position of current window (exclusive)
+
+	alphabet_type* m_window_buf; ///< buffer of current window, nullptr if T is mapped
+
+	const alphabet_type* m_window; ///< characters in current window
+
+	RInterval<fingerprint_type>* m_rinterval; ///< R^k mod P for 0 <= k <= m_window_size
+
+	std::vector<uint64> m_chunk_beg; ///< starting position of each chunk, m_chunk_beg[m_thread_num] = m_window_end
+
+	std::vector<fp_value_type> m_chunk_fp; ///< fp[0, m_chunk_beg[k] - 1]
+
+	std::vector<uint64> m_cur_pos; ///< position reached by each thread in step 3
+
+	std::vector<fp_value_type> m_cur_fp; ///< fp[0, m_cur_pos[k] - 1]
+
+	checkpoint_type* m_checkpoint; ///< sampled prefix fingerprints, nullptr if not used
+
+	uint64 m_step; ///< sampling step of m_checkpoint, windows and chunks are aligned to it
+
+	std::vector<fp_value_type> m_local_samples; ///< local fingerprints at the sampled positions in current window
+
+	const MultiFingerprint* m_extra; ///< extra fingerprints, nullptr if not used
+
+	uint64 m_extra_num; ///< number of extra fingerprints
+
+	std::vector<uint64> m_chunk_extra; ///< extra fingerprints of fp[0, m_chunk_beg[k] - 1], m_extra_num per chunk
+
+	std::vector<uint64> m_cur_extra; ///< extra fingerprints of fp[0, m_cur_pos[k] - 1], m_extra_num per thread
+
+	std::string m_async_fn; ///< file of T read by an asynchronous stream, empty if read by the stxxl readers
+
+	uint64 m_async_buf_num; ///< number of buffers of the asynchronous stream
+
+	uint64 m_async_buf_size; ///< bytes per buffer of the asynchronous stream
+
+	bool m_use_uring; ///< the asynchronous stream reads by io_uring
+
+	utility::span<alphabet_type> m_mapped_t; ///< characters of the mapped T, empty if not mapped
+
+	const uint64* m_emit_extra; ///< extra fingerprints of the request being reported
+
+public:
+
+	/// \brief ctor
+	///
+	/// \param _t input string
+	/// \param _config settings for thread number, window size and batch size
+	/// \param _checkpoint sampled prefix fingerprints to use or to record, nullptr if not required
+	/// \param _extra extra fingerprints computed along with the main one, nullptr if not required
+	PrefixFingerprint(const alphabet_vector_type& _t, const Config& _config, checkpoint_type* _checkpoint = nullptr, const MultiFingerprint* _extra = nullptr) : m_t(_t), m_checkpoint(_checkpoint), m_extra(_extra) {
+
+		m_len = m_t.size();
+
+		m_thread_num = _config.thread_num;
+
+		m_batch_size = _config.fp_batch_size;
+
+		m_window_size = std::min(_config.fp_window_size, std::max(m_len, m_thread_num));
+
+		m_step = (m_checkpoint == nullptr) ? 1 : m_checkpoint->step();
+
+		m_window_size = std::max(m_step, m_window_size / m_step * m_step);
+
+		if (m_checkpoint != nullptr) {
+
+			m_local_samples.resize(m_window_size / m_step);
+		}
+
+		if (false == utility::find_mapped(_config.t_fn, m_mapped_t) || m_mapped_t.size() != m_len) m_mapped_t = utility::span<alphabet_type>();
+
+		m_window_buf = (m_mapped_t.data() != nullptr) ? nullptr : new alphabet_type[m_window_size];
+
+		m_window = m_window_buf;
+
+		m_rinterval = new RInterval<fingerprint_type>(m_window_size);
+
+		m_chunk_beg.resize(m_thread_num + 1);
+
+		m_chunk_fp.resize(m_thread_num + 1);
+
+		m_cur_pos.resize(m_thread_num);
+
+		m_cur_fp.resize(m_thread_num);
+
+		m_extra_num = (m_extra == nullptr) ? 0 : m_extra->num();
+
+		m_chunk_extra.resize((m_thread_num + 1) * m_extra_num);
+
+		m_cur_extra.resize(m_thread_num * m_extra_num);
+
+		m_emit_extra = nullptr;
+
+		m_async_fn = _config.async_io ? _config.t_fn : "";
+
+		m_async_buf_num = _config.async_buf_num;
+
+		m_async_buf_size = _config.async_buf_size;
+
+		m_use_uring = _config.io_uring;
+	}
+
+	/// \brief dtor
+	~PrefixFingerprint() {
+
+		delete[] m_window_buf; m_window_buf = nullptr;
+
+		delete m_rinterval; m_rinterval = nullptr;
+	}
+
+	/// \brief answer a stream of requests sorted by position
+	///
+	/// Each request r is a tuple with r.first specifying the position.
+	/// For each request, _callback(r, fp[0, r.first - 1], T[r.first]) is called in the order of the stream.
+	/// If r.first >= |T|, then fp[0, |T| - 1] is reported and the character is meaningless.
+	/// Within _callback, extra_fp() points to the extra fingerprints of fp[0, r.first - 1].
+	///
+	/// \param _requests stxxl-like stream, providing value_type, empty(), operator* and operator++
+	/// \param _callback callable object
+	template<typename request_stream_type, typename callback_type>
+	void answer(request_stream_type& _requests, callback_type _callback) {
+
+		typedef typename request_stream_type::value_type request_type;
+
+		std::vector<request_type> batch;
+
+		batch.reserve(m_batch_size);
+
+		std::vector<fp_value_type> batch_fp(m_batch_size);
+
+		std::vector<alphabet_type> batch_ch(m_batch_size);
+
+		std::vector<uint64> batch_beg(m_thread_num + 1);
+
+		std::vector<uint64> batch_extra(m_batch_size * m_extra_num);
+
+		std::vector<uint64> extra(m_extra_num, 0); // extra fingerprints of fp[0, m_window_beg - 1]
+
+		const bool is_seeking = (m_checkpoint != nullptr && m_checkpoint->is_ready() && m_extra == nullptr);
+
+		bool is_recording = (m_checkpoint != nullptr && !m_checkpoint->is_ready());
+
+		// a full scan with loaded samples compares them with the recomputed ones, and records all of them on a mismatch
+		const bool is_verifying = (m_checkpoint != nullptr && m_checkpoint->is_ready() && !is_seeking);
+
+		bool is_scanned = false; // whether the scan reaches the end of T
+
+		fp_value_type fp = 0; // fp[0, m_window_beg - 1], not maintained if is_seeking
+
+		// the windows are consecutive unless seeking, thus loaded by one asynchronous stream over T if required
+		utility::async_stream_reader<alphabet_type>* t_async_reader = (is_seeking || m_async_fn.empty() || m_window_buf == nullptr) ? nullptr :
+			new utility::async_stream_reader<alphabet_type>(m_async_fn, 0, m_len, false, m_async_buf_size * m_async_buf_num, m_async_buf_num, m_use_uring);
+
+		for (m_window_beg = 0; !_requests.empty() || is_recording; m_window_beg = m_window_end) {
+
+			if (is_seeking) { // skip the windows without requests
+
+				const uint64 pos = std::min(static_cast<uint64>((*_requests).first), m_len);
+
+				m_window_beg = std::max(m_window_beg, pos / m_step * m_step);
+			}
+
+			m_window_end = std::min(m_window_beg + m_window_size, m_len);
+
+			if (m_window_buf == nullptr) { // mapped
+
+				m_window = m_mapped_t.data() + m_window_beg;
+			}
+			else if (t_async_reader != nullptr) {
+
+				t_async_reader->read(m_window_buf, m_window_end - m_window_beg);
+			}
+			else {
+
+				typename alphabet_vector_type::bufreader_type t_reader(m_t.begin() + m_window_beg, m_t.begin() + m_window_end);
+
+				for (uint64 i = 0; i < m_window_end - m_window_beg; ++i, ++t_reader) {
+
+					m_window_buf[i] = *t_reader;
+				}
+			}
+
+			split_window();
+
+			if (is_seeking) {
+
+				lookup_chunk_fp();
+			}
+			else {
+
+				fp = compute_chunk_fp(fp, is_recording || is_verifying);
+
+				if (is_verifying && !m_checkpoint->is_ready()) is_recording = true;
+
+				if (m_extra_num != 0) compute_chunk_extra(extra);
+			}
+
+			const bool is_last = (m_window_end == m_len);
+
+			for (uint64 k = 0; k < m_thread_num; ++k) {
+
+				m_cur_pos[k] = m_chunk_beg[k];
+
+				m_cur_fp[k] = m_chunk_fp[k];
+			}
+
+			std::copy(m_chunk_extra.begin(), m_chunk_extra.begin() + m_thread_num * m_extra_num, m_cur_extra.begin());
+
+			// answer requests in current window batch by batch
+			while (!_requests.empty() && (is_last || static_cast<uint64>((*_requests).first) < m_window_end)) {
+
+				batch.clear();
+
+				while (batch.size() < m_batch_size && !_requests.empty() && (is_last || static_cast<uint64>((*_requests).first) < m_window_end)) {
+
+					batch.push_back(*_requests);
+
+					++_requests;
+				}
+
+				// requests in [batch_beg[k], batch_beg[k + 1]) fall in the k-th chunk
+				for (uint64 k = 1; k < m_thread_num; ++k) {
+
+					batch_beg[k] = std::lower_bound(batch.begin() + batch_beg[k - 1], batch.end(), m_chunk_beg[k], RequestLess<request_type>()) - batch.begin();
+				}
+
+				batch_beg[0] = 0, batch_beg[m_thread_num] = batch.size();
+
+				::run_parallel(m_thread_num, [&](const uint64 _k) {
+
+					uint64 pos = m_cur_pos[_k];
+
+					fp_value_type cur_fp = m_cur_fp[_k];
+
+					uint64* cur_extra = m_cur_extra.data() + _k * m_extra_num;
+
+					for (uint64 i = batch_beg[_k]; i < batch_beg[_k + 1]; ++i) {
+
+						const uint64 target = std::min(static_cast<uint64>(batch[i].first), m_window_end);
+
+						if (pos < target) {
+
+							cur_fp = kernel_type::advance(cur_fp, m_window + (pos - m_window_beg), target - pos);
+
+							if (m_extra_num != 0) m_extra->advance(cur_extra, m_window + (pos - m_window_beg), target - pos);
+
+							pos = target;
+						}
+
+						batch_fp[i] = cur_fp;
+
+						std::copy(cur_extra, cur_extra + m_extra_num, batch_extra.begin() + i * m_extra_num);
+
+						batch_ch[i] = (target < m_window_end) ? m_window[target - m_window_beg] : 0;
+					}
+
+					m_cur_pos[_k] = pos, m_cur_fp[_k] = cur_fp;
+				});
+
+				for (uint64 i = 0; i < batch.size(); ++i) {
+
+					m_emit_extra = batch_extra.data() + i * m_extra_num;
+
+					_callback(batch[i], batch_fp[i], batch_ch[i]);
+				}
+			}
+
+			if (is_last) {
+
+				is_scanned = true;
+
+				break;
+			}
+		}
+
+		delete t_async_reader; t_async_reader = nullptr;
+
+		if (is_scanned && (is_recording || is_verifying)) {
+
+			if (m_len % m_step == 0) m_checkpoint->record(m_len / m_step, fp);
+
+			m_checkpoint->verify(fp);
+
+			if (!m_checkpoint->is_ready()) m_checkpoint->finish(fp);
+		}
+
+		m_emit_extra = nullptr;
+
+		return;
+	}
+
+	/// \brief extra fingerprints of the request being reported, only valid within the callback of answer()
+	const uint64* extra_fp() const {
+
+		return m_emit_extra;
+	}
+
+private:
+
+	/// \brief compare a request with a position
+	template<typename request_type>
+	struct RequestLess {
+
+		bool operator()(const request_type& _a, const uint64 _pos) const {
+
+			return static_cast<uint64>(_a.first) < _pos;
+		}
+	};
+
+	/// \brief split current window into chunks, each of which starts at a multiple of m_step unless it is empty
+	void split_window() {
+
+		uint64 chunk_size = (m_window_end - m_window_beg + m_thread_num - 1) / m_thread_num;
+
+		chunk_size = (chunk_size + m_step - 1) / m_step * m_step;
+
+		for (uint64 k = 0; k <= m_thread_num; ++k) {
+
+			m_chunk_beg[k] = std::min(m_window_beg + k * chunk_size, m_window_end);
+		}
+	}
+
+	/// \brief compute fp[0, chunk_beg - 1] for each chunk (steps 1 and 2)
+	///
+	/// \param _fp fp[0, m_window_beg - 1]
+	/// \param _is_recording whether to record the samples in m_checkpoint
+	/// \return fp[0, m_window_end - 1]
+	fp_value_type compute_chunk_fp(const fp_value_type _fp, const bool _is_recording) {
+
+		// step 1: local fingerprints, stored in m_chunk_fp[k + 1] temporarily
+		::run_parallel(m_thread_num, [&](const uint64 _k) {
+
+			fp_value_type local_fp = 0;
+
+			if (_is_recording) { // local fingerprints at the sampled positions
+
+				for (uint64 pos = m_chunk_beg[_k]; pos < m_chunk_beg[_k + 1]; pos += m_step) {
+
+					m_local_samples[(pos - m_window_beg) / m_step] = local_fp;
+
+					const uint64 num = std::min(m_step, m_chunk_beg[_k + 1] - pos);
+
+					local_fp = kernel_type::advance(local_fp, m_window + (pos - m_window_beg), num);
+				}
+			}
+			else {
+
+				local_fp = kernel_type::advance(0, m_window + (m_chunk_beg[_k] - m_window_beg), m_chunk_beg[_k + 1] - m_chunk_beg[_k]);
+			}
+
+			m_chunk_fp[_k + 1] = local_fp;
+		});
+
+		// step 2: concatenate local fingerprints from left to right
+		m_chunk_fp[0] = _fp;
+
+		for (uint64 k = 0; k < m_thread_num; ++k) {
+
+			if (_is_recording) { // fp[0, pos - 1] = fp[0, chunk_beg - 1] * R^(pos - chunk_beg) + fp[chunk_beg, pos - 1]
+
+				for (uint64 pos = m_chunk_beg[k]; pos < m_chunk_beg[k + 1]; pos += m_step) {
+
+					const fp_value_type local_fp = m_local_samples[(pos - m_window_beg) / m_step];
+
+					m_checkpoint->record(pos / m_step, fingerprint_type::concat(m_chunk_fp[k], local_fp, m_rinterval->compute(pos - m_chunk_beg[k])));
+				}
+			}
+
+			m_chunk_fp[k + 1] = fingerprint_type::concat(m_chunk_fp[k], m_chunk_fp[k + 1], m_rinterval->compute(m_chunk_beg[k + 1] - m_chunk_beg[k]));
+		}
+
+		return m_chunk_fp[m_thread_num];
+	}
+
+	/// \brief compute the extra fingerprints of fp[0, chunk_beg - 1] for each chunk (steps 1 and 2)
+	///
+	/// \param _extra extra fingerprints of fp[0, m_window_beg - 1], updated to those of fp[0, m_window_end - 1]
+	void compute_chunk_extra(std::vector<uint64>& _extra) {
+
+		// step 1: local fingerprints, stored in the (k + 1)-th slot temporarily
+		::run_parallel(m_thread_num, [&](const uint64 _k) {
+
+			uint64* local_extra = m_chunk_extra.data() + (_k + 1) * m_extra_num;
+
+			std::fill(local_extra, local_extra + m_extra_num, 0);
+
+			m_extra->advance(local_extra, m_window + (m_chunk_beg[_k] - m_window_beg), m_chunk_beg[_k + 1] - m_chunk_beg[_k]);
+		});
+
+		// step 2: concatenate local fingerprints from left to right
+		std::copy(_extra.begin(), _extra.end(), m_chunk_extra.begin());
+
+		for (uint64 k = 0; k < m_thread_num; ++k) {
+
+			uint64* left = m_chunk_extra.data() + k * m_extra_num, *right = left + m_extra_num;
+
+			const std::vector<uint64> local_extra(right, right + m_extra_num);
+
+			std::copy(left, left + m_extra_num, right);
+
+			m_extra->concat(right, local_extra.data(), m_chunk_beg[k + 1] - m_chunk_beg[k]);
+		}
+
+		std::copy(m_chunk_extra.begin() + m_thread_num * m_extra_num, m_chunk_extra.end(), _extra.begin());
+	}
+
+	/// \brief get fp[0, chunk_beg - 1] for each chunk from m_checkpoint (replace steps 1 and 2)
+	void lookup_chunk_fp() {
+
+		for (uint64 k = 0; k < m_thread_num; ++k) {
+
+			if (m_chunk_beg[k] % m_step == 0) {
+
+				m_chunk_fp[k] = m_checkpoint->sample(m_chunk_beg[k] / m_step);
+			}
+			else { // empty chunk at the end of T
+
+				m_chunk_fp[k] = m_checkpoint->prefix(m_t, m_chunk_beg[k]);
+			}
+		}
+	}
+};
+
+#endif // __PREFIX_FP_H
@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file radix_sort.h
+/// \brief multi-threaded LSD radix sort for in-RAM arrays with integer keys
+///
+/// Keys are consumed 8 bits per pass, from the least significant byte up to the most significant non-zero byte of the maximum key.
+/// In each pass, the array is split into one chunk per thread.
+/// Each thread counts the digits in its chunk, the counts are turned into per-thread output offsets by a prefix sum,
+/// and then each thread scatters its chunk into the buffer. The sort is stable.
+/// A pass is skipped if all the keys share the same digit.
+///
+/// \author Yi Wu
+/// \date 2016.12
+///////////////////////////////////////////////////////////
+
+#ifndef __RADIX_SORT_H
+#define __RADIX_SORT_H
+
+#include "common.h"
+
+#include "parallel.h"
+
+#include <algorithm>
+
+#include <vector>
+
+/// \brief parallel LSD radix sort
+///
+/// \param value_type type of elements
+template<typename value_type>
+struct ParallelRadixSort {
+
+	static const uint64 DIGIT_BITS = 8; ///< bits per pass
+
+	static const uint64 DIGIT_NUM = 1ull << DIGIT_BITS; ///< number of buckets per pass
+
+	/// \brief sort _data[0, _num) by _key in ascending order
+	///
+	/// \param _data elements to be sorted
+	/// \param _buffer scratch space for at least _num elements
+	/// \param _num number of elements
+	/// \param _thread_num number of worker threads
+	/// \param _key callable object, _key(e) returns the uint64 key of element e
+	template<typename key_func_type>
+	static void sort(value_type* _data, value_type* _buffer, const uint64 _num, const uint64 _thread_num, key_func_type _key) {
+
+		if (_num <= 1) return;
+
+		const uint64 thread_num = std::max<uint64>(1, std::min(_thread_num, _num));
+
+		std::vector<uint64> chunk_beg;
+
+		split_range(_num, thread_num, chunk_beg);
+
+		// maximum key determines the number of passes
+		std::vector<uint64> chunk_max(thread_num, 0);
+
+		run_parallel(thread_num, [&](const uint64 _k) {
+
+			uint64 max_key = 0;
+
+			for (uint64 i = chunk_beg[_k]; i < chunk_beg[_k + 1]; ++i) {
+
+				max_key = std::max(max_key, static_cast<uint64>(_key(_data[i])));
+			}
+
+			chunk_max[_k] = max_key;
+		});
+
+		const uint64 max_key = *std::max_element(chunk_max.begin(), chunk_max.end());
+
+		std::vector<uint64> count(thread_num * DIGIT_NUM); // count[k * DIGIT_NUM + d]: number of digit d in the k-th chunk, then its output offset
+
+		value_type* src = _data, *dst = _buffer;
+
+		for (uint64 shift = 0; shift < 64 && (max_key >> shift) != 0; shift += DIGIT_BITS) {
+
+			// count digits
+			run_parallel(thread_num, [&](const uint64 _k) {
+
+				uint64* cnt = &count[_k * DIGIT_NUM];
+
+				std::fill(cnt, cnt + DIGIT_NUM, 0);
+
+				for (uint64 i = chunk_beg[_k]; i < chunk_beg[_k + 1]; ++i) {
+
+					++cnt[(static_cast<uint64>(_key(src[i])) >> shift) & (DIGIT_NUM - 1)];
+				}
+			});
+
+			// prefix sum over (digit, thread) in this order
+			uint64 offset = 0, bucket_num = 0;
+
+			for (uint64 d = 0; d < DIGIT_NUM; ++d) {
+
+				const uint64 offset_beg = offset;
+
+				for (uint64 k = 0; k < thread_num; ++k) {
+
+					const uint64 cnt = count[k * DIGIT_NUM + d];
+
+					count[k * DIGIT_NUM + d] = offset;
+
+					offset += cnt;
+				}
+
+				if (offset != offset_beg) ++bucket_num;
+			}
+
+			if (bucket_num == 1) continue; // all keys share the same digit
+
+			// scatter
+			run_parallel(thread_num, [&](const uint64 _k) {
+
+				uint64* pos = &count[_k * DIGIT_NUM];
+
+				for (uint64 i = chunk_beg[_k]; i < chunk_beg[_k + 1]; ++i) {
+
+					dst[pos[(static_cast<uint64>(_key(src[i])) >> shift) & (DIGIT_NUM - 1)]++] = src[i];
+				}
+			});
+
+			std::swap(src, dst);
+		}
+
+		// copy back if the result is in the buffer
+		if (src != _data) {
+
+			run_parallel(thread_num, [&](const uint64 _k) {
+
+				std::copy(src + chunk_beg[_k], src + chunk_beg[_k + 1], _data + chunk_beg[_k]);
+			});
+		}
+	}
+};
+
+#endif // __RADIX_SORT_H
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file sa_width.h
+/// \brief width of the elements in the SA and LCP files, given by --width or inferred from the file sizes
+///
+/// The drivers instantiate the validators for 32-, 40-, 48- and 64-bit elements (uint32, uint40, uint48 and uint64)
+/// and dispatch on the width at run time. Independent of the file elements, the positions carried by the sorter tuples
+/// are 32-bit values for a text under 4G characters, thus 40-bit files of such a text are validated with tuples one byte narrower per value.
+///
+/// \author Yi Wu
+/// \date 2017.1
+///////////////////////////////////////////////////////////
+
+#ifndef __SA_WIDTH_H
+#define __SA_WIDTH_H
+
+#include "common.h"
+
+#include "basicio.h"
+
+#include <algorithm>
+
+#include <cstdlib>
+
+#include <iostream>
+
+#include <limits>
+
+#include <string>
+
+/// \brief return the width in bits of the elements in the SA (and LCP) files, exit if unknown or not matching the file sizes
+///
+/// \param _width "32", "40", "48", "64", or "auto" to infer the width from the size of the SA file versus the text length
+/// \param _sa_fn SA file
+/// \param _lcp_fn LCP file, checked to have the same size as the SA file, empty if not given
+/// \param _len text length
+inline uint64 sa_width(const std::string& _width, const std::string& _sa_fn, const std::string& _lcp_fn, const uint64 _len) {
+
+	const uint64 sa_bytes = BasicIO::file_size(_sa_fn);
+
+	uint64 width = 0;
+
+	if (_width == "auto") {
+
+		if (_len == 0) {
+
+			width = 40; // nothing to infer from, the default format
+		}
+		else if (sa_bytes % _len == 0) {
+
+			width = sa_bytes / _len * 8;
+		}
+	}
+	else {
+
+		width = std::strtoull(_width.c_str(), nullptr, 10);
+	}
+
+	if (width != 32 && width != 40 && width != 48 && width != 64) {
+
+		std::cerr << "Unknown SA/LCP width: " << ((_width == "auto") ? "cannot infer from " + _sa_fn : _width) << ", use --width=32|40|48|64\n";
+
+		std::exit(EXIT_FAILURE);
+	}
+
+	if (sa_bytes != _len * (width / 8)) {
+
+		std::cerr << _sa_fn << ": " << sa_bytes << " bytes, expect " << _len * (width / 8) << " for " << width << "-bit elements\n";
+
+		std::exit(EXIT_FAILURE);
+	}
+
+	if (!_lcp_fn.empty() && BasicIO::file_size(_lcp_fn) != sa_bytes) {
+
+		std::cerr << _lcp_fn << ": " << BasicIO::file_size(_lcp_fn) << " bytes, expect " << sa_bytes << " as " << _sa_fn << std::endl;
+
+		std::exit(EXIT_FAILURE);
+	}
+
+	// the maximum value of the width is reserved as a sentinel
+	if (width < 64 && _len >= (1ull << width) - 1) {
+
+		std::cerr << width << "-bit elements cannot index " << _len << " characters\n";
+
+		std::exit(EXIT_FAILURE);
+	}
+
+	return width;
+}
+
+/// \brief return the width in bits of the positions carried by the sorter tuples, 32 if T is short enough, otherwise the width of the file elements
+///
+/// As for the file elements, the maximum value of uint32 is reserved as a sentinel.
+///
+/// \param _width width of the file elements, see sa_width()
+/// \param _len text length
+inline uint64 sa_index_width(const uint64 _width, const uint64 _len) {
+
+	return (_len < std::numeric_limits<uint32>::max()) ? 32 : _width;
+}
+
+/// \brief narrow a position or an SA/LCP-value read from the files to the index type of the sorter tuples
+///
+/// A value beyond _len is clamped to _len, which is neither a valid SA-value nor a valid LCP-value
+/// and is taken as the end of T when fetching fingerprints, such that a wrong value never wraps around to a valid one.
+template<typename index_type>
+inline index_type to_index(const uint64 _val, const uint64 _len) {
+
+	return index_type(std::min(_val, _len));
+}
+
+#endif // __SA_WIDTH_H
@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file scan_reader.h
+/// \brief sequential reader of a file-mapped vector, either an stxxl bufreader, an async_stream_reader or a span_reader
+///
+/// If the file is memory mapped (see mmap_io.h), the scan reads the mapping in place.
+/// Otherwise, with --async-io, the scans over T, SA and LCP read their files by async_stream_reader,
+/// which overlaps the I/O with the computation and bypasses the page cache.
+/// Otherwise, they read the vectors by the stxxl bufreaders as before.
+///
+/// \author Yi Wu
+/// \date 2017.1
+///////////////////////////////////////////////////////////
+
+#ifndef __SCAN_READER_H
+#define __SCAN_READER_H
+
+#include "common.h"
+
+#include "config.h"
+
+#include "async_stream_reader.h"
+
+#include "mmap_io.h"
+
+#include <string>
+
+#include <type_traits>
+
+/// \brief scan a range of a vector mapped to a file
+///
+/// \param vector_type stxxl vector
+/// \param reverse scan from right to left
+template<typename vector_type, bool reverse = false>
+class ScanReader {
+
+private:
+
+	typedef typename vector_type::value_type value_type;
+
+	typedef typename std::conditional<reverse, typename vector_type::bufreader_reverse_type, typename vector_type::bufreader_type>::type bufreader_type;
+
+	bufreader_type* m_bufreader; ///< stxxl reader, nullptr if reading asynchronously
+
+	utility::async_stream_reader<value_type>* m_async_reader; ///< asynchronous reader, nullptr if not used
+
+	utility::span_reader<value_type>* m_span_reader; ///< reader of the mapped file, nullptr if not mapped
+
+	/// \brief create the reader for [_beg, _end)
+	void init(const vector_type& _vec, const std::string& _fn, const uint64 _beg, const uint64 _end, const Config& _config) {
+
+		m_bufreader = nullptr, m_async_reader = nullptr, m_span_reader = nullptr;
+
+		utility::span<value_type> mapped;
+
+		if (utility::find_mapped(_fn, mapped)) {
+
+			m_span_reader = new utility::span_reader<value_type>(mapped.subspan(_beg, _end), reverse);
+		}
+		else if (_config.async_io && !_fn.empty()) {
+
+			m_async_reader = new utility::async_stream_reader<value_type>(_fn, _beg, _end, reverse, _config.async_buf_size * _config.async_buf_num, _config.async_buf_num, _config.io_uring);
+		}
+		else {
+
+			m_bufreader = new bufreader_type(_vec.begin() + _beg, _vec.begin() + _end);
+		}
+	}
+
+public:
+
+	/// \brief ctor, scan the whole vector
+	///
+	/// \param _fn file mapped by _vec, empty if the vector is not backed by a file of its own
+	ScanReader(const vector_type& _vec, const std::string& _fn, const Config& _config) {
+
+		init(_vec, _fn, 0, _vec.size(), _config);
+	}
+
+	/// \brief ctor, scan the elements [_beg, _end)
+	ScanReader(const vector_type& _vec, const std::string& _fn, const uint64 _beg, const uint64 _end, const Config& _config) {
+
+		init(_vec, _fn, _beg, _end, _config);
+	}
+
+	/// \brief dtor
+	~ScanReader() {
+
+		delete m_bufreader; m_bufreader = nullptr;
+
+		delete m_async_reader; m_async_reader = nullptr;
+
+		delete m_span_reader; m_span_reader = nullptr;
+	}
+
+	/// \brief check if empty
+	bool empty() const {
+
+		if (m_span_reader != nullptr) return m_span_reader->empty();
+
+		return (m_async_reader != nullptr) ? m_async_reader->empty() : m_bufreader->empty();
+	}
+
+	/// \brief current element
+	const value_type& operator*() const {
+
+		if (m_span_reader != nullptr) return *(*m_span_reader);
+
+		return (m_async_reader != nullptr) ? *(*m_async_reader) : *(*m_bufreader);
+	}
+
+	/// \brief current element
+	const value_type* operator->() const {
+
+		return &(*(*this));
+	}
+
+	/// \brief move to the next element
+	ScanReader& operator++() {
+
+		if (m_span_reader != nullptr) ++(*m_span_reader); else if (m_async_reader != nullptr) ++(*m_async_reader); else ++(*m_bufreader);
+
+		return *this;
+	}
+};
+
+#endif // __SCAN_READER_H
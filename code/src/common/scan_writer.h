@@ -0,0 +1,180 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file scan_writer.h
+/// \brief sequential writer materializing an intermediate vector, either by an stxxl bufwriter or by an async_stream_writer
+///
+/// With --async-io, the vector is written to a temporary file by async_stream_writer, such that the writes overlap
+/// the merge of the sorter feeding the writer. The file is then mapped by an stxxl vector, which is read as before.
+/// Otherwise, the vector is allocated by stxxl and written by its bufwriter.
+///
+/// \author Yi Wu
+/// \date 2017.1
+///////////////////////////////////////////////////////////
+
+#ifndef __SCAN_WRITER_H
+#define __SCAN_WRITER_H
+
+#include "common.h"
+
+#include "config.h"
+
+#include "async_stream_writer.h"
+
+#include <cstdio>
+
+#include <cstring>
+
+#include <string>
+
+#include <vector>
+
+#include <unistd.h>
+
+/// \brief temporary files of the vectors written by ScanWriter
+///
+/// A file is unlinked as soon as it is mapped, thus the disk space is reclaimed once the file is closed, even if the process exits early.
+class TmpFilePool {
+
+private:
+
+	std::string m_prefix; ///< prefix of the file names
+
+	uint64 m_created; ///< number of files created so far
+
+	std::vector<stxxl::syscall_file*> m_files; ///< mapped files, closed when the pool is destroyed
+
+public:
+
+	/// \brief ctor
+	///
+	/// \param _prefix the files are named _prefix.pid.k
+	TmpFilePool(const std::string& _prefix) : m_prefix(_prefix + "." + std::to_string(getpid())), m_created(0) {}
+
+	/// \brief dtor
+	///
+	/// \note the vectors mapped to the files must be deleted before
+	~TmpFilePool() {
+
+		for (uint64 i = 0; i < m_files.size(); ++i) {
+
+			delete m_files[i]; m_files[i] = nullptr;
+		}
+	}
+
+	/// \brief name of a new file
+	std::string create() {
+
+		return m_prefix + "." + std::to_string(m_created++);
+	}
+
+	/// \brief map a vector to the file and unlink the file
+	///
+	/// \note the caller owns the vector
+	template<typename vector_type>
+	vector_type* map(const std::string& _fn) {
+
+		stxxl::syscall_file* file = new stxxl::syscall_file(_fn, stxxl::syscall_file::RDWR | stxxl::syscall_file::DIRECT);
+
+		m_files.push_back(file);
+
+		vector_type* vec = new vector_type(file);
+
+		std::remove(_fn.c_str());
+
+		return vec;
+	}
+};
+
+/// \brief write a vector from left to right
+///
+/// \param vector_type stxxl vector
+template<typename vector_type>
+class ScanWriter {
+
+private:
+
+	typedef typename vector_type::value_type value_type;
+
+	vector_type* m_vec; ///< vector written by the stxxl writer, nullptr if writing asynchronously
+
+	typename vector_type::bufwriter_type* m_bufwriter; ///< stxxl writer, nullptr if writing asynchronously
+
+	utility::async_stream_writer<value_type>* m_async_writer; ///< asynchronous writer, nullptr if not used
+
+	TmpFilePool* m_pool; ///< pool of the temporary files
+
+public:
+
+	/// \brief ctor
+	///
+	/// \param _num number of elements to be written
+	/// \param _pool temporary files if writing asynchronously, nullptr to write by the stxxl writer
+	ScanWriter(const uint64 _num, TmpFilePool* _pool, const Config& _config) : m_vec(nullptr), m_bufwriter(nullptr), m_async_writer(nullptr), m_pool(_pool) {
+
+		if (m_pool != nullptr) {
+
+			m_async_writer = new utility::async_stream_writer<value_type>(m_pool->create(), _config.async_buf_size * _config.async_buf_num, _config.async_buf_num);
+		}
+		else {
+
+			m_vec = new vector_type(); m_vec->resize(_num);
+
+			m_bufwriter = new typename vector_type::bufwriter_type(*m_vec);
+		}
+	}
+
+	/// \brief dtor
+	~ScanWriter() {
+
+		delete m_bufwriter; m_bufwriter = nullptr;
+
+		delete m_async_writer; m_async_writer = nullptr;
+
+		delete m_vec; m_vec = nullptr;
+	}
+
+	/// \brief append an element
+	ScanWriter& operator<<(const value_type& _val) {
+
+		if (m_async_writer != nullptr) m_async_writer->write(_val); else (*m_bufwriter) << _val;
+
+		return *this;
+	}
+
+	/// \brief complete the writes and return the vector, exit if a write failed
+	///
+	/// \note the caller owns the vector
+	vector_type* finish() {
+
+		vector_type* vec = nullptr;
+
+		if (m_async_writer != nullptr) {
+
+			if (false == m_async_writer->finish()) {
+
+				std::cerr << m_async_writer->file_name() << ": " << std::strerror(m_async_writer->error()) << std::endl;
+
+				exit(EXIT_FAILURE);
+			}
+
+			const std::string fn = m_async_writer->file_name();
+
+			delete m_async_writer; m_async_writer = nullptr;
+
+			vec = m_pool->map<vector_type>(fn);
+		}
+		else {
+
+			m_bufwriter->finish();
+
+			delete m_bufwriter; m_bufwriter = nullptr;
+
+			vec = m_vec, m_vec = nullptr;
+		}
+
+		return vec;
+	}
+};
+
+#endif // __SCAN_WRITER_H
@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file simd_min.h
+/// \brief a[i] = min(a[i], v) over a dense array of 64-bit integers, vectorized and dispatched at run time
+///
+/// The AVX2 and AVX-512 kernels are compiled with function-level target attributes, thus no global -m flag is required.
+/// The kernel is chosen by CPUID on the first call of MinBroadcast::get().
+///
+/// \note The array must be 64-byte aligned and its length a multiple of 8. The values must be below 2^63 for the AVX2 kernel.
+///
+/// \author Yi Wu
+/// \date 2017.1
+///////////////////////////////////////////////////////////
+
+#ifndef __SIMD_MIN_H
+#define __SIMD_MIN_H
+
+#include "common.h"
+
+#include <algorithm>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SIMD_MIN_X86
+#include <immintrin.h>
+#endif
+
+/// \brief vectorized min-broadcast
+struct MinBroadcast {
+
+	typedef void (*kernel_type)(uint64*, const uint64, const uint64);
+
+	kernel_type m_kernel; ///< selected kernel
+
+	const char* m_name; ///< name of the selected kernel
+
+	/// \brief ctor, pick the widest kernel supported by the CPU
+	MinBroadcast() {
+
+		m_kernel = scalar, m_name = "scalar";
+
+#ifdef SIMD_MIN_X86
+		__builtin_cpu_init();
+
+		if (__builtin_cpu_supports("avx512f")) {
+
+			m_kernel = avx512, m_name = "avx512";
+		}
+		else if (__builtin_cpu_supports("avx2")) {
+
+			m_kernel = avx2, m_name = "avx2";
+		}
+#endif
+	}
+
+	/// \brief get the dispatcher, constructed on the first call
+	static const MinBroadcast& get() {
+
+		static const MinBroadcast dispatcher;
+
+		return dispatcher;
+	}
+
+	/// \brief _a[i] = min(_a[i], _val) for 0 <= i < _num
+	void operator()(uint64* _a, const uint64 _num, const uint64 _val) const {
+
+		m_kernel(_a, _num, _val);
+	}
+
+	/// \brief portable kernel
+	static void scalar(uint64* _a, const uint64 _num, const uint64 _val) {
+
+		for (uint64 i = 0; i < _num; ++i) {
+
+			_a[i] = std::min(_a[i], _val);
+		}
+	}
+
+#ifdef SIMD_MIN_X86
+	/// \brief 4 lanes per step, AVX2 lacks an unsigned 64-bit min, thus a signed compare and a blend are used
+	__attribute__((target("avx2")))
+	static void avx2(uint64* _a, const uint64 _num, const uint64 _val) {
+
+		const __m256i val = _mm256_set1_epi64x(static_cast<long long>(_val));
+
+		for (uint64 i = 0; i < _num; i += 4) {
+
+			const __m256i cur = _mm256_load_si256(reinterpret_cast<const __m256i*>(_a + i));
+
+			_mm256_store_si256(reinterpret_cast<__m256i*>(_a + i), _mm256_blendv_epi8(cur, val, _mm256_cmpgt_epi64(cur, val)));
+		}
+	}
+
+	/// \brief 8 lanes per step
+	///
+	/// The zero-masking form is used since _mm512_min_epu64 passes an undefined source that GCC reports as uninitialized.
+	__attribute__((target("avx512f")))
+	static void avx512(uint64* _a, const uint64 _num, const uint64 _val) {
+
+		const __m512i val = _mm512_set1_epi64(static_cast<long long>(_val));
+
+		for (uint64 i = 0; i < _num; i += 8) {
+
+			const __m512i cur = _mm512_load_si512(reinterpret_cast<const void*>(_a + i));
+
+			_mm512_store_si512(reinterpret_cast<void*>(_a + i), _mm512_maskz_min_epu64(static_cast<__mmask8>(0xff), cur, val));
+		}
+	}
+#endif
+};
+
+#endif // __SIMD_MIN_H
@@ -15,6 +15,9 @@ struct pair{
 	/// \brief constructor, copy
 	pair(const pair& _item) : first(_item.first), second(_item.second) {}
 
+	/// \brief assignment, copy
+	pair& operator = (const pair& _item) = default;
+
 	/// \brief constructor, component
 	pair(const T1& _first, const T2& _second) : first(_first), second(_second) {}
 
@@ -58,6 +61,9 @@ struct triple{
 	/// \brief constructor, copy
 	triple(const triple& _item) : first(_item.first), second(_item.second), third(_item.third) {}
 
+	/// \brief assignment, copy
+	triple& operator = (const triple& _item) = default;
+
 	/// \brief constructor, component
 	triple(const T1& _first, const T2& _second, const T3& _third) : first(_first), second(_second), third(_third) {}
 
@@ -104,6 +110,9 @@ struct quadruple{
 	/// \brief constructor, copy
 	quadruple(const quadruple& _item) : first(_item.first), second(_item.second), third(_item.third), forth(_item.forth) {}
 
+	/// \brief assignment, copy
+	quadruple& operator = (const quadruple& _item) = default;
+
 	/// \brief constructor, component
 	quadruple(const T1& _first, const T2& _second, const T3& _third, const T4& _forth) : first(_first), second(_second), third(_third), forth(_forth) {}
 
@@ -94,6 +94,7 @@ private:
     uint40() {}
     uint40(std::uint32_t l, std::uint8_t h) : low(l), high(h) {}
     uint40(const uint40& a) : low(a.low), high(a.high) {}
+    uint40& operator = (const uint40& a) = default;
     uint40(const std::int32_t& a) : low(a), high(0) {}
     uint40(const std::uint32_t& a) : low(a), high(0) {}
     uint40(const std::uint64_t& a) : low(a & 0xFFFFFFFF), high((a >> 32) & 0xFF) {}
@@ -136,6 +137,128 @@ private:
     inline bool operator != (const uint40& b) const { return (low != b.low) || (high != b.high); }
 } __attribute__((packed));
 
+//
+class uint48 {
+
+public:
+
+	typedef uint32 low_type;
+
+	typedef uint16 high_type;
+
+private:
+	low_type low;
+
+	high_type high;
+
+public:
+	uint48() {}
+	uint48(std::uint32_t l, std::uint16_t h) : low(l), high(h) {}
+	uint48(const uint48& a) : low(a.low), high(a.high) {}
+	uint48(const std::int32_t& a) : low(a), high(0) {}
+	uint48(const std::uint32_t& a) : low(a), high(0) {}
+	uint48(const std::uint64_t& a) : low(a & 0xFFFFFFFF), high((a >> 32) & 0xFFFF) {}
+	uint48(const std::int64_t& a) : low(a & 0xFFFFFFFFL), high((a >> 32) & 0xFFFF) {}
+
+	// set high part
+	void set_high(const uint16& _high) {
+
+		high = _high;
+	}
+
+	// set low part
+	void set_low(const uint32& _low) {
+
+		low = _low;
+	}
+
+	//
+	void set(const uint32& _low, const uint16 _high) {
+
+		low = _low;
+
+		high = _high;
+	}
+
+	//
+	uint32 get_low() {
+
+		return low;
+	}
+
+	//
+	uint16 get_high() {
+
+		return high;
+	}
+
+	uint48& operator = (const uint48& b) { low = b.low; high = b.high; return *this; }
+	inline operator uint64_t() const { return (((std::uint64_t)high) << 32) | (std::uint64_t)low; }
+	inline bool operator == (const uint48& b) const { return (low == b.low) && (high == b.high); }
+	inline bool operator != (const uint48& b) const { return (low != b.low) || (high != b.high); }
+} __attribute__((packed));
+
+//
+class uint72 {
+
+public:
+
+	typedef uint64 low_type;
+
+	typedef uint8 high_type;
+
+private:
+	low_type low;
+
+	high_type high;
+
+public:
+	uint72() {}
+	uint72(std::uint64_t l, std::uint8_t h) : low(l), high(h) {}
+	uint72(const uint72& a) : low(a.low), high(a.high) {}
+	uint72(const std::int32_t& a) : low(a), high(0) {}
+	uint72(const std::uint32_t& a) : low(a), high(0) {}
+	uint72(const std::uint64_t& a) : low(a), high(0) {}
+	uint72(const std::int64_t& a) : low(a), high(0) {}
+
+	// set high part
+	void set_high(const uint8& _high) {
+
+		high = _high;
+	}
+
+	// set low part
+	void set_low(const uint64& _low) {
+
+		low = _low;
+	}
+
+	//
+	void set(const uint64& _low, const uint8 _high) {
+
+		low = _low;
+
+		high = _high;
+	}
+
+	//
+	uint64 get_low() {
+
+		return low;
+	}
+
+	//
+	uint8 get_high() {
+
+		return high;
+	}
+
+	uint72& operator = (const uint72& b) { low = b.low; high = b.high; return *this; }
+	inline operator uint64_t() const { return low; } // only valid if high part is zero
+	inline bool operator < (const uint72& b) const { return (high < b.high) || (high == b.high && low < b.low); }
+	inline bool operator == (const uint72& b) const { return (low == b.low) && (high == b.high); }
+	inline bool operator != (const uint72& b) const { return (low != b.low) || (high != b.high); }
+} __attribute__((packed));
 
 
 
@@ -283,6 +406,20 @@ class numeric_limits<uint40> {
     }
 };
 
+template<>
+class numeric_limits<uint48> {
+  public:
+    static uint48 min() {
+      return uint48(std::numeric_limits<std::uint32_t>::min(),
+          std::numeric_limits<std::uint16_t>::min());
+    }
+
+    static uint48 max() {
+      return uint48(std::numeric_limits<std::uint32_t>::max(),
+          std::numeric_limits<std::uint16_t>::max());
+    }
+};
+
 template<>
 class numeric_limits<uint128>{
 
@@ -0,0 +1,360 @@
+////////////////////////////////////////////////////////////
+/// Copyright (c) 2016, Sun Yat-sen University,
+/// All rights reserved
+/// \file uring_io.h
+/// \brief minimal io_uring submission/completion ring for positioned reads
+///
+/// A blocking pread keeps one request in flight per thread. Instead, an io_ring queues many reads,
+/// submits them by one system call and reaps the completions in any order, thus the device sees a deep queue.
+/// The ring is driven by the raw system calls, no library is required.
+/// If the headers or the kernel lack io_uring (or it is forbidden), is_ready() returns false and the callers fall back to pread.
+/// The bytes of the reaped reads are added to io_read_volume(), as pread_full() does for the blocking reads.
+///
+/// \note an io_ring is used by one thread only
+///
+/// \author Yi Wu
+/// \date 2017.1
+///////////////////////////////////////////////////////////
+
+#ifndef __URING_IO_H
+#define __URING_IO_H
+
+#include "common.h"
+
+#include "async_io.h"
+
+#include <algorithm>
+
+#include <cerrno>
+
+#include <cstring>
+
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HAS_IO_URING
+#endif
+#endif
+
+#ifdef HAS_IO_URING
+#include <linux/io_uring.h>
+
+#include <sys/mman.h>
+
+#include <sys/syscall.h>
+
+#include <sys/uio.h>
+
+#include <unistd.h>
+#endif
+
+NAMESPACE_UTILITY_BEG
+
+#ifdef HAS_IO_URING
+
+/// \brief io_uring instance
+class io_ring {
+
+private:
+
+	int m_fd; ///< ring descriptor, -1 if not available
+
+	unsigned m_depth; ///< number of submission entries
+
+	void* m_sq_ptr; ///< mapped submission ring
+
+	size_t m_sq_len; ///< bytes of m_sq_ptr
+
+	void* m_cq_ptr; ///< mapped completion ring, equal to m_sq_ptr if mapped once
+
+	size_t m_cq_len; ///< bytes of m_cq_ptr
+
+	io_uring_sqe* m_sqes; ///< submission entries
+
+	size_t m_sqes_len; ///< bytes of m_sqes
+
+	unsigned* m_sq_head; ///< consumed by the kernel
+
+	unsigned* m_sq_tail; ///< produced by the ring
+
+	unsigned m_sq_mask; ///< mask of the submission indices
+
+	unsigned* m_sq_array; ///< indices of the submitted entries
+
+	unsigned* m_cq_head; ///< consumed by the ring
+
+	unsigned* m_cq_tail; ///< produced by the kernel
+
+	unsigned m_cq_mask; ///< mask of the completion indices
+
+	io_uring_cqe* m_cqes; ///< completion entries
+
+	unsigned m_to_submit; ///< entries queued but not submitted
+
+	uint64 m_inflight; ///< entries submitted but not reaped
+
+	bool m_is_fixed; ///< buffers are registered
+
+	/// \brief release the mappings and the descriptor
+	void release() {
+
+		if (m_sqes != nullptr) munmap(m_sqes, m_sqes_len);
+
+		if (m_cq_ptr != nullptr && m_cq_ptr != m_sq_ptr) munmap(m_cq_ptr, m_cq_len);
+
+		if (m_sq_ptr != nullptr) munmap(m_sq_ptr, m_sq_len);
+
+		if (m_fd != -1) close(m_fd);
+
+		m_sqes = nullptr, m_cq_ptr = m_sq_ptr = nullptr, m_fd = -1;
+	}
+
+	/// \brief submit the queued entries and wait for _min_complete completions
+	bool enter(const unsigned _min_complete) {
+
+		while (true) {
+
+			const int ret = syscall(__NR_io_uring_enter, m_fd, m_to_submit, _min_complete, (_min_complete > 0) ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+
+			if (ret >= 0) {
+
+				m_inflight += ret, m_to_submit -= ret;
+
+				if (m_to_submit == 0 || _min_complete > 0) return true;
+
+				continue; // partially consumed
+			}
+
+			if (errno != EINTR && errno != EAGAIN && errno != EBUSY) return false;
+		}
+	}
+
+public:
+
+	/// \brief ctor
+	///
+	/// \param _depth maximum number of queued entries
+	io_ring(const unsigned _depth) : m_fd(-1), m_depth(0), m_sq_ptr(nullptr), m_sq_len(0), m_cq_ptr(nullptr), m_cq_len(0), m_sqes(nullptr), m_sqes_len(0), m_to_submit(0), m_inflight(0), m_is_fixed(false) {
+
+		io_uring_params params;
+
+		std::memset(&params, 0, sizeof(params));
+
+		m_fd = syscall(__NR_io_uring_setup, std::max(1u, _depth), &params);
+
+		if (m_fd < 0) {
+
+			m_fd = -1;
+
+			return;
+		}
+
+		m_depth = params.sq_entries;
+
+		m_sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+
+		m_cq_len = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+		const bool is_single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+		if (is_single) m_sq_len = m_cq_len = std::max(m_sq_len, m_cq_len);
+
+		m_sq_ptr = mmap(nullptr, m_sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+
+		if (m_sq_ptr == MAP_FAILED) {
+
+			m_sq_ptr = nullptr;
+
+			release();
+
+			return;
+		}
+
+		m_cq_ptr = is_single ? m_sq_ptr : mmap(nullptr, m_cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+
+		if (m_cq_ptr == MAP_FAILED) {
+
+			m_cq_ptr = nullptr;
+
+			release();
+
+			return;
+		}
+
+		m_sqes_len = params.sq_entries * sizeof(io_uring_sqe);
+
+		m_sqes = static_cast<io_uring_sqe*>(mmap(nullptr, m_sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES));
+
+		if (m_sqes == MAP_FAILED) {
+
+			m_sqes = nullptr;
+
+			release();
+
+			return;
+		}
+
+		char* sq = static_cast<char*>(m_sq_ptr), *cq = static_cast<char*>(m_cq_ptr);
+
+		m_sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+
+		m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+
+		m_sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+
+		m_sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+		m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+
+		m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+
+		m_cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+
+		m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+	}
+
+	/// \brief dtor
+	///
+	/// \note the callers reap the submitted reads before, as their buffers may be released afterwards
+	~io_ring() {
+
+		release();
+	}
+
+	/// \brief whether the ring is usable
+	bool is_ready() const {
+
+		return m_fd != -1;
+	}
+
+	/// \brief number of reads submitted but not reaped
+	uint64 inflight() const {
+
+		return m_inflight + m_to_submit;
+	}
+
+	/// \brief register the buffers for fixed reads, return false if refused (e.g., by RLIMIT_MEMLOCK), then plain reads are issued
+	bool register_buffers(const std::vector<char*>& _bufs, const uint64 _bytes) {
+
+		std::vector<iovec> iov(_bufs.size());
+
+		for (uint64 i = 0; i < _bufs.size(); ++i) iov[i].iov_base = _bufs[i], iov[i].iov_len = _bytes;
+
+		m_is_fixed = (syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_BUFFERS, iov.data(), static_cast<unsigned>(iov.size())) == 0);
+
+		return m_is_fixed;
+	}
+
+	/// \brief queue a read of _len bytes at _offset into _buf, return false if the submission ring is full
+	///
+	/// \param _buf_idx index of the registered buffer containing _buf, ignored if no buffer is registered
+	bool prep_read(const int _fd, char* _buf, const uint64 _len, const uint64 _offset, const uint64 _user_data, const uint64 _buf_idx = 0) {
+
+		const unsigned tail = *m_sq_tail;
+
+		if (tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) == m_depth) return false;
+
+		const unsigned idx = tail & m_sq_mask;
+
+		io_uring_sqe& sqe = m_sqes[idx];
+
+		std::memset(&sqe, 0, sizeof(sqe));
+
+		sqe.opcode = m_is_fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+
+		sqe.fd = _fd;
+
+		sqe.addr = reinterpret_cast<uint64>(_buf);
+
+		sqe.len = static_cast<unsigned>(_len);
+
+		sqe.off = _offset;
+
+		sqe.user_data = _user_data;
+
+		if (m_is_fixed) sqe.buf_index = static_cast<uint16>(_buf_idx);
+
+		m_sq_array[idx] = idx;
+
+		__atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+		++m_to_submit;
+
+		return true;
+	}
+
+	/// \brief submit the queued reads by one system call
+	bool submit() {
+
+		return m_to_submit == 0 || enter(0);
+	}
+
+	/// \brief wait for a completion, submitting the queued reads first
+	///
+	/// \param _user_data tag of the completed read
+	/// \param _res number of bytes read (counted in io_read_volume()), or -errno
+	/// \return false if the ring fails or no read is pending
+	bool wait(uint64& _user_data, int64& _res) {
+
+		if (inflight() == 0) return false;
+
+		while (true) {
+
+			const unsigned head = *m_cq_head;
+
+			if (head != __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE)) {
+
+				const io_uring_cqe& cqe = m_cqes[head & m_cq_mask];
+
+				_user_data = cqe.user_data, _res = cqe.res;
+
+				__atomic_store_n(m_cq_head, head + 1, __ATOMIC_RELEASE);
+
+				--m_inflight;
+
+				if (_res > 0) io_read_volume().fetch_add(_res, std::memory_order_relaxed);
+
+				return true;
+			}
+
+			if (false == enter(1)) return false;
+		}
+	}
+};
+
+#else // HAS_IO_URING
+
+/// \brief placeholder if io_uring is not available at compile time, never ready
+class io_ring {
+
+public:
+
+	io_ring(const unsigned) {}
+
+	bool is_ready() const { return false; }
+
+	uint64 inflight() const { return 0; }
+
+	bool register_buffers(const std::vector<char*>&, const uint64) { return false; }
+
+	bool prep_read(const int, char*, const uint64, const uint64, const uint64, const uint64 = 0) { return false; }
+
+	bool submit() { return false; }
+
+	bool wait(uint64&, int64&) { return false; }
+};
+
+#endif // HAS_IO_URING
+
+/// \brief whether io_uring works on this system, probed once
+inline bool io_ring_available() {
+
+	static const bool is_available = io_ring(1).is_ready();
+
+	return is_available;
+}
+
+NAMESPACE_UTILITY_END
+
+#endif // __URING_IO_H
@@ -44,7 +44,9 @@ struct PairLess2nd{
 template<typename value_type>
 struct ExVector {
 
-	typedef typename stxxl::VECTOR_GENERATOR<value_type, 8 / sizeof(value_type) + 1, 2, K_512 * sizeof(value_type)>::result vector;
+	static const uint64 block_size = K_512 * sizeof(value_type); ///< bytes per block, the unit of a random read
+
+	typedef typename stxxl::VECTOR_GENERATOR<value_type, 8 / sizeof(value_type) + 1, 2, block_size>::result vector;
 };
 
 /// \brief function object for comparing tuples by their first component in ascending order
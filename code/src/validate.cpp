@@ -1,26 +1,89 @@
 #include "validate.h"
 
+#include "common/cmdline.h"
+
+#include "common/config.h"
+
+#include "common/sa_width.h"
+
 char* prog_name;
 
+/// \brief run Validate with the given SA/LCP element type and fingerprinting backend
+template<typename size_type, typename fingerprint_type>
+bool run_validate(const std::string& _t_fn, const std::string& _sa_fn, const std::string& _lcp_fn, const Config& _config) {
+
+	std::cerr << "Fingerprint: " << fingerprint_type::name() << std::endl;
+
+	Validate<uint8, size_type, uint32, fingerprint_type> validate(_t_fn, _sa_fn, _lcp_fn, _config);
+
+	return validate.run();
+}
+
+/// \brief run Validate with the given fingerprinting backend, the SA/LCP element type is chosen by width in bits, see sa_width.h
+///
+/// \note Validate packs a fingerprint and a character into the low and high parts of an element, thus only 40- and 48-bit elements are supported
+template<typename fingerprint_type>
+bool run_validate(const std::string& _t_fn, const std::string& _sa_fn, const std::string& _lcp_fn, const uint64 _width, const Config& _config) {
+
+	if (_width == 48) return run_validate<uint48, fingerprint_type>(_t_fn, _sa_fn, _lcp_fn, _config);
+
+	if (_width == 40) return run_validate<uint40, fingerprint_type>(_t_fn, _sa_fn, _lcp_fn, _config);
+
+	std::cerr << _width << "-bit SA/LCP elements are not supported, use validate3 or validate4\n";
+
+	exit(EXIT_FAILURE);
+}
+
 int main(int argc, char **argv) {
 
-	if (argc != 4) {
+	CmdLine cmdline(argc, argv);
+
+	if (cmdline.positional_num() != 3) {
 
 		std::cerr << "Require 3 arguments: t_file, sa_file and lcp_file\n";
+
+		std::cerr << "Options: --fp=prime31|mersenne61 --threads=N --fp-window=N --fp-batch=N --fp-index[=FILE] --fp-index-step=N --width=auto|40|48\n";
+
+		exit(EXIT_FAILURE);
 	}
 
 	//
-	std::string t_fn(argv[1]);
+	std::string t_fn(cmdline.positional(0));
+
+	std::string sa_fn(cmdline.positional(1));
+
+	std::string lcp_fn(cmdline.positional(2));
+
+	std::string fp = cmdline.get("fp", PrimeFingerprint::name());
 
-	std::string sa_fn(argv[2]);
+	Config config(cmdline);
 
-	std::string lcp_fn(argv[3]);
+	std::cerr << "Threads: " << config.thread_num << std::endl;
+
+	const uint64 width = sa_width(cmdline.get("width", "auto"), sa_fn, lcp_fn, BasicIO::file_size(t_fn)); // bits per SA/LCP element
+
+	std::cerr << "SA/LCP width: " << width << std::endl;
 
 	//
-	Validate<uint8, uint40, uint32> validate(t_fn, sa_fn, lcp_fn);
+	bool is_right;
+
+	if (fp == PrimeFingerprint::name()) {
+
+		is_right = run_validate<PrimeFingerprint>(t_fn, sa_fn, lcp_fn, width, config);
+	}
+	else if (fp == MersenneFingerprint::name()) {
+
+		is_right = run_validate<MersenneFingerprint>(t_fn, sa_fn, lcp_fn, width, config);
+	}
+	else {
+
+		std::cerr << "Unknown fingerprint: " << fp << std::endl;
+
+		exit(EXIT_FAILURE);
+	}
 
 	// check
-	if (false == validate.run()) {
+	if (false == is_right) {
 
 		std::cerr << "check--failed\n";
 	}
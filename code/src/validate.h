@@ -18,79 +18,142 @@
 
 #include "common/common.h"
 
+#include "common/fingerprint.h"
+
+#include "common/config.h"
+
+#include "common/prefix_fp.h"
+
 #include "common/basicio.h"
 
 #include "common/widget.h"
 
+#include "common/radix_sort.h"
+
+#include "common/permute.h"
+
 #include "stxxl/timer"
 
+#include <type_traits>
+
 #define TEST_1
 
 #define STATISTICS_COLLECTION
 
 /// \brief validate suffix and LCP arrays using Karp-Rarbin finger-printing function
-template<typename alphabet_type, typename size_type, typename offset_type>
+///
+/// \tparam fingerprint_type fingerprinting backend, see common/fingerprint.h
+template<typename alphabet_type, typename size_type, typename offset_type, typename fingerprint_type = PrimeFingerprint>
 class Validate{
 private:
 
-	/// \brief store (R % P)^1, (R % P)^2, (R % P)^4, ...
-	struct RInterval{
-	
-		fpa_type* m_data;
-	
-		uint64 m_num;
-	
-		/// \brief constructor
-		RInterval(uint64 _len) {
-	
-			m_num = 1;
-	
-			while(_len) {
-	
-				++m_num;
-	
-				_len /= 2;
-			}
-	
-			m_data = new fpa_type[m_num];
-	
-			m_data[0] =  R % P;
-	
-			for(uint64 i = 1; i < m_num; ++i) {
-	
-				m_data[i] = static_cast<fpa_type>((static_cast<fpb_type>(m_data[i - 1]) * m_data[i - 1]) % P);
-			}
-		
-			return;
+	typedef typename fingerprint_type::value_type fp_value_type;
+
+	/// a key stores sa[i] before fingerprinting and (fp, ch) after fingerprinting, thus its low part must hold a fingerprint
+	typedef typename std::conditional<sizeof(fp_value_type) <= sizeof(typename size_type::low_type), size_type, uint72>::type key_type;
+
+	typedef std::pair<key_type, offset_type> pair_type;
+
+	static_assert(sizeof(fp_value_type) <= sizeof(typename key_type::low_type), "fingerprint does not fit in low part of key_type");
+
+	static_assert(sizeof(alphabet_type) <= sizeof(typename key_type::high_type), "character does not fit in high part of key_type");
+
+	typedef typename ExVector<alphabet_type>::vector alphabet_vector_type;
+
+	typedef typename ExVector<size_type>::vector size_vector_type;
+
+	/// \brief request for fingerprinting the idx-th pair in the which-th block
+	struct BlockRequest {
+
+		uint64 first; ///< position in t
+
+		uint8 which; ///< block id, 0, 1 or 2
+
+		uint64 idx; ///< index in the block
+	};
+
+	/// \brief merge three blocks sorted by position into a stream of requests
+	///
+	/// The stream only reads pairs not consumed yet, thus it is safe to overwrite the consumed ones.
+	struct BlockRequestStream {
+
+		typedef BlockRequest value_type;
+
+		pair_type* m_block[3]; ///< blocks
+
+		uint64 m_next[3]; ///< index of the next pair in each block
+
+		uint64 m_end[3]; ///< number of pairs in each block
+
+		BlockRequest m_cur; ///< current request
+
+		bool m_empty; ///< whether the stream is exhausted
+
+		/// \brief ctor
+		BlockRequestStream(pair_type* _pair1_block, pair_type* _pair2_block, pair_type* _pair3_block, const uint64 _num12, const uint64 _num3) {
+
+			m_block[0] = _pair1_block, m_block[1] = _pair2_block, m_block[2] = _pair3_block;
+
+			m_next[0] = m_next[1] = m_next[2] = 0;
+
+			m_end[0] = m_end[1] = _num12, m_end[2] = _num3;
+
+			fetch();
 		}
 
-		/// \brief get fpInterval
-		fpa_type compute(uint64 _interval) {
+		/// \brief pick the pair with the smallest position among the heads of the blocks
+		void fetch() {
 
-			fpa_type ret = 1;
-				
-				for (uint64 i = 0; i < m_num; ++i) {
-	
-				if (_interval % 2) {
-	
-					ret = static_cast<fpa_type>((static_cast<fpb_type>(ret) * m_data[i]) % P);
-				}
-	
-				_interval = _interval / 2;
+			m_empty = true;
+
+			for (uint8 i = 0; i < 3; ++i) {
+
+				if (m_next[i] < m_end[i] && (m_empty || static_cast<uint64>(m_block[i][m_next[i]].first) < m_cur.first)) {
 
-				if (_interval == 0) break;
+					m_cur.first = m_block[i][m_next[i]].first, m_cur.which = i, m_cur.idx = m_next[i];
+
+					m_empty = false;
 				}
-	
-			return ret;
-		}	
+			}
+		}
+
+		const BlockRequest& operator*() const {
+
+			return m_cur;
+		}
+
+		BlockRequestStream& operator++() {
+
+			++m_next[m_cur.which];
+
+			fetch();
+
+			return *this;
+		}
+
+		bool empty() const {
+
+			return m_empty;
+		}
 	};
 
-private:
+	/// \brief radix key of a pair, the position stored in the first component
+	struct PairKey1st {
 
-	typedef typename ExVector<alphabet_type>::vector alphabet_vector_type;
+		uint64 operator()(const pair_type& _pair) const {
 
-	typedef typename ExVector<size_type>::vector size_vector_type;
+			return static_cast<uint64>(_pair.first);
+		}
+	};
+
+	/// \brief slot of a pair in the original order, the index stored in the second component
+	struct PairIndex2nd {
 
+		uint64 operator()(const pair_type& _pair) const {
+
+			return static_cast<uint64>(_pair.second);
+		}
+	};
 
 private:
 
@@ -102,24 +165,21 @@ private:
 
 	uint64 m_len; ///< length of input t/sa/lcp
 
-	RInterval* m_rinterval; 
+	RInterval<fingerprint_type>* m_rinterval; ///< pointer to RInterval object
 
 	alphabet_type m_pre_ch;
 
-	fpa_type m_pre_fp_interval;
+	fp_value_type m_pre_fp_interval;
+
+	Config m_config; ///< run-time settings
+
+	FingerprintCheckpoint<alphabet_vector_type, fingerprint_type>* m_checkpoint; ///< sampled prefix fingerprints, nullptr if not used
 
 public:
 	
 
 	/// \brief constructor
-	Validate(const std::string& _t_fn, const std::string& _sa_fn, const std::string& _lcp_fn) {
-
-		if (typeid(fpa_type).name() != typeid(typename size_type::low_type).name()) {
-
-			std::cerr << "fpa_type is not same as size_type::low_type.\n";
-
-			exit(EXIT_FAILURE);
-		}
+	Validate(const std::string& _t_fn, const std::string& _sa_fn, const std::string& _lcp_fn, const Config& _config = Config()) : m_config(_config) {
 
 		m_t_fn = _t_fn;
 
@@ -129,7 +189,9 @@ public:
 
 		m_len = BasicIO::file_size(m_t_fn) / sizeof(alphabet_type);	
 
-		m_rinterval = new RInterval(m_len);
+		m_rinterval = new RInterval<fingerprint_type>(m_len);
+
+		m_checkpoint = m_config.fp_index_fn.empty() ? nullptr : new FingerprintCheckpoint<alphabet_vector_type, fingerprint_type>(m_len, m_config.fp_index_fn, m_config.fp_index_step, m_t_fn);
 	
 	}
 
@@ -137,7 +199,9 @@ public:
 	/// \brief destrcutor
 	~Validate() {
 
-		delete[] m_rinterval;
+		delete m_rinterval;
+
+		delete m_checkpoint; m_checkpoint = nullptr;
 	}
 
 	/// \brief main program portal
@@ -159,9 +223,7 @@ public:
 		Timer1.start();
 #endif	
 
-		typedef std::pair<size_type, offset_type> pair_type;
-
-		uint64 block_capacity = (MAIN_MEM_AVAIL) / (sizeof(size_type) + sizeof(offset_type)) / 3;
+		uint64 block_capacity = (MAIN_MEM_AVAIL) / sizeof(pair_type) / 4;
 
 		pair_type* pair1_block = new pair_type[block_capacity]; // (sa[i], i)
 
@@ -169,6 +231,8 @@ public:
 
 		pair_type* pair3_block = new pair_type[block_capacity]; // (sa[i] + lcp[i + 1] - 1, i)
 
+		pair_type* sort_buffer = new pair_type[block_capacity]; // scratch space for radix sort
+
 #ifdef STATISTICS_COLLECTION
 
 		Timer1.stop();
@@ -218,19 +282,19 @@ public:
 			for (uint32 j = 0; j < item_num - ((items_toread == item_num) ? 1 : 0); ++j) {
 
 				// pair1_block stores (sa[j], j)
-				pair1_block[j].first = *(*sa_reader);
+				pair1_block[j].first = static_cast<uint64>(*(*sa_reader));
 
 				pair1_block[j].second = j;
 
 				// pair2_block stores (sa[j] + lcp[j], j)
-				pair2_block[j].first = *(*sa_reader) + *(*lcp_reader);
+				pair2_block[j].first = static_cast<uint64>(*(*sa_reader) + *(*lcp_reader));
 
 				pair2_block[j].second = j;
 
 				// pair3_block stores (sa[j] + lcp[j + 1], j)
 				++(*lcp_reader);
 
-				pair3_block[j].first = *(*sa_reader) + *(*lcp_reader); 
+				pair3_block[j].first = static_cast<uint64>(*(*sa_reader) + *(*lcp_reader)); 
 
 				pair3_block[j].second = j;
 
@@ -242,12 +306,12 @@ public:
 			if (items_toread == item_num) {
 
 				// pair1_block stores (sa[j], j)
-				pair1_block[item_num - 1].first = *(*sa_reader);
+				pair1_block[item_num - 1].first = static_cast<uint64>(*(*sa_reader));
 
 				pair1_block[item_num - 1].second = item_num - 1;
 
 				// pair2_block stores (sa[j] + lcp[j], j)
-				pair2_block[item_num - 1].first = *(*sa_reader) + *(*lcp_reader);
+				pair2_block[item_num - 1].first = static_cast<uint64>(*(*sa_reader) + *(*lcp_reader));
 
 				pair2_block[item_num - 1].second = item_num - 1;
 
@@ -278,7 +342,7 @@ public:
 #endif
 
 			// check block
-			bool is_right = check_block(pair1_block, pair2_block, pair3_block, item_num, block_id, block_capacity, items_toread == item_num);
+			bool is_right = check_block(pair1_block, pair2_block, pair3_block, sort_buffer, item_num, block_id, block_capacity, items_toread == item_num);
 
 			if (!is_right) return false;
 
@@ -311,11 +375,21 @@ public:
 
 		std::cerr << "block num: " << block_id + 1 << std::endl;
 
+		delete[] pair1_block; pair1_block = nullptr;
+
+		delete[] pair2_block; pair2_block = nullptr;
+
+		delete[] pair3_block; pair3_block = nullptr;
+
+		delete[] sort_buffer; sort_buffer = nullptr;
+
 		return true;
 	}
 
 	/// \brief check an sa/lcp block
-	bool check_block(std::pair<size_type, uint32>* _pair1_block, std::pair<size_type, uint32>* _pair2_block, std::pair<size_type, uint32>* _pair3_block, const uint64& _item_num, const uint64& _block_id, const uint64& _block_capacity, const bool _is_rightmost) {
+	///
+	/// \param _sort_buffer scratch space of the same capacity as the blocks, the four pointers may be rotated on return
+	bool check_block(pair_type*& _pair1_block, pair_type*& _pair2_block, pair_type*& _pair3_block, pair_type*& _sort_buffer, const uint64& _item_num, const uint64& _block_id, const uint64& _block_capacity, const bool _is_rightmost) {
 
 #ifdef STATISTICS_COLLECTION
 
@@ -325,12 +399,14 @@ public:
 
 #endif
 
-		// sort pairs by first component
-		std::sort(_pair1_block, _pair1_block + _item_num, PairLess1st<std::pair<size_type, uint32>>());
+		// sort pairs by first component, i.e., positions in t
+		PairKey1st key_1st;
+
+		ParallelRadixSort<pair_type>::sort(_pair1_block, _sort_buffer, _item_num, m_config.thread_num, key_1st);
 
-		std::sort(_pair2_block, _pair2_block + _item_num, PairLess1st<std::pair<size_type, uint32>>());
+		ParallelRadixSort<pair_type>::sort(_pair2_block, _sort_buffer, _item_num, m_config.thread_num, key_1st);
 
-		std::sort(_pair3_block, _pair3_block + _item_num - (_is_rightmost ? 1 : 0), PairLess1st<std::pair<size_type, uint32>>());
+		ParallelRadixSort<pair_type>::sort(_pair3_block, _sort_buffer, _item_num - (_is_rightmost ? 1 : 0), m_config.thread_num, key_1st);
 
 #ifdef STATISTICS_COLLECTION
 
@@ -349,69 +425,28 @@ public:
 
 		alphabet_vector_type t(&t_file);
 
-		typename alphabet_vector_type::bufreader_type t_reader(t);
-		
-		// compute fp[0, i - 1] iteratively
-		fpa_type fp = 0; //fp[0, -1] = 0
-		
-		uint64 j1 = 0, j2 = 0, j3 = 0;
-
-		for (uint64 i = 0; i < m_len; ++i) {
-
-			// store fp[0,i - 1] and set ch = 0
-			while (j1 < _item_num && i == _pair1_block[j1].first) {
+		// compute fp[0, i - 1] for the pairs in ascending order of i, reuse high/low part of the key to store ch/fp
+		BlockRequestStream requests(_pair1_block, _pair2_block, _pair3_block, _item_num, _item_num - (_is_rightmost ? 1 : 0));
 
-				_pair1_block[j1].first.set(fp, 0); // reuse high/low part to store ch/fp
-			
-				++j1;
-			}
+		pair_type* blocks[3] = {_pair1_block, _pair2_block, _pair3_block};
 
-			// store fp[0, i] and ch = *t_reader
-			while (j2 < _item_num && i == _pair2_block[j2].first) {
+		PrefixFingerprint<alphabet_vector_type, fingerprint_type> prefix_fp(t, m_config, m_checkpoint);
 
-				_pair2_block[j2].first.set(fp, *t_reader);
+		prefix_fp.answer(requests, [&](const BlockRequest& _request, const fp_value_type _fp, const alphabet_type _ch) {
 
-				++j2;
-			}				
+			if (_request.which == 0) { // store fp[0, i - 1] and set ch = 0
 
-			// store fp[0, i] and ch = *t_reader
-			while (j3 < _item_num - (_is_rightmost ? 1 : 0) && i == _pair3_block[j3].first) {
-
-				_pair3_block[j3].first.set(fp, *t_reader);
-
-				++j3;
+				blocks[0][_request.idx].first.set(_fp, 0);
 			}
+			else if (_request.first < m_len) { // store fp[0, i - 1] and ch = t[i]
 
-			// compute fp[0, i]
-			fp = static_cast<fpa_type>((static_cast<fpb_type>(fp) * R + (*t_reader + 1)) % P); // t_reader + 1 to gurantee non-zero
-
-			++t_reader;
-		}
-
-		// special case: m_len
-		while (j1 < _item_num) {
-
-			_pair1_block[j1].first.set(fp, 0); // reuse high/low part to store ch/fp
-			
-			++j1;
-		}
-
-		while (j2 < _item_num) {
-
-			_pair2_block[j2].first.set(fp, std::numeric_limits<typename size_type::high_type>::max());
-
-			++j2;
-		}				
-
-		while (j3 < _item_num - (_is_rightmost ? 1 : 0)) {
-
-			_pair3_block[j3].first.set(fp, std::numeric_limits<typename size_type::high_type>::max());
-
-			++j3;
-		}
+				blocks[_request.which][_request.idx].first.set(_fp, _ch);
+			}
+			else { // special case: m_len
 
-		//
-		assert(t_reader.empty() == true);
+				blocks[_request.which][_request.idx].first.set(_fp, std::numeric_limits<typename key_type::high_type>::max());
+			}
+		});
 
 #ifdef STATISTICS_COLLECTION
 
@@ -425,12 +460,20 @@ public:
 		
 #endif
 
-		// sort pairs back to original order 
-		std::sort(_pair1_block, _pair1_block + _item_num, PairLess2nd<std::pair<size_type, uint32>>());
+		// scatter pairs back to original order, the second components form a permutation of [0, item_num)
+		PairIndex2nd index_2nd;
+
+		ParallelScatter<pair_type>::scatter(_pair1_block, _sort_buffer, _item_num, m_config.thread_num, index_2nd);
+
+		std::swap(_pair1_block, _sort_buffer);
+
+		ParallelScatter<pair_type>::scatter(_pair2_block, _sort_buffer, _item_num, m_config.thread_num, index_2nd);
+
+		std::swap(_pair2_block, _sort_buffer);
 
-		std::sort(_pair2_block, _pair2_block + _item_num, PairLess2nd<std::pair<size_type, uint32>>());
+		ParallelScatter<pair_type>::scatter(_pair3_block, _sort_buffer, _item_num - (_is_rightmost ? 1 : 0), m_config.thread_num, index_2nd);
 
-		std::sort(_pair3_block, _pair3_block + _item_num - (_is_rightmost ? 1 : 0), PairLess2nd<std::pair<size_type, uint32>>());
+		std::swap(_pair3_block, _sort_buffer);
 
 
 #ifdef STATISTICS_COLLECTION
@@ -447,7 +490,7 @@ public:
 		// check result
 		alphabet_type pre_ch;
 
-		fpa_type fp_interval, pre_fp_interval;
+		fp_value_type fp_interval, pre_fp_interval;
 
 		//
 		stxxl::syscall_file lcp_file(m_lcp_fn, stxxl::syscall_file::RDWR | stxxl::syscall_file::DIRECT);
@@ -467,7 +510,7 @@ public:
 
 			++lcp_reader;
 
-			pre_fp_interval = static_cast<fpa_type>(((static_cast<fpb_type>(_pair3_block[0].first.get_low()) - static_cast<fpb_type>(_pair1_block[0].first.get_low()) * m_rinterval->compute(*lcp_reader) % P) + P) % P); //fp[sa[0] + lcp[1] - 1] - fp[ - 1]			
+			pre_fp_interval = fingerprint_type::interval(_pair3_block[0].first.get_low(), _pair1_block[0].first.get_low(), m_rinterval->compute(*lcp_reader)); //fp[sa[0] + lcp[1] - 1] - fp[ - 1]			
 		}
 		else {
 
@@ -488,7 +531,7 @@ public:
 			}
 
 			// compare fp(sa[i] + lcp[i]] and fp[sa[i - 1] + lcp[i]]
-			fp_interval = static_cast<fpa_type>(((static_cast<fpb_type>(_pair2_block[i].first.get_low()) - static_cast<fpb_type>(_pair1_block[i].first.get_low())* m_rinterval->compute(*lcp_reader) % P) + P) % P);
+			fp_interval = fingerprint_type::interval(_pair2_block[i].first.get_low(), _pair1_block[i].first.get_low(), m_rinterval->compute(*lcp_reader));
 
 			if (fp_interval != pre_fp_interval) {
 				
@@ -502,7 +545,7 @@ public:
 
 			++lcp_reader;
 
-			pre_fp_interval = static_cast<fpa_type>(((static_cast<fpb_type>(_pair3_block[i].first.get_low()) - static_cast<fpb_type>(_pair1_block[i].first.get_low()) * m_rinterval->compute(*lcp_reader) % P) + P) % P);
+			pre_fp_interval = fingerprint_type::interval(_pair3_block[i].first.get_low(), _pair1_block[i].first.get_low(), m_rinterval->compute(*lcp_reader));
 		}
 
 		// rightmost block, lcp[item_num] does not exist
@@ -510,7 +553,7 @@ public:
 
 			if (pre_ch == _pair2_block[_item_num - 1].first.get_high()) return false;
 
-			fp_interval = static_cast<fpa_type>(((static_cast<fpb_type>(_pair2_block[_item_num - 1].first.get_low()) - static_cast<fpb_type>(_pair1_block[_item_num - 1].first.get_low())* m_rinterval->compute(*lcp_reader) % P) + P) % P);
+			fp_interval = fingerprint_type::interval(_pair2_block[_item_num - 1].first.get_low(), _pair1_block[_item_num - 1].first.get_low(), m_rinterval->compute(*lcp_reader));
 
 			if (fp_interval != pre_fp_interval) return false;
 
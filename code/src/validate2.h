@@ -18,6 +18,8 @@
 
 #include "common/common.h"
 
+#include "common/fingerprint.h"
+
 #include "common/tuples.h"
 
 #include "common/widget.h"
@@ -34,60 +36,6 @@ private:
 
 	typedef typename ExVector<alphabet_type>::vector alphabet_vector_type;
 
-private:
-
-	/// \brief store (R % P)^1, (R % P)^2, (R % P)^4, ...
-	struct RInterval{
-	
-		fpa_type* m_data;
-	
-		uint64 m_num;
-	
-		/// \brief constructor
-		RInterval(uint64 _len) {
-	
-			m_num = 1;
-	
-			while(_len) {
-	
-				++m_num;
-	
-				_len /= 2;
-			}
-	
-			m_data = new fpa_type[m_num];
-	
-			m_data[0] =  R % P;
-	
-			for(uint64 i = 1; i < m_num; ++i) {
-	
-				m_data[i] = static_cast<fpa_type>((static_cast<fpb_type>(m_data[i - 1]) * m_data[i - 1]) % P);
-			}
-		
-			return;
-		}
-
-		/// \brief get fpInterval
-		fpa_type compute(uint64 _interval) {
-
-			fpa_type ret = 1;
-				
-				for (uint64 i = 0; i < m_num; ++i) {
-	
-				if (_interval % 2) {
-	
-					ret = static_cast<fpa_type>((static_cast<fpb_type>(ret) * m_data[i]) % P);
-				}
-	
-				_interval = _interval / 2;
-
-				if (_interval == 0) break;
-				}
-	
-			return ret;
-		}	
-	};
-
 private:
 
 	std::string m_t_fn; ///< file name of input string
@@ -98,7 +46,7 @@ private:
 
 	uint64 m_len; ///< length of input string
 
-	RInterval* m_rinterval; ///< pointer to an instance of RInterval
+	RInterval<>* m_rinterval; ///< pointer to an instance of RInterval
 
 public:
 
@@ -115,7 +63,7 @@ public:
 
 		std::cerr << "m_len: " << m_len / 1024 / 1024 << " MB" << std::endl;
 
-		m_rinterval = new RInterval(m_len);
+		m_rinterval = new RInterval<>(m_len);
 
 		run();
 	}
@@ -200,9 +148,9 @@ public:
 
 				const triple_type& item = *(*triple_sorter);
 
-				triple_sorter2->push(triple_type2(item.first + item.second, item.third, static_cast<fpb_type>(fp) * m_rinterval->compute(item.second)));
+				triple_sorter2->push(triple_type2(item.first + item.second, item.third, PrimeFingerprint::mul(fp, m_rinterval->compute(item.second))));
 
-				fp = static_cast<fpa_type>((static_cast<fpb_type>(fp) * R + (*(*t_reader) + 1)) % P);
+				fp = PrimeFingerprint::append(fp, *(*t_reader));
 			}	
 
 			delete triple_sorter; triple_sorter = nullptr;
@@ -244,14 +192,14 @@ public:
 
 					const triple_type2& item = *(*triple_sorter2);
 
-					fp_interval = static_cast<fpa_type>((static_cast<fpb_type>(fp) - item.third % P + P) % P);
+					fp_interval = PrimeFingerprint::sub(fp, static_cast<fpa_type>(item.third));
 
 					quadruple_sorter->push(quadruple_type(item.second, item.third, *(*t_reader), fp_interval));
 	
 					++(*triple_sorter2);
 				}
 	
-				fp = static_cast<fpa_type>((static_cast<fpb_type>(fp) * R + *(*t_reader) + 1) % P);
+				fp = PrimeFingerprint::append(fp, *(*t_reader));
 			}
 	
 			// special case: pos == m_len
@@ -259,7 +207,7 @@ public:
 
 				const triple_type2& item = *(*triple_sorter2);
 
-				fp_interval = static_cast<fpa_type>((static_cast<fpb_type>(fp) - item.third % P + P) % P);
+				fp_interval = PrimeFingerprint::sub(fp, static_cast<fpa_type>(item.third));
 
 				quadruple_sorter->push(quadruple_type(item.second, item.third, std::numeric_limits<alphabet_type>::max(), fp_interval));
 	
@@ -351,7 +299,7 @@ public:
 
 					const quadruple_type2& item = *(*quadruple_sorter2);
 
-					fp_interval = static_cast<fpa_type>((static_cast<fpb_type>(fp) - std::get<1>(item) + P) % P + P);
+					fp_interval = PrimeFingerprint::sub(fp, static_cast<fpa_type>(std::get<1>(item)));
 
 					if (fp_interval != std::get<2>(item) || *(*t_reader) == std::get<3>(item)) {
 
@@ -359,7 +307,7 @@ public:
 					}
 				}
 
-				fp = static_cast<fpa_type>((static_cast<fpb_type>(fp) * R + *(*t_reader) + 1) % P);
+				fp = PrimeFingerprint::append(fp, *(*t_reader));
 			}
 	
 			// pos == m_len
@@ -367,7 +315,7 @@ public:
 
 				const quadruple_type2& item = *(*quadruple_sorter2);
 
-				fp_interval = static_cast<fpa_type>((static_cast<fpb_type>(fp) - std::get<1>(item) + P) % P + P);
+				fp_interval = PrimeFingerprint::sub(fp, static_cast<fpa_type>(std::get<1>(item)));
 
 				if (fp_interval != std::get<2>(item)) {
 
@@ -1,26 +1,101 @@
 #include "validate3.h"
 
+#include "common/cmdline.h"
+
+#include "common/config.h"
+
+#include "common/sa_width.h"
+
 char* prog_name;
 
+/// \brief run Validate3 with the given SA/LCP element type, tuple index type and fingerprinting backend
+template<typename size_type, typename index_type, typename fingerprint_type>
+bool run_validate3(const std::string& _t_fn, const std::string& _sa_fn, const std::string& _lcp_fn, const Config& _config) {
+
+	std::cerr << "Fingerprint: " << fingerprint_type::name() << std::endl;
+
+	Validate3<uint8, size_type, index_type, fingerprint_type> validate3(_t_fn, _sa_fn, _lcp_fn, _config);
+
+	return validate3.run();
+}
+
+/// \brief run Validate3 with the given SA/LCP element type and fingerprinting backend, the tuple index type is chosen by width in bits, see sa_width.h
+template<typename size_type, typename fingerprint_type>
+bool run_validate3(const std::string& _t_fn, const std::string& _sa_fn, const std::string& _lcp_fn, const uint64 _index_width, const Config& _config) {
+
+	if (_index_width == 32) return run_validate3<size_type, uint32, fingerprint_type>(_t_fn, _sa_fn, _lcp_fn, _config);
+
+	return run_validate3<size_type, size_type, fingerprint_type>(_t_fn, _sa_fn, _lcp_fn, _config);
+}
+
+/// \brief run Validate3 with the given fingerprinting backend, the SA/LCP element type is chosen by width in bits, see sa_width.h
+template<typename fingerprint_type>
+bool run_validate3(const std::string& _t_fn, const std::string& _sa_fn, const std::string& _lcp_fn, const uint64 _width, const uint64 _index_width, const Config& _config) {
+
+	switch (_width) {
+
+	case 32: return run_validate3<uint32, uint32, fingerprint_type>(_t_fn, _sa_fn, _lcp_fn, _config); // the positions are 32-bit as well
+
+	case 48: return run_validate3<uint48, fingerprint_type>(_t_fn, _sa_fn, _lcp_fn, _index_width, _config);
+
+	case 64: return run_validate3<uint64, fingerprint_type>(_t_fn, _sa_fn, _lcp_fn, _index_width, _config);
+
+	default: return run_validate3<uint40, fingerprint_type>(_t_fn, _sa_fn, _lcp_fn, _index_width, _config);
+	}
+}
+
 int main(int argc, char **argv) {
 
-	if (argc != 4) {
+	CmdLine cmdline(argc, argv);
+
+	if (cmdline.positional_num() != 3) {
 
 		std::cerr << "Require 3 arguments: t_file, sa_file and lcp_file\n";
+
+		std::cerr << "Options: --fp=prime31|mersenne61 --threads=N --fp-window=N --fp-batch=N --fp-index[=FILE] --fp-index-step=N --fp-extra=K --fp-seed=S --width=auto|32|40|48|64\n";
+
+		exit(EXIT_FAILURE);
 	}
 
 	//
-	std::string t_fn(argv[1]);
+	std::string t_fn(cmdline.positional(0));
+
+	std::string sa_fn(cmdline.positional(1));
+
+	std::string lcp_fn(cmdline.positional(2));
+
+	std::string fp = cmdline.get("fp", PrimeFingerprint::name());
+
+	Config config(cmdline);
+
+	std::cerr << "Threads: " << config.thread_num << std::endl;
+
+	const uint64 width = sa_width(cmdline.get("width", "auto"), sa_fn, lcp_fn, BasicIO::file_size(t_fn)); // bits per SA/LCP element
 
-	std::string sa_fn(argv[2]);
+	const uint64 index_width = sa_index_width(width, BasicIO::file_size(t_fn)); // bits per position in the sorter tuples
 
-	std::string lcp_fn(argv[3]);
+	std::cerr << "SA/LCP width: " << width << ", tuple index width: " << index_width << std::endl;
 
 	//
-	Validate3<uint8, uint40> validate3(t_fn, sa_fn, lcp_fn);
+	bool is_right;
+
+	if (fp == PrimeFingerprint::name()) {
+
+		is_right = run_validate3<PrimeFingerprint>(t_fn, sa_fn, lcp_fn, width, index_width, config);
+	}
+	else if (fp == MersenneFingerprint::name()) {
+
+		is_right = run_validate3<MersenneFingerprint>(t_fn, sa_fn, lcp_fn, width, index_width, config);
+	}
+	else {
+
+		std::cerr << "Unknown fingerprint: " << fp << std::endl;
+
+		exit(EXIT_FAILURE);
+	}
 
 	// check
-	if (false == validate3.run()) {
+	if (false == is_right) {
 
 		std::cerr << "check--failed\n";
 	}
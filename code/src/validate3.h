@@ -18,75 +18,37 @@
 
 #include "common/common.h"
 
+#include "common/fingerprint.h"
+
+#include "common/config.h"
+
+#include "common/prefix_fp.h"
+
+#include "common/multi_fp.h"
+
+#include "common/permute.h"
+
 #include "common/tuples.h"
 
 #include "common/widget.h"
 
 #include "common/basicio.h"
 
+#include "common/sa_width.h"
+
 #define TEST_VALIDATE3
 
 /// \brief validate sa and lcp using Karp-Rabin fingerprinting function
 ///
 /// type of elements in the input string and suffix/LCP array are specified by alphabet_type and size_type, respectively.
-template<typename alphabet_type, typename size_type>
+/// index_type specifies the positions carried by the sorter tuples, see common/sa_width.h.
+/// fingerprint_type specifies the fingerprinting backend, see common/fingerprint.h.
+template<typename alphabet_type, typename size_type, typename index_type, typename fingerprint_type = PrimeFingerprint>
 class Validate3{
 
 private:
 
-	/// \brief store (R % P)^1, (R % P)^2, (R % P)^4, ...
-	struct RInterval{
-	
-		fpa_type* m_data;
-	
-		uint64 m_num;
-	
-		/// \brief constructor
-		RInterval(uint64 _len) {
-	
-			m_num = 1;
-	
-			while(_len) {
-	
-				++m_num;
-	
-				_len /= 2;
-			}
-	
-			m_data = new fpa_type[m_num];
-	
-			m_data[0] =  R % P;
-	
-			for(uint64 i = 1; i < m_num; ++i) {
-	
-				m_data[i] = static_cast<fpa_type>((static_cast<fpb_type>(m_data[i - 1]) * m_data[i - 1]) % P);
-			}
-		
-			return;
-		}
-
-		/// \brief get fpInterval
-		fpa_type compute(uint64 _interval) {
-
-			fpa_type ret = 1;
-				
-			for (uint64 i = 0; i < m_num; ++i) {
-	
-				if (_interval % 2) {
-	
-					ret = static_cast<fpa_type>((static_cast<fpb_type>(ret) * m_data[i]) % P);
-				}
-	
-				_interval = _interval / 2;
-	
-				if (_interval == 0) break;
-			}
-	
-			return ret;
-		}	
-	};
-
-private:
+	typedef typename fingerprint_type::value_type fp_value_type;
 
 	std::string m_t_fn; ///< filename for intput string
 
@@ -96,7 +58,13 @@ private:
 
 	uint64 m_len; ////< length of input string/SA/LCP
 
-	RInterval* m_rinterval; ///< pointer to RInterval object
+	RInterval<fingerprint_type>* m_rinterval; ///< pointer to RInterval object
+
+	Config m_config; ///< run-time settings
+
+	MultiFingerprint* m_extra; ///< extra fingerprints, nullptr if not used
+
+	uint64 m_extra_num; ///< number of extra fingerprints
 
 private:
 
@@ -106,26 +74,39 @@ private:
 
 	typedef typename ExVector<size_type>::vector size_vector_type;	
 
-	// sort by 1st component
-	typedef pair<size_type, size_type> pair1_type;
+	typedef pair<index_type, fp_value_type> pair2_type;
+
+	typedef triple<index_type, fp_value_type, uint16> triple_type;
+
+	/// \brief output streams with K extra fingerprints per record, sorted by 1st component
+	template<uint64 K>
+	struct StreamTypes {
 
-	typedef tuple_less_comparator_1st<pair1_type> pair1_comparator_type;
+		typedef ExtraTuple<pair2_type, K> tuple1_type;
 
-	typedef typename ExTupleSorter<pair1_type, pair1_comparator_type>::sorter pair1_sorter_type;
+		typedef tuple_less_comparator_1st<tuple1_type> comparator1_type;
 
-	// sort by 1st component
-	typedef pair<size_type, fpa_type> pair2_type;
+		typedef typename ExTupleSorter<tuple1_type, comparator1_type>::sorter sorter1_type;
 
-	typedef tuple_less_comparator_1st<pair2_type> pair2_comparator_type;
+		typedef PermuteBack<tuple1_type> permute1_type; // in-RAM replacement of sorter1_type
 
-	typedef typename ExTupleSorter<pair2_type, pair2_comparator_type>::sorter pair2_sorter_type;
+		typedef ExtraTuple<triple_type, K> tuple2_type;
 
-	// sort by 1st component
-	typedef triple<size_type, fpa_type, uint16> triple_type;
+		typedef tuple_less_comparator_1st<tuple2_type> comparator2_type;
 
-	typedef tuple_less_comparator_1st<triple_type> triple_comparator_type;
+		typedef typename ExTupleSorter<tuple2_type, comparator2_type>::sorter sorter2_type;
+
+		typedef PermuteBack<tuple2_type> permute2_type; // in-RAM replacement of sorter2_type
+	};
 
-	typedef typename ExTupleSorter<triple_type, triple_comparator_type>::sorter triple_sorter_type;
+	// sort by 1st component, (pos, i, stream id)
+	typedef triple<index_type, index_type, uint8> request_type;
+
+	typedef tuple_less_comparator_1st<request_type> request_comparator_type;
+
+	typedef typename ExTupleSorter<request_type, request_comparator_type>::sorter request_sorter_type;
+
+	FingerprintCheckpoint<alphabet_vector_type, fingerprint_type>* m_checkpoint; ///< sampled prefix fingerprints, nullptr if not used
 
 public:
 
@@ -134,7 +115,8 @@ public:
 	/// \param _t_fn  input string
 	/// \param _sa_fn suffix array
 	/// \param _lcp_fn lcp array
-	Validate3(const std::string& _t_fn, const std::string& _sa_fn, const std::string& _lcp_fn) {
+	/// \param _config run-time settings
+	Validate3(const std::string& _t_fn, const std::string& _sa_fn, const std::string& _lcp_fn, const Config& _config = Config()) : m_config(_config) {
 
 		m_t_fn = _t_fn;
 
@@ -144,9 +126,24 @@ public:
 
 		m_len = BasicIO::file_size(_t_fn) / sizeof(alphabet_type);
 
-		m_rinterval = new RInterval(m_len);
+		m_rinterval = new RInterval<fingerprint_type>(m_len);
+
+		m_checkpoint = m_config.fp_index_fn.empty() ? nullptr : new FingerprintCheckpoint<alphabet_vector_type, fingerprint_type>(m_len, m_config.fp_index_fn, m_config.fp_index_step, m_t_fn);
+
+		m_extra_num = m_config.fp_extra_num;
+
+		m_extra = (m_extra_num == 0) ? nullptr : new MultiFingerprint(m_extra_num, m_config.fp_seed, m_len);
 	}
 
+	/// \brief destructor
+	~Validate3() {
+
+		delete m_rinterval; m_rinterval = nullptr;
+
+		delete m_checkpoint; m_checkpoint = nullptr;
+
+		delete m_extra; m_extra = nullptr;
+	}
 
 	/// \brief core part of the program
 	///
@@ -163,31 +160,21 @@ public:
 
 		Timer.start();
 
-		// step 1: fetch fp[0, sa[i] - 1]	
-		pair2_sorter_type* sorter1 = fetch_fp();
+		bool res = false;
 
-		std::cerr << "here1 \n" << std::endl;
+		switch (MultiFingerprint::record_num(m_extra_num)) { // at most MultiFingerprint::MAX_NUM
 
-		// step 2: fetch fp[0, sa[i] +lcp[i] - 1]
-		triple_sorter_type* sorter2 = fetch_fp_ch_cur();
+		case 0: res = run_streams<0>(); break;
 
-		std::cerr << "here2 \n" << std::endl;
+		case 2: res = run_streams<2>(); break;
 
-		// step 3: fetch fp[0, sa[i - 1] + lcp[i] - 1]
-		triple_sorter_type* sorter3 = fetch_fp_ch_pre();
-
-		std::cerr << "here3 \n" << std::endl;
-
-		// step 4: check the result
-		bool res = check(sorter1, sorter2, sorter3);
-
-		std::cerr << "here4 \n" << std::endl;
-
-		delete sorter1; sorter1 = nullptr;
+		default: res = run_streams<MultiFingerprint::MAX_NUM>(); break;
+		}
 
-		delete sorter2; sorter2 = nullptr;
+		if (m_extra != nullptr) {
 
-		delete sorter3; sorter3 = nullptr;
+			std::cerr << "Extra fingerprints: " << m_extra_num << ", seed: " << m_config.fp_seed << ", error probability <= 2^" << m_extra->log2_error_bound(m_len, m_len) << std::endl;
+		}
 
 
 		//
@@ -210,173 +197,103 @@ public:
 		return res;
 	}
 
-	/// \brief fetch fp[0, sa[i] - 1]
-	///
-	pair2_sorter_type* fetch_fp() {
+	/// \brief steps 1-4 with K extra fingerprints in the records of the output streams
+	template<uint64 K>
+	bool run_streams() {
 
-		// sort <sa[i], i> by 1st component to produce isa
-		pair1_sorter_type* pair1_sorter = new pair1_sorter_type(pair1_comparator_type(), MAIN_MEM_AVAIL / 4);
+		typedef StreamTypes<K> types;
 
-		stxxl::syscall_file* sa_file = new stxxl::syscall_file(m_sa_fn, stxxl::syscall_file::RDWR | stxxl::syscall_file::DIRECT);
+		const uint64 sorter_mem = MAIN_MEM_AVAIL / 4;
 
-		size_vector_type* sa = new size_vector_type(sa_file);
+		bool res;
 
-		typename size_vector_type::bufreader_type *sa_reader = new typename size_vector_type::bufreader_type(*sa);
-		
-		for (uint64 idx = 1; !sa_reader->empty();  ++(*sa_reader), ++idx) {
+		if (types::permute1_type::memory(m_len) + 2 * types::permute2_type::memory(m_len) <= 3 * sorter_mem) { // permute the output streams back in RAM
 
-			pair1_sorter->push(pair1_type(*(*sa_reader), idx));		
-		}
+			typename types::permute1_type* sorter1 = new typename types::permute1_type(m_len, 1);
 
-		delete sa_reader; sa_reader = nullptr;
+			typename types::permute2_type* sorter2 = new typename types::permute2_type(m_len, 1), *sorter3 = new typename types::permute2_type(m_len, 1);
 
-		delete sa; sa = nullptr;
+			res = fetch_and_check<K>(sorter1, sorter2, sorter3);
 
-		delete sa_file; sa_file = nullptr;
+			delete sorter1; sorter1 = nullptr;
 
-		pair1_sorter->sort();
-		
-		// scan t iteratively to compute fingerprints
-		pair2_sorter_type* pair2_sorter = new pair2_sorter_type(pair2_comparator_type(), MAIN_MEM_AVAIL / 4);
+			delete sorter2; sorter2 = nullptr;
 
-		stxxl::syscall_file* t_file = new stxxl::syscall_file(m_t_fn, stxxl::syscall_file::RDWR | stxxl::syscall_file::DIRECT);
+			delete sorter3; sorter3 = nullptr;
+		}
+		else { // sort the output streams back in external memory
 
-		alphabet_vector_type* t = new alphabet_vector_type(t_file);
+			typename types::sorter1_type* sorter1 = new typename types::sorter1_type(typename types::comparator1_type(), sorter_mem);
 
-		typename alphabet_vector_type::bufreader_type *t_reader = new typename alphabet_vector_type::bufreader_type(*t);
+			typename types::sorter2_type* sorter2 = new typename types::sorter2_type(typename types::comparator2_type(), sorter_mem), *sorter3 = new typename types::sorter2_type(typename types::comparator2_type(), sorter_mem);
 
-		fpa_type fp = 0;
+			res = fetch_and_check<K>(sorter1, sorter2, sorter3);
 
-		for (; !t_reader->empty(); ++(*t_reader), ++(*pair1_sorter)) {
+			delete sorter1; sorter1 = nullptr;
 
-			const pair1_type& tuple = *(*pair1_sorter);
-		
-			pair2_sorter->push(pair2_type(tuple.second, fp));
+			delete sorter2; sorter2 = nullptr;
 
-			fp = static_cast<fpa_type>((static_cast<fpb_type>(fp) * R + (*(*t_reader) + 1)) % P); // plus 1 to avoid equal to 0
+			delete sorter3; sorter3 = nullptr;
 		}
 
-		delete t_reader; t_reader = nullptr;
-
-		delete t; t = nullptr;
-
-		delete t_file; t_file = nullptr;
+		return res;
+	}
 
-		delete pair1_sorter; pair1_sorter = nullptr;
+	/// \brief steps 1-4 given the output streams, either stxxl sorters or PermuteBack objects
+	template<uint64 K, typename sorter1_type, typename sorter2_type>
+	bool fetch_and_check(sorter1_type* _sorter1, sorter2_type* _sorter2, sorter2_type* _sorter3) {
 
-		pair2_sorter->sort();
+		// step 1-3: fetch fp[0, sa[i] - 1], fp[0, sa[i] +lcp[i] - 1] and fp[0, sa[i - 1] + lcp[i] - 1] in a single scan of t
+		fetch<K>(_sorter1, _sorter2, _sorter3);
 
-		return pair2_sorter;	
+		// step 4: check the result
+		return check(_sorter1, _sorter2, _sorter3);
 	}
 
-	/// \brief fetch fp[0, sa[i] + lcp[i] - 1] and t[sa[i] + lcp[i]]
+	/// \brief fetch fp[0, sa[i] - 1], fp[0, sa[i] + lcp[i] - 1] & t[sa[i] + lcp[i]] and fp[0, sa[i - 1] + lcp[i] - 1] & t[sa[i - 1] + lcp[i]]
 	///
-	triple_sorter_type* fetch_fp_ch_cur() {
+	/// The requests of the three kinds are tagged with their stream ids and sorted together, such that they are answered in a single scan of t.
+	///
+	/// \param _sorter1 (i, fp[0, sa[i] - 1]) for 1 <= i <= n, where idx starts from 1
+	/// \param _sorter2 (i, fp[0, sa[i] + lcp[i] - 1], t[sa[i] + lcp[i]]) for 1 <= i < n
+	/// \param _sorter3 (i, fp[0, sa[i - 1] + lcp[i] - 1], t[sa[i - 1] + lcp[i]]) for 1 <= i < n
+	/// Each record is followed by the K extra fingerprints of the same prefix.
+	template<uint64 K, typename sorter1_type, typename sorter2_type>
+	void fetch(sorter1_type* _sorter1, sorter2_type* _sorter2, sorter2_type* _sorter3) {
 
-		// sort (sa[i] + lcp[i], i) by i
-		pair1_sorter_type* pair1_sorter = new pair1_sorter_type(pair1_comparator_type(), MAIN_MEM_AVAIL / 4);
-		
-		stxxl::syscall_file* sa_file = new stxxl::syscall_file(m_sa_fn, stxxl::syscall_file::DIRECT | stxxl::syscall_file::RDWR);
+		typedef StreamTypes<K> types;
+
+		// sort (pos, i, stream id) by pos
+		request_sorter_type* request_sorter = new request_sorter_type(request_comparator_type(), MAIN_MEM_AVAIL / 4);
+
+		stxxl::syscall_file* sa_file = new stxxl::syscall_file(m_sa_fn, stxxl::syscall_file::RDWR | stxxl::syscall_file::DIRECT);
 
 		size_vector_type* sa = new size_vector_type(sa_file);
 
 		typename size_vector_type::bufreader_type* sa_reader = new typename size_vector_type::bufreader_type(*sa);
 
-		stxxl::syscall_file* lcp_file = new stxxl::syscall_file(m_lcp_fn, stxxl::syscall_file::DIRECT | stxxl::syscall_file::RDWR);
+		stxxl::syscall_file* lcp_file = new stxxl::syscall_file(m_lcp_fn, stxxl::syscall_file::RDWR | stxxl::syscall_file::DIRECT);
 
 		size_vector_type* lcp = new size_vector_type(lcp_file);
 
 		typename size_vector_type::bufreader_type* lcp_reader = new typename size_vector_type::bufreader_type(*lcp);
 
-		++(*sa_reader), ++(*lcp_reader);
-
-		for (uint64 idx = 1; !sa_reader->empty(); ++(*sa_reader), ++(*lcp_reader), ++idx) {
-
-			pair1_sorter->push(pair1_type(*(*sa_reader) + *(*lcp_reader), idx));
-		}
-
-		delete sa_reader; sa_reader = nullptr;
-
-		delete sa; sa = nullptr;
-
-		delete sa_file; sa_file = nullptr;
-
-		delete lcp_reader; lcp_reader = nullptr;
-		
-		delete lcp; lcp = nullptr;
-
-		delete lcp_file; lcp_file = nullptr;
-
-		pair1_sorter->sort();
+		size_type pre_sa = 0;
 
-		// scan t iteratively to compute fingeprints in need
-		triple_sorter_type* triple_sorter = new triple_sorter_type(triple_comparator_type(), MAIN_MEM_AVAIL / 4);
+		for (uint64 idx = 0; !sa_reader->empty(); ++(*sa_reader), ++(*lcp_reader), ++idx) {
 
-		stxxl::syscall_file* t_file = new stxxl::syscall_file(m_t_fn, stxxl::syscall_file::DIRECT | stxxl::syscall_file::RDWR);
+			const size_type cur_sa = *(*sa_reader), cur_lcp = *(*lcp_reader);
 
-		alphabet_vector_type* t = new alphabet_vector_type(t_file);
-
-		typename alphabet_vector_type::bufreader_type* t_reader = new typename alphabet_vector_type::bufreader_type(*t);
-
-		fpa_type fp = 0;
-
-		uint16 ch;
-
-		for (uint64 pos = 0; !pair1_sorter->empty(); ++(*pair1_sorter)) {
+			request_sorter->push(request_type(to_index<index_type>(cur_sa, m_len), idx + 1, 0));
 
-			const pair1_type& tuple = *(*pair1_sorter);
+			if (idx != 0) { // skip the leftmost lcp
 
-			while (pos != tuple.first) {
+				request_sorter->push(request_type(to_index<index_type>(static_cast<uint64>(cur_sa) + cur_lcp, m_len), idx, 1));
 
-				fp = static_cast<fpa_type>((static_cast<fpb_type>(fp) * R + (*(*t_reader) + 1)) % P); // fp[0, tuple.first - 1]
-
-				++(*t_reader);
-
-				++pos;
+				request_sorter->push(request_type(to_index<index_type>(static_cast<uint64>(pre_sa) + cur_lcp, m_len), idx, 2));
 			}
 
-			ch = (m_len == pos) ? std::numeric_limits<uint16>::max() : (*(*t_reader));
-
-			triple_sorter->push(triple_type(tuple.second, fp, ch));
-		}
-
-		delete t_reader; t_reader = nullptr;
-
-		delete t; t = nullptr;
-
-		delete t_file; t_file = nullptr;
-
-		delete pair1_sorter; pair1_sorter = nullptr;
-
-		triple_sorter->sort();
-
-		return triple_sorter;
-	}
-
-	/// \brief fetch fp[0, sa[i - 1] + lcp[i] - 1] and t[sa[i - 1] + lcp[i]]
-	///
-	triple_sorter_type* fetch_fp_ch_pre() {
-
-		// sort (sa[i - 1] + lcp[i], i) by i
-		pair1_sorter_type* pair1_sorter = new pair1_sorter_type(pair1_comparator_type(), MAIN_MEM_AVAIL / 4);
-		
-		stxxl::syscall_file* sa_file = new stxxl::syscall_file(m_sa_fn, stxxl::syscall_file::DIRECT | stxxl::syscall_file::RDWR);
-
-		size_vector_type* sa = new size_vector_type(sa_file);
-
-		typename size_vector_type::bufreader_type* sa_reader = new typename size_vector_type::bufreader_type(*sa);
-
-		stxxl::syscall_file* lcp_file = new stxxl::syscall_file(m_lcp_fn, stxxl::syscall_file::DIRECT | stxxl::syscall_file::RDWR);
-
-		size_vector_type* lcp = new size_vector_type(lcp_file);
-
-		typename size_vector_type::bufreader_type* lcp_reader = new typename size_vector_type::bufreader_type(*lcp);
-
-		++(*lcp_reader); // skip the leftmost lcp
-
-		for (uint64 idx = 1; !lcp_reader->empty(); ++(*sa_reader), ++(*lcp_reader), ++idx) {
-
-			pair1_sorter->push(pair1_type(*(*sa_reader) + *(*lcp_reader), idx));
+			pre_sa = cur_sa;
 		}
 
 		delete sa_reader; sa_reader = nullptr;
@@ -391,55 +308,50 @@ public:
 
 		delete lcp_file; lcp_file = nullptr;
 
-		pair1_sorter->sort();
+		request_sorter->sort();
 
-		// scan t to iteratively compute fingeprints in need
-		triple_sorter_type* triple_sorter = new triple_sorter_type(triple_comparator_type(), MAIN_MEM_AVAIL / 4);
+		// scan t to iteratively compute fingerprints in need
 
-		stxxl::syscall_file* t_file = new stxxl::syscall_file(m_t_fn, stxxl::syscall_file::DIRECT | stxxl::syscall_file::RDWR);
+		stxxl::syscall_file* t_file = new stxxl::syscall_file(m_t_fn, stxxl::syscall_file::RDWR | stxxl::syscall_file::DIRECT);
 
 		alphabet_vector_type* t = new alphabet_vector_type(t_file);
 
-		typename alphabet_vector_type::bufreader_type* t_reader = new typename alphabet_vector_type::bufreader_type(*t);
-
-		fpa_type fp = 0;
-
-		uint16 ch;
-
-		for (uint64 pos = 0; !pair1_sorter->empty(); ++(*pair1_sorter)) {
-
-			const pair1_type& tuple = *(*pair1_sorter);
-
-			while (pos != tuple.first) {
+		PrefixFingerprint<alphabet_vector_type, fingerprint_type> prefix_fp(*t, m_config, m_checkpoint, m_extra);
 
-				fp = static_cast<fpa_type>((static_cast<fpb_type>(fp) * R + (*(*t_reader) + 1)) % P);
+		prefix_fp.answer(*request_sorter, [&](const request_type& _tuple, const fp_value_type _fp, const alphabet_type _ch) {
 
-				++(*t_reader);
+			if (_tuple.third == 0) {
 
-				++pos;
+				_sorter1->push(typename types::tuple1_type(pair2_type(_tuple.second, _fp), prefix_fp.extra_fp(), m_extra_num));
 			}
+			else {
 
-			ch = (m_len == pos) ? std::numeric_limits<uint16>::max() : (*(*t_reader));
+				uint16 ch = (m_len <= _tuple.first) ? std::numeric_limits<uint16>::max() : _ch;
 
-			triple_sorter->push(triple_type(tuple.second, fp, ch));
-		}
-
-		delete t_reader; t_reader = nullptr;
+				(_tuple.third == 1 ? _sorter2 : _sorter3)->push(typename types::tuple2_type(triple_type(_tuple.second, _fp, ch), prefix_fp.extra_fp(), m_extra_num)); // fp[0, tuple.first - 1]
+			}
+		});
 
 		delete t; t = nullptr;
 
 		delete t_file; t_file = nullptr;
 
-		delete pair1_sorter; pair1_sorter = nullptr;
+		delete request_sorter; request_sorter = nullptr;
+
+		_sorter1->sort();
+
+		_sorter2->sort();
 
-		triple_sorter->sort();
+		_sorter3->sort();
 
-		return triple_sorter;
+		return;
 	}
 
 	/// \brief compare range fingerprints and ending characters to check the result
 	///
-	bool check(pair2_sorter_type* _sorter1, triple_sorter_type* _sorter2, triple_sorter_type* _sorter3) {
+	/// The extra fingerprints are compared only if the main ones are equal.
+	template<typename sorter1_type, typename sorter2_type>
+	bool check(sorter1_type* _sorter1, sorter2_type* _sorter2, sorter2_type* _sorter3) {
 
 		bool isRight = true;
 
@@ -449,29 +361,36 @@ public:
 
 		typename size_vector_type::bufreader_type* lcp_reader = new typename size_vector_type::bufreader_type(*lcp);
 
-		fpa_type fp_ival1, fp_ival2;
+		fp_value_type fp_ival1, fp_ival2;
 
 		uint16 ch1, ch2;
 
 		size_type cur_lcp;
 
+		std::vector<uint64> extra_ival2(m_extra_num);
+
 		++(*lcp_reader); // skip the leftmost lcp value
 
 		cur_lcp = *(*lcp_reader);
 
-		fp_ival2 = static_cast<fpa_type>(((*_sorter3)->second - (static_cast<fpb_type>((*_sorter1)->second) * m_rinterval->compute(cur_lcp)) % P + P) % P);
+		fp_ival2 = fingerprint_type::interval((*_sorter3)->second, (*_sorter1)->second, m_rinterval->compute(cur_lcp));
 
 		ch2 = (*_sorter3)->third;
 
+		for (uint64 j = 0; j < m_extra_num; ++j) {
+
+			extra_ival2[j] = m_extra->interval(j, (*_sorter3)->get_extra(j), (*_sorter1)->get_extra(j), cur_lcp);
+		}
+
 		++(*_sorter3), ++(*_sorter1);
 
 		for (; !_sorter3->empty(); ++(*_sorter3), ++(*_sorter2), ++(*_sorter1)) {
 
-			fp_ival1 = static_cast<fpa_type>(((*_sorter2)->second - (static_cast<fpb_type>((*_sorter1)->second) * m_rinterval->compute(cur_lcp)) % P + P) % P);
+			fp_ival1 = fingerprint_type::interval((*_sorter2)->second, (*_sorter1)->second, m_rinterval->compute(cur_lcp));
 
 			ch1 = (*_sorter2)->third;
 
-			if (fp_ival1 != fp_ival2 || ch1 == ch2) {
+			if (fp_ival1 != fp_ival2 || ch1 == ch2 || !check_extra(*(*_sorter1), *(*_sorter2), cur_lcp, extra_ival2)) {
 			
 				isRight = false;
 
@@ -482,17 +401,22 @@ public:
 
 			cur_lcp = *(*lcp_reader);
 
-			fp_ival2 = static_cast<fpa_type>(((*_sorter3)->second - (static_cast<fpb_type>((*_sorter1)->second) * m_rinterval->compute(cur_lcp)) % P + P) % P);
+			fp_ival2 = fingerprint_type::interval((*_sorter3)->second, (*_sorter1)->second, m_rinterval->compute(cur_lcp));
 
 			ch2 = (*_sorter3)->third;
+
+			for (uint64 j = 0; j < m_extra_num; ++j) {
+
+				extra_ival2[j] = m_extra->interval(j, (*_sorter3)->get_extra(j), (*_sorter1)->get_extra(j), cur_lcp);
+			}
 		}
 
 		// check final pair
-		fp_ival1 = static_cast<fpa_type>(((*_sorter2)->second - (static_cast<fpb_type>((*_sorter1)->second) * m_rinterval->compute(cur_lcp)) % P + P) % P);
+		fp_ival1 = fingerprint_type::interval((*_sorter2)->second, (*_sorter1)->second, m_rinterval->compute(cur_lcp));
 	
 		ch1 = (*_sorter2)->third;
 	
-		if (fp_ival1 != fp_ival2 || ch1 == ch2) {
+		if (fp_ival1 != fp_ival2 || ch1 == ch2 || !check_extra(*(*_sorter1), *(*_sorter2), cur_lcp, extra_ival2)) {
 				
 			isRight = false;
 		}
@@ -506,6 +430,23 @@ public:
 		return isRight;
 	}
 
+	/// \brief compare the extra fingerprints of fp[sa[i], sa[i] + lcp[i] - 1] with those of fp[sa[i - 1], sa[i - 1] + lcp[i] - 1]
+	///
+	/// \param _tuple1 record of fp[0, sa[i] - 1]
+	/// \param _tuple2 record of fp[0, sa[i] + lcp[i] - 1]
+	/// \param _lcp lcp[i]
+	/// \param _extra_ival2 extra fingerprints of fp[sa[i - 1], sa[i - 1] + lcp[i] - 1]
+	template<typename tuple1_type, typename tuple2_type>
+	bool check_extra(const tuple1_type& _tuple1, const tuple2_type& _tuple2, const uint64 _lcp, const std::vector<uint64>& _extra_ival2) const {
+
+		for (uint64 j = 0; j < m_extra_num; ++j) {
+
+			if (m_extra->interval(j, _tuple2.get_extra(j), _tuple1.get_extra(j), _lcp) != _extra_ival2[j]) return false;
+		}
+
+		return true;
+	}
+
 };
 
 #endif // LCPA_EM_H
@@ -1,20 +1,125 @@
 #include "validate4.h"
 
+#include "common/cmdline.h"
+
+#include "common/config.h"
+
+#include "common/uring_io.h"
+
+#include "common/sa_width.h"
+
 char* prog_name;
 
+/// \brief run Validate4 with the given alphabet, SA/LCP element type, tuple index type and fingerprinting backend
+template<typename alphabet_type, typename alphabet_extension_type, typename size_type, typename index_type, typename fingerprint_type>
+bool run_validate4(const std::string& _t_fn, const std::string& _sa_fn, const std::string& _lcp_fn, const Config& _config) {
+
+	std::cerr << "Fingerprint: " << fingerprint_type::name() << std::endl;
+
+	Validate4<alphabet_type, alphabet_extension_type, size_type, index_type, fingerprint_type> validate4(_t_fn, _sa_fn, _lcp_fn, _config);
+
+	return validate4.run();
+}
+
+/// \brief run Validate4 with the given alphabet, SA/LCP element type and tuple index type, the fingerprinting backend is chosen by name
+template<typename alphabet_type, typename alphabet_extension_type, typename size_type, typename index_type>
+bool run_validate4(const std::string& _t_fn, const std::string& _sa_fn, const std::string& _lcp_fn, const std::string& _fp, const Config& _config) {
+
+	if (_fp == PrimeFingerprint::name()) {
+
+		return run_validate4<alphabet_type, alphabet_extension_type, size_type, index_type, PrimeFingerprint>(_t_fn, _sa_fn, _lcp_fn, _config);
+	}
+	
+	if (_fp == MersenneFingerprint::name()) {
+
+		return run_validate4<alphabet_type, alphabet_extension_type, size_type, index_type, MersenneFingerprint>(_t_fn, _sa_fn, _lcp_fn, _config);
+	}
+
+	std::cerr << "Unknown fingerprint: " << _fp << std::endl;
+
+	exit(EXIT_FAILURE);
+}
+
+/// \brief run Validate4 with the given alphabet and SA/LCP element type, the tuple index type is chosen by width in bits, see sa_width.h
+template<typename alphabet_type, typename alphabet_extension_type, typename size_type>
+bool run_validate4(const std::string& _t_fn, const std::string& _sa_fn, const std::string& _lcp_fn, const uint64 _index_width, const std::string& _fp, const Config& _config) {
+
+	if (_index_width == 32) return run_validate4<alphabet_type, alphabet_extension_type, size_type, uint32>(_t_fn, _sa_fn, _lcp_fn, _fp, _config);
+
+	return run_validate4<alphabet_type, alphabet_extension_type, size_type, size_type>(_t_fn, _sa_fn, _lcp_fn, _fp, _config);
+}
+
+/// \brief run Validate4 with the given alphabet, the SA/LCP element type is chosen by width in bits, see sa_width.h
+template<typename alphabet_type, typename alphabet_extension_type>
+bool run_validate4(const std::string& _t_fn, const std::string& _sa_fn, const std::string& _lcp_fn, const uint64 _width, const uint64 _index_width, const std::string& _fp, const Config& _config) {
+
+	switch (_width) {
+
+	case 32: return run_validate4<alphabet_type, alphabet_extension_type, uint32, uint32>(_t_fn, _sa_fn, _lcp_fn, _fp, _config); // the positions are 32-bit as well
+
+	case 48: return run_validate4<alphabet_type, alphabet_extension_type, uint48>(_t_fn, _sa_fn, _lcp_fn, _index_width, _fp, _config);
+
+	case 64: return run_validate4<alphabet_type, alphabet_extension_type, uint64>(_t_fn, _sa_fn, _lcp_fn, _index_width, _fp, _config);
+
+	default: return run_validate4<alphabet_type, alphabet_extension_type, uint40>(_t_fn, _sa_fn, _lcp_fn, _index_width, _fp, _config);
+	}
+}
+
 int main(int argc, char **argv) {
 
-	if (argc != 4) {
+	CmdLine cmdline(argc, argv);
+
+	const bool sa_only = cmdline.has("sa-only");
 
-		std::cerr << "Require 3 arguments: t_file, sa_file and lcp_file\n";
+	if (cmdline.positional_num() != (sa_only ? 2 : 3)) {
+
+		std::cerr << "Require 3 arguments: t_file, sa_file and lcp_file (the output if --build-lcp), or t_file and sa_file if --sa-only\n";
+
+		std::cerr << "Options: --fp=prime31|mersenne61 --threads=N --fp-window=N --fp-batch=N --fp-index[=FILE] --fp-index-step=N --fp-extra=K --fp-seed=S --rmq=auto|stack --alphabet=8|16|32 --bkt-buf=N --concurrent-scan --build-lcp --sa-only --async-io --async-bufs=N --async-buf=N --io-uring --mmap=auto|on|off --width=auto|32|40|48|64\n";
+
+		exit(EXIT_FAILURE);
+	}
+
+	if (sa_only && cmdline.has("build-lcp")) {
+
+		std::cerr << "--sa-only and --build-lcp are exclusive\n";
+
+		exit(EXIT_FAILURE);
 	}
 
 	//
-	std::string t_fn(argv[1]);
+	std::string t_fn(cmdline.positional(0));
+
+	std::string sa_fn(cmdline.positional(1));
+
+	std::string lcp_fn(sa_only ? "" : cmdline.positional(2));
+
+	std::string fp = cmdline.get("fp", PrimeFingerprint::name());
+
+	std::string alphabet = cmdline.get("alphabet", "8"); // bits per character
+
+	if (alphabet != "8" && alphabet != "16" && alphabet != "32") {
+
+		std::cerr << "Unknown alphabet: " << alphabet << std::endl;
 
-	std::string sa_fn(argv[2]);
+		exit(EXIT_FAILURE);
+	}
+
+	Config config(cmdline);
+
+	if (config.mmap_mode != "auto" && config.mmap_mode != "on" && config.mmap_mode != "off") {
 
-	std::string lcp_fn(argv[3]);
+		std::cerr << "Unknown mmap mode: " << config.mmap_mode << std::endl;
+
+		exit(EXIT_FAILURE);
+	}
+
+	std::cerr << "Threads: " << config.thread_num << std::endl;
+
+	if (config.io_uring) {
+
+		std::cerr << "Read backend: " << (utility::io_ring_available() ? "io_uring" : "pread (io_uring not supported)") << std::endl;
+	}
 
 	//
 	stxxl::stats *Stats = stxxl::stats::get_instance();
@@ -24,15 +129,39 @@ int main(int argc, char **argv) {
 	stxxl::block_manager *bm = stxxl::block_manager::get_instance();
 
 	//
-	uint64 len = BasicIO::file_size(t_fn);
+	uint64 len = BasicIO::file_size(t_fn) / (std::stoul(alphabet) / 8);
 
 	std::cerr << "Corpora Size: " << len << std::endl;
 
+	// bits per SA/LCP element, the LCP file to be built is not checked
+	const uint64 width = sa_width(cmdline.get("width", "auto"), sa_fn, config.build_lcp ? "" : lcp_fn, len);
+
+	const uint64 index_width = sa_index_width(width, len); // bits per position in the sorter tuples
+
+	std::cerr << "SA/LCP width: " << width << ", tuple index width: " << index_width << std::endl;
+
 	//
-	Validate4<uint8, uint16, uint40> validate4(t_fn, sa_fn, lcp_fn);
+	bool is_right;
+
+	if (alphabet == "8") {
+
+		is_right = run_validate4<uint8, uint16>(t_fn, sa_fn, lcp_fn, width, index_width, fp, config);
+	}
+	else if (alphabet == "16") {
+
+		is_right = run_validate4<uint16, uint32>(t_fn, sa_fn, lcp_fn, width, index_width, fp, config);
+	}
+	else {
+
+		is_right = run_validate4<uint32, uint64>(t_fn, sa_fn, lcp_fn, width, index_width, fp, config);
+	}
 
 	// check
-	if (false == validate4.run()) {
+	if (config.build_lcp) {
+
+		std::cerr << (is_right ? "build--done\n" : "build--failed\n");
+	}
+	else if (false == is_right) {
 
 		std::cerr << "check--failed\n";
 	}
@@ -45,7 +174,16 @@ int main(int argc, char **argv) {
 	
 	std::cerr << "Peak disk use: " << bm->get_maximum_allocation() << " per character: " << (double)bm->get_maximum_allocation() / len << std::endl;
 
-	std::cerr << "I/O volume: " << Stats->get_written_volume() + Stats->get_read_volume() << " per character: " << ((double) Stats->get_written_volume() + Stats->get_read_volume()) / len << std::endl;		
+	// the streams, the bucket readers and the bucket queues bypass stxxl and count their I/O separately, so do the readers of the mappings
+	const uint64 io_volume = Stats->get_written_volume() + Stats->get_read_volume() + utility::io_read_volume().load() + utility::io_write_volume().load() + utility::mapped_read_volume().load();
+
+	std::cerr << "I/O volume: " << io_volume << " per character: " << (double)io_volume / len << std::endl;
+
+	std::cerr << "I/O volume read outside stxxl: " << utility::io_read_volume().load() << std::endl;
+
+	std::cerr << "I/O volume written outside stxxl: " << utility::io_write_volume().load() << std::endl;
+
+	std::cerr << "I/O volume read from mappings: " << utility::mapped_read_volume().load() << std::endl;
 
 }
 
@@ -8,7 +8,7 @@
 /// This method is also applied to the verification for SA and LCP, where an implementation can be found in validate3.h/validate3.cpp
 /// When finished checking SA_LMS & LCP_LMS, we validate SA & LCP following the idea of the induced-sorting principle and RMQ.
 ///
-/// \note The alphabet size of the input string is assumed to be constant.
+/// \note Buckets are only created for the characters occurring in the input string, which may consist of 8-, 16- or 32-bit integers.
 /// \note A description (with more details) is available in our draft attached.
 /// \author Yi Wu
 /// \date 2017.1 
@@ -19,14 +19,44 @@
 
 #include "common/common.h"
 
+#include "common/fingerprint.h"
+
+#include "common/config.h"
+
+#include "common/prefix_fp.h"
+
+#include "common/multi_fp.h"
+
+#include "common/permute.h"
+
+#include "common/simd_min.h"
+
+#include "common/bucket_reader.h"
+
+#include "common/bucket_queue.h"
+
+#include "common/lce.h"
+
+#include "common/scan_reader.h"
+
+#include "common/scan_writer.h"
+
+#include "common/parallel.h"
+
 #include "common/tuples.h"
 
 #include "common/widget.h"
 
 #include "common/basicio.h"
 
+#include "common/sa_width.h"
+
 #include "test.h"
 
+#include <unordered_map>
+
+#include <chrono>
+
 //#define TEST_VALIDATE4 // for test only, comment out the line if not required
 
 
@@ -36,11 +66,15 @@
 /// \param alphabet_type for elements in T
 /// \param alphabet_extension_type for instance, given alphabet_type = uint8, we have alphbet_extension_type = uint16
 /// \param size_type for elements in SA/LCP
-template<typename alphabet_type, typename alphabet_extension_type, typename size_type>
+/// \param index_type for positions in T and SA carried by the sorter tuples, see common/sa_width.h
+/// \param fingerprint_type fingerprinting backend, see common/fingerprint.h
+template<typename alphabet_type, typename alphabet_extension_type, typename size_type, typename index_type, typename fingerprint_type = PrimeFingerprint>
 class Validate4 {
 
 private:
 
+	typedef typename fingerprint_type::value_type fp_value_type;
+
 	// alias for vectors, tuples, sorters and comparators
 	// vectors
 	typedef typename ExVector<alphabet_type>::vector alphabet_vector_type;
@@ -49,7 +83,7 @@ private:
 
 	// tuples, sorters and comparators
 	//
-	typedef pair<size_type, size_type> pair1_type;
+	typedef pair<index_type, index_type> pair1_type;
 
 	typedef tuple_less_comparator_1st<pair1_type> pair1_less_comparator_1st_type; // compare by 1st component in ascending order
 
@@ -59,19 +93,15 @@ private:
 
 	typedef typename ExTupleSorter<pair1_type, pair1_great_comparator_1st_type>::sorter pair1_great_sorter_1st_type;
 
-	typedef tuple_less_comparator_2nd<pair1_type> pair1_less_comparator_2nd_type; // compare by (1st, 2nd) components in ascending order
-
-	typedef typename ExTupleSorter<pair1_type, pair1_less_comparator_2nd_type>::sorter pair1_less_sorter_2nd_type;
-
 	//
-	typedef pair<size_type, fpa_type> pair2_type;
+	typedef pair<index_type, fp_value_type> pair2_type;
 
 	typedef tuple_less_comparator_1st<pair2_type> pair2_less_comparator_1st_type; // compare by 1st component in ascending order
 
 	typedef typename ExTupleSorter<pair2_type, pair2_less_comparator_1st_type>::sorter pair2_less_sorter_1st_type;
 
 	//
-	typedef pair<size_type, alphabet_type> pair3_type;
+	typedef pair<index_type, alphabet_type> pair3_type;
 
 	typedef tuple_less_comparator_1st<pair3_type> pair3_less_comparator_1st_type; // compare by 1st component in ascending order
 
@@ -82,14 +112,14 @@ private:
 	typedef typename ExVector<pair4_type>::vector pair4_vector_type; //
 
 	//
-	typedef triple<size_type, fpa_type, alphabet_extension_type> triple1_type;
+	typedef triple<index_type, fp_value_type, alphabet_extension_type> triple1_type;
 
 	typedef tuple_less_comparator_1st<triple1_type> triple1_less_comparator_1st_type; // compare by 1st component in ascending order
 
 	typedef typename ExTupleSorter<triple1_type, triple1_less_comparator_1st_type>::sorter triple1_less_sorter_1st_type;
 
 	//
-	typedef triple<size_type, alphabet_type, uint8> triple2_type;
+	typedef triple<index_type, alphabet_type, uint8> triple2_type;
 
 	typedef tuple_less_comparator_1st<triple2_type> triple2_less_comparator_1st_type; // compare by first component in ascending order
 
@@ -100,23 +130,91 @@ private:
 	typedef typename ExTupleSorter<triple2_type, triple2_great_comparator_1st_type>::sorter triple2_great_sorter_1st_type;
 	
 	//
-	typedef triple<size_type, fpa_type, alphabet_extension_type> triple3_type;
+	typedef triple<index_type, fp_value_type, alphabet_extension_type> triple3_type;
+
+	/// \brief output streams of LMSValidate with K extra fingerprints per record, sorted by 1st component in ascending order
+	template<uint64 K>
+	struct StreamTypes {
+
+		typedef ExtraTuple<pair2_type, K> tuple1_type;
+
+		typedef tuple_less_comparator_1st<tuple1_type> comparator1_type;
+
+		typedef typename ExTupleSorter<tuple1_type, comparator1_type>::sorter sorter1_type;
+
+		typedef PermuteBack<tuple1_type> permute1_type; // in-RAM replacement of sorter1_type
+
+		typedef ExtraTuple<triple3_type, K> tuple2_type;
+
+		typedef tuple_less_comparator_1st<tuple2_type> comparator2_type;
+
+		typedef typename ExTupleSorter<tuple2_type, comparator2_type>::sorter sorter2_type;
+
+		typedef PermuteBack<tuple2_type> permute2_type; // in-RAM replacement of sorter2_type
+	};
+
+	//
+	typedef triple<index_type, index_type, uint8> triple4_type;
+
+	typedef tuple_less_comparator_1st<triple4_type> triple4_less_comparator_1st_type; // compare by 1st component in ascending order
+
+	typedef typename ExTupleSorter<triple4_type, triple4_less_comparator_1st_type>::sorter triple4_less_sorter_1st_type;
 
-	typedef tuple_less_comparator_1st<triple3_type> triple3_less_comparator_1st_type; // compare by 1st component in ascending order
+	// (i, T[pos] + 1), 0 if pos reaches the end of T
+	typedef pair<index_type, alphabet_extension_type> pair5_type;
 
-	typedef typename ExTupleSorter<triple3_type, triple3_less_comparator_1st_type>::sorter triple3_less_sorter_1st_type;
+	typedef tuple_less_comparator_1st<pair5_type> pair5_less_comparator_1st_type; // compare by 1st component in ascending order
+
+	typedef typename ExTupleSorter<pair5_type, pair5_less_comparator_1st_type>::sorter pair5_less_sorter_1st_type;
+
+	// (position in SA, expected SA-value, expected LCP-value, what to check), the expected values are compared with the file elements as they are
+	typedef quadruple<index_type, size_type, size_type, uint8> quadruple1_type;
+
+	typedef tuple_less_comparator_1st<quadruple1_type> quadruple1_less_comparator_1st_type; // compare by 1st component in ascending order
+
+	typedef typename ExTupleSorter<quadruple1_type, quadruple1_less_comparator_1st_type>::sorter quadruple1_less_sorter_1st_type;
+
+	/// \brief maximum number of buckets whose induced values are read in place
+	///
+	/// Reading in place costs one SA reader and one LCP reader per bucket.
+	/// Beyond this number, the induced values are validated after the induction instead, see DeferredCheck.
+	static const uint64 MAX_BKT_READER_NUM = 256;
 
 private:
 
-	/// \brief record L-type, S-type and LMS bucket sizes (no matter empty or non-empty) in SA & LCP
+	/// \brief record L-type, S-type and LMS bucket sizes in SA & LCP
 	///
 	/// Elements in SA & LCP are naturally divided into multiple buckets and each bucket contains all the suffixes starting with an identical character.
 	/// Each bucket can be further divided into two parts, whhere the left and right part separately contain the L-type and S-type suffixes, respectively.
 	/// For description convenience, we denote the two part as L-type bucket and S-type bucket, respectively.
+	///
+	/// Only the characters occurring in T own a bucket, and the buckets are indexed by the ranks of their characters among the occurring ones.
+	/// Counts are collected in tables indexed by characters for alphabets of at most 16 bits and in a hash table otherwise.
+	/// Accordingly, a character is mapped to its rank by a direct lookup or by a binary search on the sorted occurring characters.
 	struct BktInfo {
 	public:
 
-		const alphabet_type ch_max; ///< maximum value for alphabet_type
+		/// \brief counters of a character
+		struct BktCount {
+
+			uint64 l_num; ///< number of L-type suffixes
+
+			uint64 s_num; ///< number of S-type suffixes
+
+			uint64 lms_num; ///< number of LMS suffixes
+
+			BktCount() : l_num(0), s_num(0), lms_num(0) {}
+		};
+
+		const bool m_direct; ///< whether or not characters index the tables directly
+
+		std::vector<BktCount> m_direct_count; ///< counters indexed by characters, for alphabets of at most 16 bits
+
+		std::unordered_map<uint64, BktCount> m_sparse_count; ///< counters of the occurring characters, for wider alphabets
+
+		std::vector<alphabet_type> m_ch; ///< occurring characters in ascending order, the i-th owns bucket i
+
+		std::vector<uint32> m_rank; ///< bucket of each character, for alphabets of at most 16 bits
 
 		std::vector<uint64> m_bkt_size; ///< bucket size
 
@@ -130,23 +228,23 @@ private:
 
 		/// \brief ctor
 		///
-		///  the number of buckets is ch_max + 1, indexed by 0, 1, ..., ch_max.
-		BktInfo() : ch_max(std::numeric_limits<alphabet_type>::max()) {
-
-			m_bkt_size.resize(ch_max + 1, 0);
+		BktInfo() : m_direct(sizeof(alphabet_type) <= 2) {
 
-			m_l_bkt_size.resize(ch_max + 1, 0);
+			if (m_direct) m_direct_count.resize(static_cast<uint64>(std::numeric_limits<alphabet_type>::max()) + 1);
+		}
 
-			m_s_bkt_size.resize(ch_max + 1, 0);
+		/// \brief counters of the specified character
+		///
+		BktCount& count(const alphabet_type _ch) {
 
-			m_lms_bkt_size.resize(ch_max + 1, 0);
+			return m_direct ? m_direct_count[_ch] : m_sparse_count[_ch];
 		}
 
 		/// \brief count the number of L-type suffixes in the specified bucket
 		///
 		void add_l(const alphabet_type _ch) {
 
-			++m_l_bkt_size[_ch];
+			++count(_ch).l_num;
 
 			return;
 		}
@@ -155,7 +253,7 @@ private:
 		///
 		void add_s(const alphabet_type _ch) {
 
-			++m_s_bkt_size[_ch];
+			++count(_ch).s_num;
 
 			return;
 		}
@@ -164,81 +262,147 @@ private:
 		///
 		void add_lms(const alphabet_type _ch) {
 
-			++m_lms_bkt_size[_ch];
+			++count(_ch).lms_num;
 
 			return;
 		}
 
-		/// \brief collect the number of suffixes in the specified bucket
+		/// \brief assign buckets to the occurring characters and collect the number of suffixes in each bucket
 		///
 		/// the number of suffixes in a bucket can be obtained by summing up the numbers of L-type and S-type suffixes. 
 		void accumulate() {
 
-			for (alphabet_extension_type ch = 0; ch <= ch_max; ++ch) {
+			if (m_direct) {
+
+				m_rank.resize(m_direct_count.size(), 0);
+
+				for (uint64 ch = 0; ch < m_direct_count.size(); ++ch) {
+
+					if (m_direct_count[ch].l_num + m_direct_count[ch].s_num != 0) {
+
+						m_rank[ch] = static_cast<uint32>(m_ch.size());
+
+						m_ch.push_back(static_cast<alphabet_type>(ch));
+					}
+				}
+			}
+			else {
+
+				for (typename std::unordered_map<uint64, BktCount>::const_iterator it = m_sparse_count.begin(); it != m_sparse_count.end(); ++it) {
+
+					m_ch.push_back(static_cast<alphabet_type>(it->first));
+				}
+
+				std::sort(m_ch.begin(), m_ch.end());
+			}
+
+			m_bkt_size.resize(m_ch.size());
+
+			m_l_bkt_size.resize(m_ch.size());
+
+			m_s_bkt_size.resize(m_ch.size());
+
+			m_lms_bkt_size.resize(m_ch.size());
+
+			for (uint64 bkt = 0; bkt < m_ch.size(); ++bkt) {
+
+				const BktCount& cnt = count(m_ch[bkt]);
 
-				m_bkt_size[ch] = m_l_bkt_size[ch] + m_s_bkt_size[ch];
+				m_l_bkt_size[bkt] = cnt.l_num;
+
+				m_s_bkt_size[bkt] = cnt.s_num;
+
+				m_lms_bkt_size[bkt] = cnt.lms_num;
+
+				m_bkt_size[bkt] = cnt.l_num + cnt.s_num;
 			}
 
+			// counters are no longer needed
+			std::vector<BktCount>().swap(m_direct_count);
+
+			std::unordered_map<uint64, BktCount>().swap(m_sparse_count);
+
 			return;
 		}
 
+		/// \brief return the number of buckets
+		///
+		uint64 get_bkt_num() const {
+
+			return m_ch.size();
+		}
+
+		/// \brief return the bucket of the specified character, which must occur in T
+		///
+		uint64 get_bkt(const alphabet_type _ch) const {
+
+			if (m_direct) return m_rank[_ch];
+
+			return std::lower_bound(m_ch.begin(), m_ch.end(), _ch) - m_ch.begin();
+		}
+
 		/// \brief return the number of L-type suffixes in the specified bucket
 		///
-		uint64 get_l_bkt_size(const alphabet_type _ch) const{
+		uint64 get_l_bkt_size(const uint64 _bkt) const{
 
-			return m_l_bkt_size[_ch];
+			return m_l_bkt_size[_bkt];
 		}
 
 		/// \brief return the number of S-type suffixes in the specified bucket
 		///
-		uint64 get_s_bkt_size(const alphabet_type _ch) const{
+		uint64 get_s_bkt_size(const uint64 _bkt) const{
 
-			return m_s_bkt_size[_ch];
+			return m_s_bkt_size[_bkt];
 		}
 
 		/// \brief return the number of LMS suffixes in the specified bucket
 		///
-		uint64 get_lms_bkt_size(const alphabet_type _ch) const{
+		uint64 get_lms_bkt_size(const uint64 _bkt) const{
 
-			return m_lms_bkt_size[_ch];
+			return m_lms_bkt_size[_bkt];
 		}
 
 		/// \brief return the number of suffixes in the specified bucket
 		///
-		uint64 get_bkt_size(const alphabet_type _ch) const {
+		uint64 get_bkt_size(const uint64 _bkt) const {
 
-			return m_bkt_size[_ch];
+			return m_bkt_size[_bkt];
 		}
 
+		/// \brief print the bucket sizes, one line per bucket only for small alphabets
 		void display() const{
 
 			uint64 total_num = 0;
 
 			uint64 total_l_num = 0, total_s_num = 0, total_lms_num = 0;
 
-			for (alphabet_extension_type ch = 0; ch <= ch_max; ++ch) {
+			for (uint64 bkt = 0; bkt < m_ch.size(); ++bkt) {
 
-				std::cerr << "ch: " << static_cast<uint64>(ch) << " ";
+				if (m_ch.size() <= MAX_BKT_READER_NUM) {
 
-				std::cerr << "size: " << m_bkt_size[ch] << " ";
+					std::cerr << "ch: " << static_cast<uint64>(m_ch[bkt]) << " ";
 
-				std::cerr << "L-type: " << m_l_bkt_size[ch] << " ";
+					std::cerr << "size: " << m_bkt_size[bkt] << " ";
 
-				std::cerr << "S-type : " << m_s_bkt_size[ch] << " ";
+					std::cerr << "L-type: " << m_l_bkt_size[bkt] << " ";
 
-				std::cerr << "LMS: " << m_lms_bkt_size[ch];
+					std::cerr << "S-type : " << m_s_bkt_size[bkt] << " ";
 
-				std::cerr << std::endl;
+					std::cerr << "LMS: " << m_lms_bkt_size[bkt];
+
+					std::cerr << std::endl;
+				}
 
-				total_num += m_bkt_size[ch];
+				total_num += m_bkt_size[bkt];
 
-				total_l_num += m_l_bkt_size[ch];
+				total_l_num += m_l_bkt_size[bkt];
 
-				total_s_num += m_s_bkt_size[ch];
+				total_s_num += m_s_bkt_size[bkt];
 
-				total_lms_num += m_lms_bkt_size[ch];
+				total_lms_num += m_lms_bkt_size[bkt];
 			}
 
+			std::cerr << "bucket num: " << m_ch.size() << std::endl;
 
 			std::cerr << "total num: " << total_num << std::endl;
 	
@@ -263,74 +427,31 @@ private:
 
 	private:
 
-		/// \brief store (R % P)^1, (R % P)^2, (R % P)^4, ...
-		///
-		struct RInterval {
-
-			fpa_type* m_data; ///< data load
-
-			uint64 m_num;
-
-			/// \brief ctor
-			///
-			RInterval(uint64 _len) {
-
-				m_num = 1;
-
-				while (_len) {
-
-					++m_num;
-
-					_len /= 2;
-				}
-
-				m_data = new fpa_type[m_num];
-
-				m_data[0] = R % P;
-
-				for (uint64 i = 1; i < m_num; ++i) {
-
-					m_data[i] = static_cast<fpa_type>((static_cast<fpb_type>(m_data[i - 1]) * m_data[i - 1]) % P);
-				}
-
-				return;
-			}
-
-			/// \brief get fpInterval
-			///
-			fpa_type compute(uint64 _interval) {
-
-				fpa_type ret = 1;
-
-				for (uint64 i = 0; i < m_num; ++i) {
+		alphabet_vector_type* m_t; ///< input string
 
-					if (_interval % 2) {
+		size_vector_type* m_sa; ///< input suffix array
 
-						ret = static_cast<fpa_type>((static_cast<fpb_type>(ret) * m_data[i]) % P);
-					}
+		size_vector_type* m_lcp; ///< input LCP array
 
-					_interval = _interval / 2;
+		uint64 m_len; ///< length of input string
 
-					if (_interval == 0) break;
-				}
+		uint64 m_lms_num; ///< number of LMS suffixes
 
-				return ret;
-			}
-		};
+		pair1_less_sorter_1st_type* m_lms_sorter; ///< (i, SA[i]) for the LMS suffixes sorted by i
 
-	private:
+		RInterval<fingerprint_type>* m_rinterval; ///< pointer to an RInterval object
 
-		alphabet_vector_type* m_t; ///< input string
+		const Config& m_config; ///< run-time settings
 
-		size_vector_type* m_sa; ///< input suffix array
+		std::string m_lcp_fn; ///< LCP file, read by an asynchronous stream if required
 
-		size_vector_type* m_lcp; ///< input LCP array
+		TmpFilePool* m_tmp_pool; ///< files of SA_LMS and LCP_LMS if written asynchronously, nullptr if not used
 
-		uint64 m_len; ///< length of input string
+		FingerprintCheckpoint<alphabet_vector_type, fingerprint_type>* m_checkpoint; ///< sampled prefix fingerprints, nullptr if not used
 
-		uint64 m_lms_num; ///< number of LMS suffixes
+		MultiFingerprint* m_extra; ///< extra fingerprints, nullptr if not used
 
-		RInterval* m_rinterval; ///< pointer to an RInterval object
+		uint64 m_extra_num; ///< number of extra fingerprints
 
 		size_vector_type* m_sa_lms; ///< pointer to SA_LMS
 
@@ -343,113 +464,51 @@ private:
 	public:
 		/// \brief ctor
 		///
-		LMSValidate(alphabet_vector_type* _t, size_vector_type* _sa, size_vector_type* _lcp) :
+		/// \param _lms_sorter (i, SA[i]) for the LMS suffixes sorted by i, produced by RetrievePre
+		/// \param _lms_num number of LMS suffixes
+		/// \param _lcp_fn LCP file mapped by _lcp
+		/// \param _tmp_pool files of SA_LMS and LCP_LMS if written asynchronously, nullptr if not used
+		LMSValidate(alphabet_vector_type* _t, size_vector_type* _sa, size_vector_type* _lcp, pair1_less_sorter_1st_type* _lms_sorter, const uint64 _lms_num, const std::string& _lcp_fn, TmpFilePool* _tmp_pool, const Config& _config) :
 			m_t(_t), 
 			m_sa(_sa), 
 			m_lcp(_lcp), 
 			m_len(m_t->size()), 
-			m_lms_num(0), 
+			m_lms_num(_lms_num), 
+			m_lms_sorter(_lms_sorter), 
+			m_config(_config), 
+			m_lcp_fn(_lcp_fn), 
+			m_tmp_pool(_tmp_pool), 
 			m_sa_lms(nullptr), 
 			m_lcp_lms(nullptr), 
 			ch_max(std::numeric_limits<alphabet_type>::max()), 
 			val_max(std::numeric_limits<size_type>::max()) {
 
-			m_rinterval = new RInterval(m_len);
+			m_rinterval = new RInterval<fingerprint_type>(m_len);
+
+			m_checkpoint = m_config.fp_index_fn.empty() ? nullptr : new FingerprintCheckpoint<alphabet_vector_type, fingerprint_type>(m_len, m_config.fp_index_fn, m_config.fp_index_step, m_config.t_fn);
+
+			m_extra_num = m_config.fp_extra_num;
+
+			m_extra = (m_extra_num == 0) ? nullptr : new MultiFingerprint(m_extra_num, m_config.fp_seed, m_len);
 		}
 
 		/// \brief retrive SA_LMS and LCP_LMS from SA and LCP
 		///
+		/// The LMS suffixes are selected by RetrievePre, which sorts the inverse SA and classifies the suffixes in a single leftward scan of T.
 		void retrieve_lms() {
 
-			// step 1: sort (SA[i], i) by 1st component in descending order
-			pair1_great_sorter_1st_type* pair1_great_sorter = new pair1_great_sorter_1st_type(pair1_great_comparator_1st_type(), MAIN_MEM_AVAIL / 2);
-
-			typename size_vector_type::bufreader_type* sa_reader = new typename size_vector_type::bufreader_type(*m_sa);
-
-			for (uint64 idx = 1; !sa_reader->empty(); ++idx, ++(*sa_reader)) {
-
-				pair1_great_sorter->push(pair1_type(*(*sa_reader), idx));
-			}
-
-			delete sa_reader; sa_reader = nullptr;
-
-			pair1_great_sorter->sort();
-
-			// step 2: scan T leftward to determine character type and pick LMS suffixes
-			pair1_less_sorter_1st_type* pair1_less_sorter = new pair1_less_sorter_1st_type(pair1_less_comparator_1st_type(), MAIN_MEM_AVAIL / 2);
-
-			typename alphabet_vector_type::bufreader_reverse_type* t_rev_reader = new typename alphabet_vector_type::bufreader_reverse_type(*m_t);
-
-			uint8 last_scanned_type, cur_scanned_type;
-
-			alphabet_type last_scanned_ch, cur_scanned_ch;
-
-			uint64 pos = m_len - 1;
-
-			// rightmost character is L_TYPE
-			cur_scanned_type = L_TYPE, cur_scanned_ch = *(*t_rev_reader);			
-
-			last_scanned_type = cur_scanned_type, last_scanned_ch = cur_scanned_ch;
-
-			++(*t_rev_reader);
-
-			for (; !t_rev_reader->empty(); --pos, ++(*t_rev_reader), ++(*pair1_great_sorter)) { // process the remaining, check if last scanned is LMS
-			
-				const pair1_type& tuple = *(*pair1_great_sorter); // for the last scanned suffix
-
-				if (pos != tuple.first) {
-				
-					std::cerr << "SA is not a permutation\n";
-
-					exit(0);
-				}
-
-				cur_scanned_ch = *(*t_rev_reader);
-
-				cur_scanned_type = ((cur_scanned_ch < last_scanned_ch) || (cur_scanned_ch == last_scanned_ch && last_scanned_type == S_TYPE)) ? S_TYPE : L_TYPE;
-
-				if (cur_scanned_type == L_TYPE && last_scanned_type == S_TYPE) { // last scanned is LMS
-
-					++m_lms_num;
-
-					pair1_less_sorter->push(pair1_type(tuple.second, tuple.first)); // push the last scanned
-				}
-
-				last_scanned_ch = cur_scanned_ch;
-
-				last_scanned_type = cur_scanned_type;
-			}
-
-			// leftmost
-			if (pos != (*pair1_great_sorter)->first) {
-
-				std::cerr << "SA is not a permutation\n";
-
-				exit(0);
-			}
-
-			++(*pair1_great_sorter);
-
-			delete t_rev_reader; t_rev_reader = nullptr;
-
-			delete pair1_great_sorter; pair1_great_sorter = nullptr;
-
-			pair1_less_sorter->sort();
-
 #ifdef TEST_VALIDATE4
 			std::cerr << "m_lms_num: " << m_lms_num << std::endl;
 #endif
 
-			// step 3: compute LCP_LMS and redirect SA_LMS & LCP_LMS to the external files
-			typename size_vector_type::bufreader_type* lcp_reader = new typename size_vector_type::bufreader_type(*m_lcp);
-
-			m_sa_lms = new size_vector_type(); m_sa_lms->resize(m_lms_num);
+			pair1_less_sorter_1st_type* pair1_less_sorter = m_lms_sorter;
 
-			typename size_vector_type::bufwriter_type* sa_lms_writer = new typename size_vector_type::bufwriter_type(*m_sa_lms);
+			// compute LCP_LMS and redirect SA_LMS & LCP_LMS to the external files
+			ScanReader<size_vector_type>* lcp_reader = new ScanReader<size_vector_type>(*m_lcp, m_lcp_fn, m_config);
 
-			m_lcp_lms = new size_vector_type(); m_lcp_lms->resize(m_lms_num);
+			ScanWriter<size_vector_type>* sa_lms_writer = new ScanWriter<size_vector_type>(m_lms_num, m_tmp_pool, m_config);
 
-			typename size_vector_type::bufwriter_type* lcp_lms_writer = new typename size_vector_type::bufwriter_type(*m_lcp_lms);
+			ScanWriter<size_vector_type>* lcp_lms_writer = new ScanWriter<size_vector_type>(m_lms_num, m_tmp_pool, m_config);
 
 			size_type lcp_min = 0; // the leftmost LMS in SA_LMS has no left neighbor, set lcp_min = 0 to let the LCP-value be 0
 
@@ -477,9 +536,9 @@ private:
 				lcp_min = val_max;
 			}
 
-			(*sa_lms_writer).finish();
+			m_sa_lms = sa_lms_writer->finish();
 
-			(*lcp_lms_writer).finish();
+			m_lcp_lms = lcp_lms_writer->finish();
 
 			delete sa_lms_writer; sa_lms_writer = nullptr;
 
@@ -487,224 +546,177 @@ private:
 
 			delete lcp_reader; lcp_reader = nullptr;
 
-			delete pair1_less_sorter; pair1_less_sorter = nullptr;
-
 			return;
 		}
 
-		/// \brief fetch fp[0, SA_LMS[i] - 1]
+		/// \brief fetch fp[0, SA_LMS[i] - 1], fp[0, SA_LMS[i] + LCP_LMS[i] - 1] & T[SA_LMS[i] + LCP_LMS[i]] and fp[0, SA_LMS[i - 1] + LCP_LMS[i] - 1] & T[SA_LMS[i - 1] + LCP_LMS[i]]
 		///
-		pair2_less_sorter_1st_type* fetch_fp() {
-
-			// produce ISA_LMS
-			pair1_less_sorter_1st_type* pair1_less_sorter = new pair1_less_sorter_1st_type(pair1_less_comparator_1st_type(), MAIN_MEM_AVAIL / 4);
-
-			typename size_vector_type::bufreader_type* sa_lms_reader = new typename size_vector_type::bufreader_type(*m_sa_lms);
-
-			for (uint64 idx = 1; !sa_lms_reader->empty(); ++idx, ++(*sa_lms_reader)) {
-
-				pair1_less_sorter->push(pair1_type(*(*sa_lms_reader), idx));
-			}
-
-			delete sa_lms_reader; sa_lms_reader = nullptr;
-
-			pair1_less_sorter->sort();
-
-			// scan T to iteratively compute fp[0, pos] and sort ISA_LMS back to SA_LMS along with the fingerprints in need
-			pair2_less_sorter_1st_type* pair2_less_sorter = new pair2_less_sorter_1st_type(pair2_less_comparator_1st_type(), MAIN_MEM_AVAIL / 4);
-
-			typename alphabet_vector_type::bufreader_type* t_reader = new typename alphabet_vector_type::bufreader_type(*m_t);
-
-			fpa_type fp = 0;
-
-			for (uint64 pos = 0; !pair1_less_sorter->empty(); ++(*pair1_less_sorter)) {
-
-				const pair1_type& tuple = *(*pair1_less_sorter);
-
-				while (pos != tuple.first) {
-
-					fp = static_cast<fpa_type>((static_cast<fpb_type>(fp) * R + (*(*t_reader) + 1)) % P); // plus 1 to avoid equal to 0
-
-					++(*t_reader), ++pos;
-				} 
-
-				pair2_less_sorter->push(pair2_type(tuple.second, fp));
-
-				fp = static_cast<fpa_type>((static_cast<fpb_type>(fp) * R + (*(*t_reader) + 1)) % P); // plus 1 to avoid equal to 0
+		/// The requests of the three kinds are tagged with their stream ids and sorted together, such that they are answered in a single scan of T.
+		///
+		/// \param _sorter1 (i, fp[0, SA_LMS[i] - 1]), where i starts from 1
+		/// \param _sorter2 (i, fp[0, SA_LMS[i] + LCP_LMS[i] - 1], T[SA_LMS[i] + LCP_LMS[i]]) for i >= 1
+		/// \param _sorter3 (i, fp[0, SA_LMS[i - 1] + LCP_LMS[i] - 1], T[SA_LMS[i - 1] + LCP_LMS[i]]) for i >= 1
+		/// Each record is followed by the K extra fingerprints of the same prefix.
+		template<uint64 K, typename sorter1_type, typename sorter2_type>
+		void fetch(sorter1_type* _sorter1, sorter2_type* _sorter2, sorter2_type* _sorter3) {
 
-				++(*t_reader), ++pos;				
-			}
+			typedef StreamTypes<K> types;
 
-			delete t_reader; t_reader = nullptr;
+			// sort (pos, i, stream id) by pos
+			triple4_less_sorter_1st_type* triple4_less_sorter = new triple4_less_sorter_1st_type(triple4_less_comparator_1st_type(), MAIN_MEM_AVAIL / 4);
 
-			delete pair1_less_sorter; pair1_less_sorter = nullptr;
+			typename size_vector_type::bufreader_type* sa_lms_reader = new typename size_vector_type::bufreader_type(*m_sa_lms);
 
-			pair2_less_sorter->sort();
+			typename size_vector_type::bufreader_type* lcp_lms_reader = new typename size_vector_type::bufreader_type(*m_lcp_lms);
 
-			return pair2_less_sorter;
-		}
+			size_type pre_sa = 0;
 
-		/// \brief fetch fp[0, SA_LMS[i] + LCP_LMS[i] - 1] and T[SA_LMS[i] + LCP_LMS[i]]
-		///
-		triple3_less_sorter_1st_type* fetch_fp_ch_cur() {
+			for (uint64 idx = 0; !sa_lms_reader->empty(); ++idx, ++(*sa_lms_reader), ++(*lcp_lms_reader)) {
 
-			// sort (SA_LMS[i] + LCP_LMS[i], i) by the components 
-			pair1_less_sorter_2nd_type* pair1_less_2nd_sorter = new pair1_less_sorter_2nd_type(pair1_less_comparator_2nd_type(), MAIN_MEM_AVAIL / 4);
+				const size_type cur_sa = *(*sa_lms_reader), cur_lcp = *(*lcp_lms_reader);
 
-			typename size_vector_type::bufreader_type* sa_lms_reader = new typename size_vector_type::bufreader_type(*m_sa_lms);
+				triple4_less_sorter->push(triple4_type(cur_sa, idx + 1, 0));
 
-			typename size_vector_type::bufreader_type* lcp_lms_reader = new typename size_vector_type::bufreader_type(*m_lcp_lms);
+				if (idx != 0) { // skip the leftmost LCP-value
 
-			++(*sa_lms_reader), ++(*lcp_lms_reader); // skip the leftmost 
+					triple4_less_sorter->push(triple4_type(to_index<index_type>(static_cast<uint64>(cur_sa) + cur_lcp, m_len), idx, 1));
 
-			for (uint64 idx = 1; !sa_lms_reader->empty(); ++idx, ++(*sa_lms_reader), ++(*lcp_lms_reader)) {
+					triple4_less_sorter->push(triple4_type(to_index<index_type>(static_cast<uint64>(pre_sa) + cur_lcp, m_len), idx, 2));
+				}
 
-				pair1_less_2nd_sorter->push(pair1_type(*(*sa_lms_reader) + *(*lcp_lms_reader), idx));
+				pre_sa = cur_sa;
 			}
 
 			delete sa_lms_reader; sa_lms_reader = nullptr;
 
 			delete lcp_lms_reader; lcp_lms_reader = nullptr;
 
-			pair1_less_2nd_sorter->sort();
+			triple4_less_sorter->sort();
 
-			// scan T to iteratively compute fp[0, pos] and sort ISA_LMS back to SA_LMS along with the fingerprints in need
-			triple3_less_sorter_1st_type* triple3_less_sorter = new triple3_less_sorter_1st_type(triple3_less_comparator_1st_type(), MAIN_MEM_AVAIL / 4);
+			// scan T to iteratively compute fp[0, pos] and sort the fingerprints in need back to the order of SA_LMS
 
-			typename alphabet_vector_type::bufreader_type* t_reader = new typename alphabet_vector_type::bufreader_type(*m_t);
+			PrefixFingerprint<alphabet_vector_type, fingerprint_type> prefix_fp(*m_t, m_config, m_checkpoint, m_extra);
 
-			fpa_type fp = 0;
+			prefix_fp.answer(*triple4_less_sorter, [&](const triple4_type& _tuple, const fp_value_type _fp, const alphabet_type _ch) {
 
-			for (uint64 pos = 0; !t_reader->empty(); ++pos, ++(*t_reader)) {
-			
-				while (!pair1_less_2nd_sorter->empty() && pos == (*pair1_less_2nd_sorter)->first) {
-				
-					triple3_less_sorter->push(triple3_type((*pair1_less_2nd_sorter)->second, fp, *(*t_reader))); //fp = FP[0, pos - 1], ch = T[pos]
+				if (_tuple.third == 0) {
 
-					++(*pair1_less_2nd_sorter);
+					_sorter1->push(typename types::tuple1_type(pair2_type(_tuple.second, _fp), prefix_fp.extra_fp(), m_extra_num));
 				}
+				else if (_tuple.first < m_len) {
 
-				if (pair1_less_2nd_sorter->empty()) {
-
-					break;		
+					(_tuple.third == 1 ? _sorter2 : _sorter3)->push(typename types::tuple2_type(triple3_type(_tuple.second, _fp, _ch), prefix_fp.extra_fp(), m_extra_num)); // fp = FP[0, pos - 1], ch = T[pos]
 				}
+				else {
 
-				fp = static_cast<fpa_type>((static_cast<fpb_type>(fp) * R + (*(*t_reader) + 1)) % P); // plus 1 to avoid equal to 0
-			}
-
-			// (*pair1_less_2nd_sorter)->second == m_len
-			while (!pair1_less_2nd_sorter->empty()) {
-			
-				triple3_less_sorter->push(triple3_type((*pair1_less_2nd_sorter)->second, fp, ch_max + 1)); // fp = FP[0, m_len - 1], ch = max + 1
+					(_tuple.third == 1 ? _sorter2 : _sorter3)->push(typename types::tuple2_type(triple3_type(_tuple.second, _fp, ch_max + 1), prefix_fp.extra_fp(), m_extra_num)); // fp = FP[0, m_len - 1], ch = max + 1
+				}
+			});
 
-				++(*pair1_less_2nd_sorter);
-			}
+			delete triple4_less_sorter; triple4_less_sorter = nullptr;
 
-			delete t_reader; t_reader = nullptr;
+			_sorter1->sort();
 
-			delete pair1_less_2nd_sorter; pair1_less_2nd_sorter = nullptr;
+			_sorter2->sort();
 
-			triple3_less_sorter->sort();
+			_sorter3->sort();
 
-			return triple3_less_sorter;
+			return;
 		}
 
-		/// \brief fetch fp[0, SA_LMS[i] + LCP_LMS[i + 1] - 1] and T[SA_LMS[i] + LCP_LMS[i + 1]]
-		///
-		triple3_less_sorter_1st_type* fetch_fp_ch_pre() {
-
-			// sort (SA_LMS[i] + LCP_LMS[i + 1], i) by the components 
-			pair1_less_sorter_2nd_type* pair1_less_2nd_sorter = new pair1_less_sorter_2nd_type(pair1_less_comparator_2nd_type(), MAIN_MEM_AVAIL / 4);
-
-			typename size_vector_type::bufreader_type* sa_lms_reader = new typename size_vector_type::bufreader_type(*m_sa_lms);
-
-			typename size_vector_type::bufreader_type* lcp_lms_reader = new typename size_vector_type::bufreader_type(*m_lcp_lms);
-
-			++(*lcp_lms_reader); // only skip the leftmost LCP-value
-
-			for (uint64 idx = 1; !lcp_lms_reader->empty(); ++idx, ++(*sa_lms_reader), ++(*lcp_lms_reader)) {
-
-				pair1_less_2nd_sorter->push(pair1_type(*(*sa_lms_reader) + *(*lcp_lms_reader), idx));
-			}
+		/// \brief steps 2-3 with K extra fingerprints in the records of the output streams
+		template<uint64 K>
+		bool run_streams() {
 
-			delete sa_lms_reader; sa_lms_reader = nullptr;
+			typedef StreamTypes<K> types;
 
-			delete lcp_lms_reader; lcp_lms_reader = nullptr;
+			const uint64 sorter_mem = MAIN_MEM_AVAIL / 4;
 
-			pair1_less_2nd_sorter->sort();
+			bool res;
 
-			// scan T to iteratively compute fp[0, pos] and sort ISA_LMS back to SA_LMS along with the fingerprints in need
-			triple3_less_sorter_1st_type* triple3_less_sorter = new triple3_less_sorter_1st_type(triple3_less_comparator_1st_type(), MAIN_MEM_AVAIL / 4);
+			if (types::permute1_type::memory(m_lms_num) + 2 * types::permute2_type::memory(m_lms_num) <= 3 * sorter_mem) { // permute the output streams back in RAM
 
-			typename alphabet_vector_type::bufreader_type* t_reader = new typename alphabet_vector_type::bufreader_type(*m_t);
+				typename types::permute1_type* sorter1 = new typename types::permute1_type(m_lms_num, 1);
 
-			fpa_type fp = 0;
+				typename types::permute2_type* sorter2 = new typename types::permute2_type(m_lms_num, 1), *sorter3 = new typename types::permute2_type(m_lms_num, 1);
 
-			for (uint64 pos = 0; !t_reader->empty(); ++pos, ++(*t_reader)) {
+				res = fetch_and_check<K>(sorter1, sorter2, sorter3);
 
-				while (!pair1_less_2nd_sorter->empty() && pos == (*pair1_less_2nd_sorter)->first) {
+				delete sorter1; sorter1 = nullptr;
 
-					triple3_less_sorter->push(triple3_type((*pair1_less_2nd_sorter)->second, fp, *(*t_reader)));
+				delete sorter2; sorter2 = nullptr;
 
-					++(*pair1_less_2nd_sorter);
-				}
+				delete sorter3; sorter3 = nullptr;
+			}
+			else { // sort the output streams back in external memory
 
-				if (pair1_less_2nd_sorter->empty()) {
+				typename types::sorter1_type* sorter1 = new typename types::sorter1_type(typename types::comparator1_type(), sorter_mem);
 
-					break;
-				}
+				typename types::sorter2_type* sorter2 = new typename types::sorter2_type(typename types::comparator2_type(), sorter_mem), *sorter3 = new typename types::sorter2_type(typename types::comparator2_type(), sorter_mem);
 
-				fp = static_cast<fpa_type>((static_cast<fpb_type>(fp) * R + (*(*t_reader) + 1)) % P); // plus 1 to avoid equal to 0
-			}
+				res = fetch_and_check<K>(sorter1, sorter2, sorter3);
 
-			// (*pair1_less_2nd_sorter)->second == m_len
-			while (!pair1_less_2nd_sorter->empty()) {
+				delete sorter1; sorter1 = nullptr;
 
-				triple3_less_sorter->push(triple3_type((*pair1_less_2nd_sorter)->second, fp, ch_max + 1));
+				delete sorter2; sorter2 = nullptr;
 
-				++(*pair1_less_2nd_sorter);
+				delete sorter3; sorter3 = nullptr;
 			}
 
-			delete t_reader; t_reader = nullptr;
+			return res;
+		}
 
-			delete pair1_less_2nd_sorter; pair1_less_2nd_sorter = nullptr;
+		/// \brief steps 2-3 given the output streams, either stxxl sorters or PermuteBack objects
+		template<uint64 K, typename sorter1_type, typename sorter2_type>
+		bool fetch_and_check(sorter1_type* _sorter1, sorter2_type* _sorter2, sorter2_type* _sorter3) {
 
-			triple3_less_sorter->sort();
+			// step 2: fetch fp[0, SA_LMS[i] - 1], fp[0, SA_LMS[i] + LCP_LMS[i] - 1] and fp[0, SA_LMS[i] + LCP_LMS[i + 1] - 1] in a single scan of T
+			fetch<K>(_sorter1, _sorter2, _sorter3);
 
-			return triple3_less_sorter;
+			// step 3: check 
+			return check(_sorter1, _sorter2, _sorter3);
 		}
 
 		/// \brief check the result
 		///
-		bool check(pair2_less_sorter_1st_type* _sorter1, triple3_less_sorter_1st_type* _sorter2, triple3_less_sorter_1st_type* _sorter3) {
+		/// The extra fingerprints are compared only if the main ones are equal.
+		template<typename sorter1_type, typename sorter2_type>
+		bool check(sorter1_type* _sorter1, sorter2_type* _sorter2, sorter2_type* _sorter3) {
 		
 			bool is_right = true;
 
 			typename size_vector_type::bufreader_type* lcp_lms_reader = new typename size_vector_type::bufreader_type(*m_lcp_lms);
 
-			fpa_type fp_ival1, fp_ival2;
+			fp_value_type fp_ival1, fp_ival2;
 
 			alphabet_extension_type ch1, ch2;
 
 			size_type cur_lcp;
 
+			std::vector<uint64> extra_ival2(m_extra_num);
+
 			++(*lcp_lms_reader); // skip the leftmost lcp-value
 
 			cur_lcp = *(*lcp_lms_reader);
 
-			fp_ival2 = static_cast<fpa_type>(((*_sorter3)->second - (static_cast<fpb_type>((*_sorter1)->second) * m_rinterval->compute(cur_lcp)) % P + P) % P);
+			fp_ival2 = fingerprint_type::interval((*_sorter3)->second, (*_sorter1)->second, m_rinterval->compute(cur_lcp));
 
 			ch2 = (*_sorter3)->third;
 
+			for (uint64 j = 0; j < m_extra_num; ++j) {
+
+				extra_ival2[j] = m_extra->interval(j, (*_sorter3)->get_extra(j), (*_sorter1)->get_extra(j), cur_lcp);
+			}
+
 			++(*_sorter3), ++(*_sorter1);
 
 			for (; !_sorter3->empty(); ++(*_sorter3), ++(*_sorter2), ++(*_sorter1)) {
 
-				fp_ival1 = static_cast<fpa_type>(((*_sorter2)->second - (static_cast<fpb_type>((*_sorter1)->second) * m_rinterval->compute(cur_lcp)) % P + P) % P);
+				fp_ival1 = fingerprint_type::interval((*_sorter2)->second, (*_sorter1)->second, m_rinterval->compute(cur_lcp));
 
 				ch1 = (*_sorter2)->third;
 
-				if (fp_ival1 != fp_ival2 || ch1 == ch2) {
+				if (fp_ival1 != fp_ival2 || ch1 == ch2 || !check_extra(*(*_sorter1), *(*_sorter2), cur_lcp, extra_ival2)) {
 
 					is_right = false;
 
@@ -715,17 +727,22 @@ private:
 
 				cur_lcp = *(*lcp_lms_reader);
 
-				fp_ival2 = static_cast<fpa_type>(((*_sorter3)->second - (static_cast<fpb_type>((*_sorter1)->second) * m_rinterval->compute(cur_lcp)) % P + P) % P);
+				fp_ival2 = fingerprint_type::interval((*_sorter3)->second, (*_sorter1)->second, m_rinterval->compute(cur_lcp));
 
 				ch2 = (*_sorter3)->third;
+
+				for (uint64 j = 0; j < m_extra_num; ++j) {
+
+					extra_ival2[j] = m_extra->interval(j, (*_sorter3)->get_extra(j), (*_sorter1)->get_extra(j), cur_lcp);
+				}
 			}
 
 			// check final pair
-			fp_ival1 = static_cast<fpa_type>(((*_sorter2)->second - (static_cast<fpb_type>((*_sorter1)->second) * m_rinterval->compute(cur_lcp)) % P + P) % P);
+			fp_ival1 = fingerprint_type::interval((*_sorter2)->second, (*_sorter1)->second, m_rinterval->compute(cur_lcp));
 
 			ch1 = (*_sorter2)->third;
 
-			if (fp_ival1 != fp_ival2 || ch1 == ch2) {
+			if (fp_ival1 != fp_ival2 || ch1 == ch2 || !check_extra(*(*_sorter1), *(*_sorter2), cur_lcp, extra_ival2)) {
 
 				is_right = false;
 			}
@@ -735,30 +752,45 @@ private:
 			return is_right;
 		}
 
-		/// \brief core part
+		/// \brief compare the extra fingerprints of fp[SA_LMS[i], SA_LMS[i] + LCP_LMS[i] - 1] with those of fp[SA_LMS[i - 1], SA_LMS[i - 1] + LCP_LMS[i] - 1]
 		///
-		bool run() {
+		/// \param _tuple1 record of fp[0, SA_LMS[i] - 1]
+		/// \param _tuple2 record of fp[0, SA_LMS[i] + LCP_LMS[i] - 1]
+		/// \param _lcp LCP_LMS[i]
+		/// \param _extra_ival2 extra fingerprints of fp[SA_LMS[i - 1], SA_LMS[i - 1] + LCP_LMS[i] - 1]
+		template<typename tuple1_type, typename tuple2_type>
+		bool check_extra(const tuple1_type& _tuple1, const tuple2_type& _tuple2, const uint64 _lcp, const std::vector<uint64>& _extra_ival2) const {
 
-			// step 1: retrieve SA_LMS and LCP_LMS from SA and LCP, respectively.
-			retrieve_lms();
+			for (uint64 j = 0; j < m_extra_num; ++j) {
 
-			// step 2: fetch fp[0, SA_LMS[i] - 1]
-			pair2_less_sorter_1st_type* sorter1 = fetch_fp();
+				if (m_extra->interval(j, _tuple2.get_extra(j), _tuple1.get_extra(j), _lcp) != _extra_ival2[j]) return false;
+			}
+
+			return true;
+		}
+
+		/// \brief core part
+		///
+		bool run() {
 
-			// step 2: fetch fp[0, SA_LMS[i] + LCP_LMS[i] - 1]
-			triple3_less_sorter_1st_type* sorter2 = fetch_fp_ch_cur();
+			// step 1: retrieve SA_LMS and LCP_LMS from SA and LCP, respectively.
+			retrieve_lms();
 
-			// step 3: fetch fp[0, SA_LMS[i] + LCP_LMS[i + 1] - 1]
-			triple3_less_sorter_1st_type* sorter3 = fetch_fp_ch_pre();
+			bool res = false;
 
-			// step 4: check 
-			bool res = check(sorter1, sorter2, sorter3);
+			switch (MultiFingerprint::record_num(m_extra_num)) { // at most MultiFingerprint::MAX_NUM
 
-			delete sorter1; sorter1 = nullptr;
+			case 0: res = run_streams<0>(); break;
 
-			delete sorter2; sorter2 = nullptr;
+			case 2: res = run_streams<2>(); break;
 
-			delete sorter3; sorter3 = nullptr;
+			default: res = run_streams<MultiFingerprint::MAX_NUM>(); break;
+			}
+
+			if (m_extra != nullptr) {
+
+				std::cerr << "Extra fingerprints: " << m_extra_num << ", seed: " << m_config.fp_seed << ", error probability <= 2^" << m_extra->log2_error_bound(m_len, m_lms_num) << std::endl;
+			}
 
 			return res;
 		}
@@ -780,45 +812,491 @@ private:
 		~LMSValidate() {
 		
 			delete m_rinterval; m_rinterval = nullptr;
+
+			delete m_checkpoint; m_checkpoint = nullptr;
+
+			delete m_extra; m_extra = nullptr;
+		}
+	};
+
+
+	/// \brief compute SA_LMS and LCP_LMS from SA without LCP, for building LCP or validating SA alone
+	///
+	/// LCP_LMS[i] is the LCP-value of suf(SA_LMS[i - 1]) and suf(SA_LMS[i]), found for all i at once by searching on fingerprints.
+	/// Each pair keeps an interval [low, high] containing the value. A round probes one length k per unfinished pair
+	/// and compares fp[SA_LMS[i - 1], SA_LMS[i - 1] + k - 1] with fp[SA_LMS[i], SA_LMS[i] + k - 1],
+	/// where the prefix fingerprints of all the probes are fetched in a single scan of T.
+	/// The probes double from 1 until the first mismatch (galloping) and then halve the interval (binary search),
+	/// thus a pair takes O(log LCP_LMS[i]) rounds and the short ones drop out early.
+	/// Only the unfinished pairs are carried to the next round, along with fp[0, SA_LMS[i - 1] - 1] and fp[0, SA_LMS[i] - 1] fetched by the first round.
+	/// The first round also records the fingerprint samples of T, unless loaded from --fp-index, such that the later rounds only read the windows with probes.
+	/// Once the FingerprintLCE queries on the samples read less than a round for the remaining pairs, these are resolved one by one instead.
+	/// As the extra fingerprints are not used, the result is correct with the probability of a fingerprint collision.
+	/// Given LCP_LMS, check_order() then verifies that SA_LMS is sorted by the mismatching characters.
+	struct LMSBuild {
+
+	private:
+
+		/// \brief search state of an unfinished pair
+		struct PairState {
+
+			index_type idx; ///< i
+
+			size_type pre_sa; ///< SA_LMS[i - 1]
+
+			size_type cur_sa; ///< SA_LMS[i]
+
+			index_type low; ///< LCP_LMS[i] is in [low, high]
+
+			index_type high;
+
+			uint8 is_galloping; ///< whether the probes still double
+
+			fp_value_type pre_fp; ///< fp[0, SA_LMS[i - 1] - 1], fetched by the first round
+
+			fp_value_type cur_fp; ///< fp[0, SA_LMS[i] - 1], fetched by the first round
+
+			/// \brief ctor
+			PairState() {}
+
+			/// \brief ctor, start galloping from 0
+			PairState(const uint64 _idx, const size_type _pre_sa, const size_type _cur_sa, const uint64 _high) : idx(_idx), pre_sa(_pre_sa), cur_sa(_cur_sa), low(0), high(_high), is_galloping(1), pre_fp(0), cur_fp(0) {}
+		};
+
+		typedef typename ExVector<PairState>::vector state_vector_type;
+
+		alphabet_vector_type* m_t; ///< input string
+
+		uint64 m_len; ///< length of input string
+
+		uint64 m_lms_num; ///< number of LMS suffixes
+
+		pair1_less_sorter_1st_type* m_lms_sorter; ///< (i, SA[i]) for the LMS suffixes sorted by i
+
+		const Config& m_config; ///< run-time settings
+
+		RInterval<fingerprint_type>* m_rinterval; ///< R^k mod P
+
+		FingerprintCheckpoint<alphabet_vector_type, fingerprint_type>* m_checkpoint; ///< sampled prefix fingerprints, loaded from --fp-index or recorded by the first round
+
+		size_vector_type* m_sa_lms; ///< pointer to SA_LMS
+
+		size_vector_type* m_lcp_lms; ///< pointer to LCP_LMS
+
+	public:
+		/// \brief ctor
+		///
+		/// \param _lms_sorter (i, SA[i]) for the LMS suffixes sorted by i, produced by RetrievePre
+		/// \param _lms_num number of LMS suffixes
+		LMSBuild(alphabet_vector_type* _t, pair1_less_sorter_1st_type* _lms_sorter, const uint64 _lms_num, const Config& _config) :
+			m_t(_t),
+			m_len(m_t->size()),
+			m_lms_num(_lms_num),
+			m_lms_sorter(_lms_sorter),
+			m_config(_config),
+			m_sa_lms(nullptr),
+			m_lcp_lms(nullptr) {
+
+			m_rinterval = new RInterval<fingerprint_type>(m_len);
+
+			m_checkpoint = new FingerprintCheckpoint<alphabet_vector_type, fingerprint_type>(m_len, m_config.fp_index_fn, m_config.fp_index_step, m_config.t_fn); // in RAM if no file is given
+		}
+
+		/// \brief dtor
+		~LMSBuild() {
+
+			delete m_rinterval; m_rinterval = nullptr;
+
+			delete m_checkpoint; m_checkpoint = nullptr;
+		}
+
+		/// \brief core part
+		///
+		void run() {
+
+			// step 1: redirect SA_LMS to an external file and initialize the search intervals
+			m_sa_lms = new size_vector_type(); m_sa_lms->resize(m_lms_num);
+
+			state_vector_type* state = new state_vector_type(); state->resize(m_lms_num);
+
+			uint64 active_num = 0;
+
+			{
+				typename size_vector_type::bufwriter_type sa_lms_writer(*m_sa_lms);
+
+				typename state_vector_type::bufwriter_type state_writer(*state);
+
+				size_type pre_sa = 0;
+
+				for (uint64 idx = 0; !m_lms_sorter->empty(); ++idx, ++(*m_lms_sorter)) {
+
+					const size_type cur_sa = (*m_lms_sorter)->second;
+
+					sa_lms_writer << cur_sa;
+
+					if (idx != 0) { // the leftmost has no left neighbor
+
+						state_writer << PairState(idx, pre_sa, cur_sa, m_len - std::max<uint64>(pre_sa, cur_sa));
+
+						++active_num;
+					}
+
+					pre_sa = cur_sa;
+				}
+
+				sa_lms_writer.finish();
+
+				state_writer.finish();
+			}
+
+			state->resize(active_num);
+
+			// step 2: narrow the intervals round by round, the pairs finished with a non-zero value are collected as (i, LCP_LMS[i])
+			pair1_less_sorter_1st_type* lcp_sorter = new pair1_less_sorter_1st_type(pair1_less_comparator_1st_type(), MAIN_MEM_AVAIL / 8);
+
+			for (uint64 round = 0; active_num != 0 && (round == 0 || false == is_query_cheaper(active_num)); ++round) {
+
+				std::cerr << "LCP_LMS round " << round << ", unfinished pairs: " << active_num << std::endl;
+
+				active_num = search(state, round == 0, lcp_sorter);
+			}
+
+			// step 3: resolve the remaining pairs one by one
+			if (active_num != 0) {
+
+				std::cerr << "LCP_LMS queries, unfinished pairs: " << active_num << std::endl;
+
+				resolve(state, lcp_sorter);
+			}
+
+			delete state; state = nullptr;
+
+			lcp_sorter->sort();
+
+			// step 4: redirect LCP_LMS to an external file
+			m_lcp_lms = new size_vector_type(); m_lcp_lms->resize(m_lms_num);
+
+			{
+				typename size_vector_type::bufwriter_type lcp_lms_writer(*m_lcp_lms);
+
+				for (uint64 idx = 0; idx < m_lms_num; ++idx) {
+
+					if (!lcp_sorter->empty() && static_cast<uint64>((*lcp_sorter)->first) == idx) {
+
+						lcp_lms_writer << (*lcp_sorter)->second;
+
+						++(*lcp_sorter);
+					}
+					else {
+
+						lcp_lms_writer << size_type(0);
+					}
+				}
+
+				lcp_lms_writer.finish();
+			}
+
+			delete lcp_sorter; lcp_sorter = nullptr;
+		}
+
+		/// \brief check that suf(SA_LMS[i - 1]) < suf(SA_LMS[i]) for all i, after run()
+		///
+		/// T[SA_LMS[i - 1] + LCP_LMS[i]] and T[SA_LMS[i] + LCP_LMS[i]] are fetched in a single scan of T, the former must be smaller.
+		/// The end of T is smaller than any character, i.e., a suffix is smaller than those it prefixes.
+		bool check_order() {
+
+			// request the two characters after the common prefix of each pair, tagged by the side
+			triple4_less_sorter_1st_type* request_sorter = new triple4_less_sorter_1st_type(triple4_less_comparator_1st_type(), MAIN_MEM_AVAIL / 4);
+
+			{
+				typename size_vector_type::bufreader_type sa_lms_reader(*m_sa_lms);
+
+				typename size_vector_type::bufreader_type lcp_lms_reader(*m_lcp_lms);
+
+				size_type pre_sa = 0;
+
+				for (uint64 idx = 0; !sa_lms_reader.empty(); ++idx, ++sa_lms_reader, ++lcp_lms_reader) {
+
+					const size_type cur_sa = *sa_lms_reader, cur_lcp = *lcp_lms_reader;
+
+					if (idx != 0) { // the leftmost has no left neighbor
+
+						request_sorter->push(triple4_type(pre_sa + cur_lcp, idx, 0));
+
+						request_sorter->push(triple4_type(cur_sa + cur_lcp, idx, 1));
+					}
+
+					pre_sa = cur_sa;
+				}
+			}
+
+			request_sorter->sort();
+
+			// answer the requests in a single scan of T and sort them back by i
+			std::vector<pair5_less_sorter_1st_type*> ch_sorters(2);
+
+			for (uint64 j = 0; j < 2; ++j) ch_sorters[j] = new pair5_less_sorter_1st_type(pair5_less_comparator_1st_type(), MAIN_MEM_AVAIL / 8);
+
+			{
+				ScanReader<alphabet_vector_type> t_reader(*m_t, m_config.t_fn, m_config);
+
+				uint64 pos = 0;
+
+				for (; !request_sorter->empty(); ++(*request_sorter)) {
+
+					const triple4_type& tuple = *(*request_sorter);
+
+					for (; pos < tuple.first; ++pos) ++t_reader; // skip to the requested position
+
+					const alphabet_extension_type ch = (tuple.first < m_len) ? static_cast<alphabet_extension_type>(*t_reader) + 1 : 0;
+
+					ch_sorters[tuple.third]->push(pair5_type(tuple.second, ch));
+				}
+			}
+
+			delete request_sorter; request_sorter = nullptr;
+
+			bool is_right = true;
+
+			for (uint64 j = 0; j < 2; ++j) ch_sorters[j]->sort();
+
+			for (; !ch_sorters[0]->empty(); ++(*ch_sorters[0]), ++(*ch_sorters[1])) {
+
+				if ((*ch_sorters[0])->second >= (*ch_sorters[1])->second) {
+
+					is_right = false;
+
+					break;
+				}
+			}
+
+			for (uint64 j = 0; j < 2; ++j) {
+
+				delete ch_sorters[j]; ch_sorters[j] = nullptr;
+			}
+
+			return is_right;
+		}
+
+		/// \brief return m_sa_lms
+		///
+		size_vector_type* get_sa_lms() {
+
+			return m_sa_lms;
+		}
+
+		/// \brief return m_lcp_lms
+		///
+		size_vector_type* get_lcp_lms() {
+
+			return m_lcp_lms;
+		}
+
+	private:
+
+		/// \brief length to probe, given low < high
+		static uint64 probe(const PairState& _state) {
+
+			const uint64 low = _state.low, high = _state.high;
+
+			if (_state.is_galloping) return std::min(high, std::max<uint64>(1, 2 * low));
+
+			return low + (high - low + 1) / 2;
+		}
+
+		/// \brief whether the queries for the unfinished pairs read less than a round, which scans T at worst
+		///
+		/// A probe of a query reads about one block of T at each of the two suffixes, see FingerprintCheckpoint::prefix.
+		bool is_query_cheaper(const uint64 _active_num) const {
+
+			const uint64 probe_bytes = 2 * std::max<uint64>(ExVector<alphabet_type>::block_size, m_checkpoint->step() * sizeof(alphabet_type));
+
+			return _active_num * probe_bytes <= m_len * sizeof(alphabet_type);
+		}
+
+		/// \brief one round of the search, return the number of unfinished pairs afterwards
+		///
+		/// \param _state unfinished pairs, replaced by those still unfinished
+		/// \param _is_first whether to fetch fp[0, SA_LMS[i - 1] - 1] and fp[0, SA_LMS[i] - 1] as well
+		/// \param _lcp_sorter (i, LCP_LMS[i]) of the pairs finished with a non-zero value
+		uint64 search(state_vector_type*& _state, const bool _is_first, pair1_less_sorter_1st_type* _lcp_sorter) {
+
+			// request fp[0, SA_LMS[i - 1] + k - 1] and fp[0, SA_LMS[i] + k - 1] for the j-th unfinished pair i
+			triple4_less_sorter_1st_type* request_sorter = new triple4_less_sorter_1st_type(triple4_less_comparator_1st_type(), MAIN_MEM_AVAIL / 4);
+
+			{
+				typename state_vector_type::bufreader_type state_reader(*_state);
+
+				for (uint64 j = 0; !state_reader.empty(); ++j, ++state_reader) {
+
+					const PairState& cur = *state_reader;
+
+					const uint64 k = probe(cur);
+
+					if (_is_first) {
+
+						request_sorter->push(triple4_type(cur.pre_sa, j, 0));
+
+						request_sorter->push(triple4_type(cur.cur_sa, j, 2));
+					}
+
+					request_sorter->push(triple4_type(cur.pre_sa + k, j, 1));
+
+					request_sorter->push(triple4_type(cur.cur_sa + k, j, 3));
+				}
+			}
+
+			request_sorter->sort();
+
+			// answer the requests in a single scan of T and sort them back by j
+			std::vector<pair2_less_sorter_1st_type*> fp_sorters(4);
+
+			for (uint64 j = 0; j < 4; ++j) fp_sorters[j] = new pair2_less_sorter_1st_type(pair2_less_comparator_1st_type(), MAIN_MEM_AVAIL / 16);
+
+			PrefixFingerprint<alphabet_vector_type, fingerprint_type> prefix_fp(*m_t, m_config, m_checkpoint);
+
+			prefix_fp.answer(*request_sorter, [&](const triple4_type& _tuple, const fp_value_type _fp, const alphabet_type) {
+
+				fp_sorters[_tuple.third]->push(pair2_type(_tuple.second, _fp));
+			});
+
+			delete request_sorter; request_sorter = nullptr;
+
+			for (uint64 j = 0; j < 4; ++j) fp_sorters[j]->sort();
+
+			// compare the fingerprints and narrow the intervals, keep the unfinished pairs only
+			state_vector_type* new_state = new state_vector_type(); new_state->resize(_state->size());
+
+			uint64 active_num = 0;
+
+			{
+				typename state_vector_type::bufreader_type state_reader(*_state);
+
+				typename state_vector_type::bufwriter_type state_writer(*new_state);
+
+				for (; !state_reader.empty(); ++state_reader) {
+
+					PairState cur = *state_reader;
+
+					if (_is_first) {
+
+						cur.pre_fp = (*fp_sorters[0])->second, cur.cur_fp = (*fp_sorters[2])->second;
+
+						++(*fp_sorters[0]), ++(*fp_sorters[2]);
+					}
+
+					const uint64 k = probe(cur);
+
+					const fp_value_type r_pow = m_rinterval->compute(k);
+
+					const fp_value_type fp1 = fingerprint_type::interval((*fp_sorters[1])->second, cur.pre_fp, r_pow);
+
+					const fp_value_type fp2 = fingerprint_type::interval((*fp_sorters[3])->second, cur.cur_fp, r_pow);
+
+					++(*fp_sorters[1]), ++(*fp_sorters[3]);
+
+					if (fp1 == fp2) { // the first k characters match
+
+						cur.low = k;
+					}
+					else { // mismatch within the first k characters, stop galloping
+
+						cur.high = k - 1, cur.is_galloping = 0;
+					}
+
+					if (cur.low < cur.high) {
+
+						state_writer << cur;
+
+						++active_num;
+					}
+					else if (static_cast<uint64>(cur.low) != 0) {
+
+						_lcp_sorter->push(pair1_type(cur.idx, cur.low));
+					}
+				}
+
+				state_writer.finish();
+			}
+
+			new_state->resize(active_num);
+
+			for (uint64 j = 0; j < 4; ++j) {
+
+				delete fp_sorters[j]; fp_sorters[j] = nullptr;
+			}
+
+			delete _state; _state = new_state;
+
+			return active_num;
+		}
+
+		/// \brief resolve the unfinished pairs by LCE queries on the samples, each starting from the interval of the pair
+		///
+		/// \param _lcp_sorter (i, LCP_LMS[i]) of the pairs finished with a non-zero value
+		void resolve(const state_vector_type* _state, pair1_less_sorter_1st_type* _lcp_sorter) {
+
+			FingerprintLCE<alphabet_vector_type, fingerprint_type> lce(*m_t, m_config, m_checkpoint, m_rinterval);
+
+			for (typename state_vector_type::bufreader_type state_reader(*_state); !state_reader.empty(); ++state_reader) {
+
+				const PairState& cur = *state_reader;
+
+				const uint64 lcp = lce.compute(cur.pre_sa, cur.cur_sa, cur.low, cur.high, cur.is_galloping != 0);
+
+				if (lcp != 0) _lcp_sorter->push(pair1_type(cur.idx, lcp));
+			}
 		}
 	};
 
 
-	/// \brief retrieve preceding items (pre_ch & pre_t) for L-type, S-type and LMS suffixes
+	/// \brief retrieve preceding items (pre_ch & pre_t) for L-type, S-type and LMS suffixes, and select the LMS suffixes for LMSValidate
 	///
+	/// The inverse SA is sorted once and the suffixes are classified in a single leftward scan of T, which also checks that SA is a permutation.
 	struct RetrievePre {
 
 		/// \brief ctor
 		///
-		RetrievePre(alphabet_vector_type* _t, size_vector_type* _sa, pair3_less_sorter_1st_type*& _pre_item_of_lms_sorter, triple2_less_sorter_1st_type*& _pre_item_of_l_sorter, triple2_great_sorter_1st_type*& _pre_item_of_s_sorter, BktInfo& _bkt_info) {
+		/// \param _lms_sorter (i, SA[i]) for the LMS suffixes sorted by i
+		/// \param _lms_num number of LMS suffixes
+		/// \param _sa_fn SA file, read by an asynchronous stream if required
+		RetrievePre(alphabet_vector_type* _t, size_vector_type* _sa, pair1_less_sorter_1st_type*& _lms_sorter, uint64& _lms_num, pair3_less_sorter_1st_type*& _pre_item_of_lms_sorter, triple2_less_sorter_1st_type*& _pre_item_of_l_sorter, triple2_great_sorter_1st_type*& _pre_item_of_s_sorter, BktInfo& _bkt_info, const std::string& _sa_fn, const Config& _config) {
 	
-			// step 1: sort (SA[i], i) by i in descending order 
+			// step 1: sort (SA[i], i) by SA[i] in descending order 
 			pair1_great_sorter_1st_type* pair1_great_sorter = new pair1_great_sorter_1st_type(pair1_great_comparator_1st_type(), MAIN_MEM_AVAIL / 4);
 	
-			typename size_vector_type::bufreader_type* sa_reader = new typename size_vector_type::bufreader_type(*_sa);
+			ScanReader<size_vector_type>* sa_reader = new ScanReader<size_vector_type>(*_sa, _sa_fn, _config);
+
+			const uint64 len = _t->size();
 
 			for (uint64 idx = 1; !sa_reader->empty(); ++idx, ++(*sa_reader)) {
 			
-				pair1_great_sorter->push(pair1_type(*(*sa_reader), idx));
+				pair1_great_sorter->push(pair1_type(to_index<index_type>(*(*sa_reader), len), idx)); // a value beyond T breaks the permutation
 			}
 
 			delete sa_reader; sa_reader = nullptr;
 
 			pair1_great_sorter->sort();
 
-			// step 2: record pre_t & pre_ch for L-type, S-type and LMS suffixes separately.
-			_pre_item_of_lms_sorter = new pair3_less_sorter_1st_type(pair3_less_comparator_1st_type(), MAIN_MEM_AVAIL / 4);
+			// step 2: record pre_t & pre_ch for L-type, S-type and LMS suffixes separately, and select the LMS suffixes.
+			_lms_sorter = new pair1_less_sorter_1st_type(pair1_less_comparator_1st_type(), MAIN_MEM_AVAIL / 8);
+
+			_lms_num = 0;
+
+			_pre_item_of_lms_sorter = new pair3_less_sorter_1st_type(pair3_less_comparator_1st_type(), MAIN_MEM_AVAIL / 8);
 
 			_pre_item_of_l_sorter = new triple2_less_sorter_1st_type(triple2_less_comparator_1st_type(), MAIN_MEM_AVAIL / 4);
 
 			_pre_item_of_s_sorter = new triple2_great_sorter_1st_type(triple2_great_comparator_1st_type(), MAIN_MEM_AVAIL / 4);
 
-			typename alphabet_vector_type::bufreader_reverse_type* t_rev_reader = new typename alphabet_vector_type::bufreader_reverse_type(*_t);
+			ScanReader<alphabet_vector_type, true>* t_rev_reader = new ScanReader<alphabet_vector_type, true>(*_t, _config.t_fn, _config);
 			
 			alphabet_type cur_scanned_ch, last_scanned_ch;
 			
 			uint8 cur_scanned_type, last_scanned_type;
 
+			uint64 pos = _t->size() - 1;
+
 			// rightmost character is L_TYPE
 			cur_scanned_type = L_TYPE, cur_scanned_ch = *(*t_rev_reader);
 
@@ -826,7 +1304,14 @@ private:
 			
 			last_scanned_type = cur_scanned_type, last_scanned_ch = cur_scanned_ch;
 
-			for (; !t_rev_reader->empty(); ++(*t_rev_reader), ++(*pair1_great_sorter)) {
+			for (; !t_rev_reader->empty(); --pos, ++(*t_rev_reader), ++(*pair1_great_sorter)) {
+
+				if (pos != (*pair1_great_sorter)->first) { // for the last scanned suffix
+
+					std::cerr << "SA is not a permutation\n";
+
+					exit(0);
+				}
 			
 				cur_scanned_ch = *(*t_rev_reader);
 
@@ -849,6 +1334,10 @@ private:
 						_bkt_info.add_lms(last_scanned_ch);
 
 						_pre_item_of_lms_sorter->push(pair3_type((*pair1_great_sorter)->second, cur_scanned_ch));
+
+						++_lms_num;
+
+						_lms_sorter->push(pair1_type((*pair1_great_sorter)->second, pos));
 					}
 				}
 
@@ -858,6 +1347,13 @@ private:
 			}
 
 			// leftmost (last scanned) must not be LMS and we suppose its preceding to be the sentinel 
+			if (pos != (*pair1_great_sorter)->first) {
+
+				std::cerr << "SA is not a permutation\n";
+
+				exit(0);
+			}
+
 			cur_scanned_type = SENTINEL_TYPE, cur_scanned_ch = 0;
 
 			if (last_scanned_type == L_TYPE) { // push the preceding item of an L-type suffix 
@@ -884,67 +1380,333 @@ private:
 			// compute bucket size by summing up L-type ones and S-type ones
 			_bkt_info.accumulate();
 
-			// sort preceding items 
-			_pre_item_of_s_sorter->sort();
+			// sort preceding items 
+			_pre_item_of_s_sorter->sort();
+
+			_pre_item_of_l_sorter->sort();
+
+			_pre_item_of_lms_sorter->sort();
+
+			_lms_sorter->sort();
+		}
+	};
+
+
+	/// \brief RMQ
+	///
+	/// Given SA[k] and SA[k + 1] respectively induced from SA[i] and SA[j], the LCP-value of suf(SA[k]) and suf(SA[k + 1])
+	/// is determined by LCP[i + 1, j]. 
+	/// The response to the range-minimum query for LCP[i + 1, j] returns the minimum value among LCP[i + 1], .., LCP[j - 1], LCP[j].
+	///
+	/// Instead of lowering the minimum of every bucket on each update, the updated values are kept in a global monotone stack of
+	/// (time, value) pairs with strictly increasing times and values from bottom to top, and each bucket only records the time of its last reset.
+	/// The minimum of the values pushed after time r is the value of the lowest stack entry later than r, found by a binary search.
+	/// An update pops the entries not smaller than the new value, and is dropped if the top entry is later than the last reset.
+	/// When the stack grows beyond twice the number of buckets ever reset, it is compacted by keeping the lowest entry after each reset time,
+	/// the reset times being enumerated in ascending order from a list of the buckets in the order of their last resets.
+	/// Updates and resets cost amortized O(1) and queries cost O(log sigma), whereas the space is O(sigma), sigma being the number of buckets.
+	///
+	/// For at most 128 buckets, the dense mode (the default, --rmq=stack disables it) keeps the minimum of each bucket in an aligned array instead,
+	/// and lowers them on each update by the widest vectorized kernel supported by the CPU (see simd_min.h).
+	/// Only the buckets in use are swept, rounded up to 8 words.
+	/// Its queries and resets cost O(1) and its updates cost O(sigma / lanes), thus it outruns the stack on small alphabets,
+	/// whereas the stack is kept for more buckets.
+	struct RMQ {
+	public:
+
+		static const uint64 DENSE_NUM = 128; ///< maximum number of buckets in the dense mode
+
+	private:
+
+		const size_type val_max;
+
+		const uint64 NIL; ///< no reset yet or end of the list
+
+		const uint64 m_dense_max; ///< value of a reset bucket in the dense mode, below 2^63 as required by the AVX2 kernel
+
+		uint64* m_dense_buf; ///< storage of the dense array, nullptr if not in the dense mode
+
+		uint64* m_dense; ///< minimum of each bucket in the dense mode, 64-byte aligned
+
+		uint64 m_dense_num; ///< number of buckets rounded up to a multiple of 8, swept on each update
+
+		uint64 m_time; ///< number of updates so far
+
+		std::vector<std::pair<uint64, size_type> > m_stack; ///< (time, value) of the updates, monotone in both components
+
+		std::vector<uint64> m_reset_time; ///< time of the last reset of each bucket, NIL if never reset
+
+		std::vector<uint64> m_prev; ///< previous bucket in the order of last resets
+
+		std::vector<uint64> m_next; ///< next bucket in the order of last resets
+
+		uint64 m_head; ///< bucket reset least recently
+
+		uint64 m_tail; ///< bucket reset most recently
+
+		uint64 m_reset_num; ///< number of buckets ever reset
+
+	public:
+
+		/// \brief ctor
+		///
+		/// \param _bkt_num number of buckets
+		/// \param _dense use the dense mode, ignored if there are more than DENSE_NUM buckets
+		RMQ(const uint64 _bkt_num, const bool _dense = false) : val_max(std::numeric_limits<size_type>::max()), NIL(std::numeric_limits<uint64>::max()),
+			m_dense_max(std::min<uint64>(std::numeric_limits<size_type>::max(), (1ull << 63) - 1)) {
+
+			m_dense_buf = m_dense = nullptr;
+
+			m_dense_num = 0;
+
+			if (_dense && _bkt_num <= DENSE_NUM) {
+
+				m_dense_num = std::max<uint64>((_bkt_num + 7) / 8 * 8, 8);
+
+				m_dense_buf = new uint64[m_dense_num + 8];
+
+				m_dense = reinterpret_cast<uint64*>((reinterpret_cast<uintptr_t>(m_dense_buf) + 63) & ~static_cast<uintptr_t>(63));
+
+				std::fill(m_dense, m_dense + m_dense_num, 0);
+
+				return;
+			}
+
+			m_time = 0;
+
+			m_reset_time.resize(_bkt_num, NIL);
+
+			m_prev.resize(_bkt_num, NIL);
+
+			m_next.resize(_bkt_num, NIL);
+
+			m_head = m_tail = NIL;
+
+			m_reset_num = 0;
+		}
+
+		/// \brief dtor
+		~RMQ() {
+
+			delete[] m_dense_buf; m_dense_buf = nullptr;
+		}
+
+		/// \brief whether the dense mode is in use
+		bool is_dense() const {
+
+			return m_dense != nullptr;
+		}
+
+		/// \brief getter 
+		/// 
+		/// A bucket never reset keeps its initial value 0.
+		size_type get(const uint64 _bkt) {
+
+			if (m_dense != nullptr) return (m_dense[_bkt] == m_dense_max) ? val_max : static_cast<size_type>(m_dense[_bkt]);
+
+			const uint64 reset_time = m_reset_time[_bkt];
+
+			if (reset_time == NIL) return 0;
+
+			typename std::vector<std::pair<uint64, size_type> >::const_iterator it = std::upper_bound(m_stack.begin(), m_stack.end(), std::make_pair(reset_time, val_max), TimeLess());
+
+			return (it == m_stack.end()) ? val_max : it->second;
+		}
+
+		/// \brief update
+		///
+		/// lower the minimum of every bucket to _val.
+		void update(size_type _val) {
+
+			if (m_dense != nullptr) {
+
+				MinBroadcast::get()(m_dense, m_dense_num, std::min<uint64>(_val, m_dense_max));
+
+				return;
+			}
+
+			++m_time;
+
+			while (!m_stack.empty() && !(m_stack.back().second < _val)) m_stack.pop_back();
+
+			if (!m_stack.empty() && m_tail != NIL && m_stack.back().first > m_reset_time[m_tail]) return; // dominated by the top entry
+
+			m_stack.push_back(std::make_pair(m_time, _val));
+
+			if (m_stack.size() > 2 * (m_reset_num + 1)) compact();
+
+			return;
+		}
+
+		/// \brief reset the range minimum value to val_max
+		///
+		void reset(const uint64 _bkt) {
+
+			if (m_dense != nullptr) {
+
+				m_dense[_bkt] = m_dense_max;
+
+				return;
+			}
+
+			if (m_reset_time[_bkt] == NIL) {
+
+				++m_reset_num;
+			}
+			else { // unlink
+
+				(m_prev[_bkt] == NIL ? m_head : m_next[m_prev[_bkt]]) = m_next[_bkt];
+
+				(m_next[_bkt] == NIL ? m_tail : m_prev[m_next[_bkt]]) = m_prev[_bkt];
+			}
+
+			// append to the tail
+			m_prev[_bkt] = m_tail, m_next[_bkt] = NIL;
+
+			(m_tail == NIL ? m_head : m_next[m_tail]) = _bkt;
+
+			m_tail = _bkt;
+
+			m_reset_time[_bkt] = m_time;
+
+			return;
+		}
+
+	private:
+
+		/// \brief compare by time
+		struct TimeLess {
+
+			bool operator()(const std::pair<uint64, size_type>& _a, const std::pair<uint64, size_type>& _b) const {
+
+				return _a.first < _b.first;
+			}
+		};
+
+		/// \brief keep only the lowest entry later than each reset time
+		///
+		/// Let r_1 <= r_2 <= ... <= r_m be the reset times. A query after r_j returns the lowest entry in (r_j, infinity),
+		/// thus only the lowest entry in each (r_j, r_{j + 1}] is necessary and the entries not later than r_1 are useless.
+		void compact() {
+
+			uint64 num = 0, i = 0;
+
+			for (uint64 ch = m_head; ch != NIL; ch = m_next[ch]) {
+
+				const uint64 beg = m_reset_time[ch], end = (m_next[ch] == NIL) ? NIL : m_reset_time[m_next[ch]];
+
+				while (i < m_stack.size() && m_stack[i].first <= beg) ++i;
+
+				if (i < m_stack.size() && m_stack[i].first <= end) m_stack[num++] = m_stack[i++];
+			}
+
+			m_stack.resize(num);
+		}
+	};
+
+	/// \brief validate induced SA-values and LCP-values after the induction
+	///
+	/// Reading the induced values in place requires one SA reader and one LCP reader per bucket, which is unaffordable for large alphabets.
+	/// Instead, the expected values are pushed into a sorter along with their positions in SA. 
+	/// When the induction is finished, the expectations sorted by positions are merged with a sequential scan of SA and LCP.
+	struct DeferredCheck {
+
+	public:
+
+		/// \brief what to check, bitwise or-ed
+		enum { CHECK_SA = 1, CHECK_LCP = 2 };
+
+	private:
+
+		quadruple1_less_sorter_1st_type* m_sorter; ///< expectations
+
+	public:
+
+		/// \brief ctor
+		///
+		/// \param _mem memory for the sorter in bytes
+		DeferredCheck(const uint64 _mem) {
+
+			m_sorter = new quadruple1_less_sorter_1st_type(quadruple1_less_comparator_1st_type(), _mem);
+		}
+
+		/// \brief dtor
+		///
+		~DeferredCheck() {
+
+			delete m_sorter; m_sorter = nullptr;
+		}
+
+		/// \brief expect SA[_pos] = _sa_value
+		///
+		void push_sa(const uint64 _pos, const size_type _sa_value) {
+
+			m_sorter->push(quadruple1_type(_pos, _sa_value, 0, CHECK_SA));
+		}
+
+		/// \brief expect LCP[_pos] = _lcp_value
+		///
+		void push_lcp(const uint64 _pos, const size_type _lcp_value) {
+
+			m_sorter->push(quadruple1_type(_pos, 0, _lcp_value, CHECK_LCP));
+		}
+
+		/// \brief expect SA[_pos] = _sa_value and LCP[_pos] = _lcp_value
+		///
+		void push_both(const uint64 _pos, const size_type _sa_value, const size_type _lcp_value) {
+
+			m_sorter->push(quadruple1_type(_pos, _sa_value, _lcp_value, CHECK_SA | CHECK_LCP));
+		}
+
+		/// \brief merge the expectations with SA and LCP
+		///
+		/// \param _lcp nullptr if only SA-values are expected
+		bool run(size_vector_type* _sa, size_vector_type* _lcp) {
+
+			m_sorter->sort();
 
-			_pre_item_of_l_sorter->sort();
+			typename size_vector_type::bufreader_type sa_reader(*_sa);
 
-			_pre_item_of_lms_sorter->sort();
-		}
-	};
+			typename size_vector_type::bufreader_type* lcp_reader = (_lcp == nullptr) ? nullptr : new typename size_vector_type::bufreader_type(*_lcp);
 
+			uint64 pos = 0;
 
-	/// \brief RMQ
-	///
-	/// Given SA[k] and SA[k + 1] respectively induced from SA[i] and SA[j], the LCP-value of suf(SA[k]) and suf(SA[k + 1])
-	/// is determined by LCP[i + 1, j]. 
-	/// The response to the range-minimum query for LCP[i + 1, j] returns the minimum value among LCP[i + 1], .., LCP[j - 1], LCP[j].
-	struct RMQ {
-	private:
+			bool is_right = true;
 
-		const alphabet_type ch_max;
+			for (; !m_sorter->empty(); ++(*m_sorter)) {
 
-		const size_type val_max;
+				const quadruple1_type& tuple = *(*m_sorter);
 
-		std::vector<size_type> m_rmq;
+				for (; pos < tuple.first; ++pos) { // skip to the expected position
 
-	public:
+					++sa_reader;
 
-		/// \brief ctor
-		RMQ() : ch_max(std::numeric_limits<alphabet_type>::max()), val_max(std::numeric_limits<size_type>::max()) {
+					if (lcp_reader != nullptr) ++(*lcp_reader);
+				}
 
-			m_rmq.resize(ch_max + 1, 0);
-		}
+				if ((tuple.forth & CHECK_SA) && *sa_reader != tuple.second) {
 
-		/// \brief getter 
-		/// 
-		size_type get(const alphabet_type _ch) {
+					std::cerr << "SA-value is wrong\n";
 
-			return m_rmq[_ch];
-		}
+					is_right = false;
 
-		/// \brief update
-		///
-		/// scan all the elements in m_rmq, update m_rmq[ch] as _val if m_rmq[ch] > _val.
-		void update(size_type _val) {
+					break;
+				}
 
-			for (alphabet_extension_type ch = 0; ch <= ch_max; ++ch) {
+				if ((tuple.forth & CHECK_LCP) && *(*lcp_reader) != tuple.third) {
 
-				if (m_rmq[ch] > _val) m_rmq[ch] = _val;
-			}
+					std::cerr << "LCP-value is wrong\n";
 
-			return;
-		}
+					is_right = false;
 
-		/// \brief reset the range minimum value to val_max
-		///
-		void reset(const alphabet_type _ch) {
+					break;
+				}
+			}
 
-			m_rmq[_ch] = val_max;
+			delete lcp_reader; lcp_reader = nullptr;
 
-			return;
+			return is_right;
 		}
-
 	};
 
 	/// \brief scan SA rightward to validate the SA-values of all the L-type suffixes and the LCP-values of them and their left neighbors in SA.
@@ -954,7 +1716,11 @@ private:
 	struct RScan {
 
 	private:
-		const alphabet_type ch_max; ///< maximum character 
+		const BktInfo& m_bkt_info; ///< bucket information
+
+		const uint64 m_bkt_num; ///< number of buckets
+
+		const bool m_in_place; ///< read the induced values in place if there are few buckets, otherwise validate them by m_deferred_check
 
 		alphabet_vector_type* m_t; ///< pointer to input string
 
@@ -968,6 +1734,8 @@ private:
 
 		uint64 m_len; ///< number of elements in T/SA/LCP
 
+		bool m_dense_rmq; ///< use the dense mode of RMQ
+
 		std::vector<uint64> m_l_bkt_toscan; ///< number of L-type suffixes to be scanned in each bucket
 
 		std::vector<uint64> m_l_bkt_scanned; ///< number of L-type suffixes scanned in each bucket
@@ -986,38 +1754,73 @@ private:
 
 		uint64 m_total_lms_scanned; ///< total number of LMS suffixes already scanned
 
-		alphabet_type m_cur_l_ch; ///< L-type bucket currently being scanned
+		uint64 m_cur_l_bkt; ///< L-type bucket currently being scanned
 
-		alphabet_type m_cur_lms_ch; ///< LMS bucket currently being scanned
+		uint64 m_cur_lms_bkt; ///< LMS bucket currently being scanned
 
-		typename size_vector_type::bufreader_type* m_sa_l_reader; ///< for scan, point to the SA-value for currently scanned L-type suffix (retrieve from SA)
+		uint64 m_l_pos; ///< position of m_sa_l_reader and m_lcp_l_reader in SA if they span the whole SA
 
-		typename size_vector_type::bufreader_type* m_lcp_l_reader; ///< for scan, point to the LCP-value for currently scanned L-type suffix and its left neighbor in SA (retrieve from LCP)
+		ScanReader<size_vector_type>* m_sa_l_reader; ///< for scan, point to the SA-value for currently scanned L-type suffix (retrieve from SA)
+
+		ScanReader<size_vector_type>* m_lcp_l_reader; ///< for scan, point to the LCP-value for currently scanned L-type suffix and its left neighbor in SA (retrieve from LCP)
 
 		typename size_vector_type::bufreader_type* m_sa_lms_reader; ///< for scan, point to the SA-value for currently scanned LMS suffix (retrieve from SA_LMS)
 
 		typename size_vector_type::bufreader_type* m_lcp_lms_reader; ///< for scan, point to the LCP-value for currently scanned LMS suffixes and the rightmost LMS one on its leftside (retrieve from LCP_LMS)
 
-		std::vector<typename size_vector_type::bufreader_type*> m_sa_l_bkt_reader; // for induce, point to the SA_value for the L-type suffix next to be induced in each bucket (retrieve from SA)
+		BucketReaderPool<size_type>* m_sa_l_bkt_reader; ///< for induce, point to the SA_value for the L-type suffix next to be induced in each bucket (retrieve from SA)
+
+		BucketReaderPool<size_type>* m_lcp_l_bkt_reader; ///< for induce, point to the LCP_value for the L-type suffix next to be induced in each bucket and its left neighbor in SA (retrieve from LCP)
+
+		std::vector<uint64> m_l_bkt_induced; ///< number of L-type suffixes induced into each bucket, if not read in place
+
+		DeferredCheck* m_deferred_check; ///< expected induced values, if not read in place
 
-		std::vector<typename size_vector_type::bufreader_type*> m_lcp_l_bkt_reader; // for induce, point to the LCP_value for the L-type suffix next to be induced in each bucket and its left neighbor in SA (retrieve from LCP)
+		const bool m_build; ///< build the LCP-values of the L-type suffixes instead of validating them
+
+		BucketQueuePool<size_type>* m_lcp_l_bkt_queue; ///< LCP-values induced into each L-type bucket, written to the LCP file in place and read back by the scan, if building
+
+		FingerprintLCE<alphabet_vector_type, fingerprint_type>* m_lce; ///< LCP-values of the suffixes not adjacent in SA or in SA_LMS, not owned
+
+		const bool m_sa_only; ///< validate the SA-values of the L-type suffixes only, LCP and LCP_LMS are not given
+
+		const std::string m_sa_fn; ///< SA file, read by the bucket readers and the scan readers
+
+		const std::string m_lcp_fn; ///< LCP file, read by the bucket readers and the scan readers
+
+		const Config& m_config; ///< run-time settings
 
 	public:
 		/// \brief ctor
 		///
+		/// If building, _lcp is not used and the LCP-values are written to _lcp_fn, which must have the size of LCP.
+		/// If validating SA alone, _lcp and _lcp_lms are nullptr.
 		RScan(BktInfo& _bkt_info, 
 			alphabet_vector_type* _t, 
 			size_vector_type* _sa, 
 			size_vector_type* _lcp, 
 			size_vector_type* _sa_lms, 
-			size_vector_type* _lcp_lms) :
-			ch_max(std::numeric_limits<alphabet_type>::max()), 
+			size_vector_type* _lcp_lms,
+			const std::string& _sa_fn,
+			const std::string& _lcp_fn,
+			FingerprintLCE<alphabet_vector_type, fingerprint_type>* _lce,
+			const Config& _config) :
+			m_bkt_info(_bkt_info), 
+			m_bkt_num(_bkt_info.get_bkt_num()), 
+			m_in_place(m_bkt_num <= MAX_BKT_READER_NUM), 
 			m_t(_t), 
 			m_sa(_sa), 
 			m_lcp(_lcp), 
 			m_sa_lms(_sa_lms), 
 			m_lcp_lms(_lcp_lms),
-			m_len(m_t->size()) {
+			m_len(m_t->size()),
+			m_dense_rmq(_config.rmq_dense),
+			m_build(_config.build_lcp),
+			m_lce(_lce),
+			m_sa_only(_config.sa_only),
+			m_sa_fn(_sa_fn),
+			m_lcp_fn(_lcp_fn),
+			m_config(_config) {
 
 			//
 			m_total_l_toscan = m_total_l_scanned = 0;
@@ -1027,75 +1830,91 @@ private:
 			//
 			uint64 spos = 0;
 
-			for (alphabet_extension_type ch = 0; ch <= ch_max; ++ch) {
+			for (uint64 bkt = 0; bkt < m_bkt_num; ++bkt) {
 
-				m_l_bkt_toscan.push_back(_bkt_info.get_l_bkt_size(ch));
+				m_l_bkt_toscan.push_back(_bkt_info.get_l_bkt_size(bkt));
 
-				m_lms_bkt_toscan.push_back(_bkt_info.get_lms_bkt_size(ch));
+				m_lms_bkt_toscan.push_back(_bkt_info.get_lms_bkt_size(bkt));
 
-				m_total_l_toscan += m_l_bkt_toscan[ch];
+				m_total_l_toscan += m_l_bkt_toscan[bkt];
 
-				m_total_lms_toscan += m_lms_bkt_toscan[ch];
+				m_total_lms_toscan += m_lms_bkt_toscan[bkt];
 
 				m_l_bkt_spos.push_back(spos);
 
-				spos += _bkt_info.get_bkt_size(ch); // move to the start pos of next bucket
+				spos += _bkt_info.get_bkt_size(bkt); // move to the start pos of next bucket
 			}
 
-			m_l_bkt_scanned.resize(ch_max + 1, 0);
+			m_l_bkt_scanned.resize(m_bkt_num, 0);
+
+			m_lms_bkt_scanned.resize(m_bkt_num, 0);
 
-			m_lms_bkt_scanned.resize(ch_max + 1, 0);
+			//
+			m_sa_l_reader = m_lcp_l_reader = nullptr;
 
-			//			
-			for (alphabet_extension_type ch = 0; ch <= ch_max; ++ch) { // determine the leftmost non-empty L-type bucket
+			m_cur_l_bkt = m_cur_lms_bkt = 0;
 
-				if (m_l_bkt_toscan[ch] != 0) {
+			if (!m_in_place) { // scan the L-type buckets by a pair of readers spanning SA and LCP, skipping the S-type buckets
 
-					m_sa_l_reader = new typename size_vector_type::bufreader_type(m_sa->begin() + m_l_bkt_spos[ch], m_sa->begin() + m_l_bkt_spos[ch] + m_l_bkt_toscan[ch]);
+				m_sa_l_reader = new ScanReader<size_vector_type>(*m_sa, m_sa_fn, m_config);
 
-					m_lcp_l_reader = new typename size_vector_type::bufreader_type(m_lcp->begin() + m_l_bkt_spos[ch], m_lcp->begin() + m_l_bkt_spos[ch] + m_l_bkt_toscan[ch]);
-	
-					m_cur_l_ch = static_cast<alphabet_type>(ch); 
-					
-					break;
-				}
+				if (!m_sa_only) m_lcp_l_reader = new ScanReader<size_vector_type>(*m_lcp, m_lcp_fn, m_config);
 			}
 
-			//
-			for (alphabet_extension_type ch = 0; ch <= ch_max; ++ch) { // determine the leftmost non-empty LMS bucket
+			m_l_pos = 0;
 
-				if (m_lms_bkt_toscan[ch] != 0) { 
-					
-					m_cur_lms_ch = static_cast<alphabet_type>(ch);
+			if (m_total_l_toscan != 0) { // determine the leftmost non-empty L-type bucket
 
-					break; 
-				}
+				find_next_l_bkt();
+			}
+
+			if (m_total_lms_toscan != 0) { // determine the leftmost non-empty LMS bucket
+
+				find_next_lms_bkt();
 			}
 
 			m_sa_lms_reader = new typename size_vector_type::bufreader_type(*m_sa_lms);
 
-			m_lcp_lms_reader = new typename size_vector_type::bufreader_type(*m_lcp_lms);
+			m_lcp_lms_reader = m_sa_only ? nullptr : new typename size_vector_type::bufreader_type(*m_lcp_lms);
 
 			//
-			m_sa_l_bkt_reader.resize(ch_max + 1);
+			const uint64 scan_num = _config.concurrent_scan ? 2 : 1; // RScan and LScan share the memory if running concurrently
 
-			m_lcp_l_bkt_reader.resize(ch_max + 1);
+			m_deferred_check = nullptr;
 
-			for (alphabet_extension_type ch = 0; ch <= ch_max; ++ch) {
+			m_sa_l_bkt_reader = m_lcp_l_bkt_reader = nullptr;
 
-				if (m_l_bkt_toscan[ch] != 0) {
+			m_lcp_l_bkt_queue = nullptr;
 
-					m_sa_l_bkt_reader[ch] = new typename size_vector_type::bufreader_type(m_sa->begin() + m_l_bkt_spos[ch], m_sa->begin() + m_l_bkt_spos[ch] + m_l_bkt_toscan[ch]);
+			if (m_build) { // requires m_in_place, checked by the caller, the budget is shared by SA and LCP
 
-					m_lcp_l_bkt_reader[ch] = new typename size_vector_type::bufreader_type(m_lcp->begin() + m_l_bkt_spos[ch], m_lcp->begin() + m_l_bkt_spos[ch] + m_l_bkt_toscan[ch]);
-				}
-				else {
+				m_sa_l_bkt_reader = new BucketReaderPool<size_type>(_sa_fn, m_l_bkt_spos, m_l_bkt_toscan, false, _config.bkt_buf_size / 2, _config.io_uring);
 
-					m_sa_l_bkt_reader[ch] = nullptr;
+				m_lcp_l_bkt_queue = new BucketQueuePool<size_type>(_lcp_fn, m_l_bkt_spos, m_l_bkt_toscan, false, _config.bkt_buf_size / 2);
 
-					m_lcp_l_bkt_reader[ch] = nullptr;
-				}
+				return;
+			}
+
+			if (!m_in_place) {
+
+				m_l_bkt_induced.resize(m_bkt_num, 0);
+
+				m_deferred_check = new DeferredCheck(MAIN_MEM_AVAIL / 4 / scan_num);
+
+				return;
+			}
+
+			if (m_sa_only) {
+
+				m_sa_l_bkt_reader = new BucketReaderPool<size_type>(_sa_fn, m_l_bkt_spos, m_l_bkt_toscan, false, _config.bkt_buf_size / scan_num, _config.io_uring);
+
+				return;
 			}
+
+			// the budget is shared by SA and LCP
+			m_sa_l_bkt_reader = new BucketReaderPool<size_type>(_sa_fn, m_l_bkt_spos, m_l_bkt_toscan, false, _config.bkt_buf_size / 2 / scan_num, _config.io_uring);
+
+			m_lcp_l_bkt_reader = new BucketReaderPool<size_type>(_lcp_fn, m_l_bkt_spos, m_l_bkt_toscan, false, _config.bkt_buf_size / 2 / scan_num, _config.io_uring);
 		}
 
 		/// \brief check if no more L-type to be scanned
@@ -1116,14 +1935,14 @@ private:
 		///
 		bool l_cur_bkt_is_empty() {
 
-			return m_l_bkt_scanned[m_cur_l_ch] == m_l_bkt_toscan[m_cur_l_ch];
+			return m_l_bkt_scanned[m_cur_l_bkt] == m_l_bkt_toscan[m_cur_l_bkt];
 		}
 
 		/// \brief check if no more LMS suffixes to be scanned in current bucket
 		///
 		bool lms_cur_bkt_is_empty() {
 
-			return m_lms_bkt_scanned[m_cur_lms_ch] == m_lms_bkt_toscan[m_cur_lms_ch];
+			return m_lms_bkt_scanned[m_cur_lms_bkt] == m_lms_bkt_toscan[m_cur_lms_bkt];
 		}
 
 		/// \brief find next non-empty L-bucket
@@ -1132,20 +1951,43 @@ private:
 		void find_next_l_bkt() {
 
 			// if finished reading current L-type bucket, then find a non-empty L-type bucket
-			// because there exist at least one element to be read, we must have m_l_bkt_scanned[ch] == m_l_bkt_toscan[ch] for some ch <= ch_max
+			// because there exist at least one element to be read, we must have m_l_bkt_scanned[bkt] != m_l_bkt_toscan[bkt] for some bkt < m_bkt_num
 			while (l_cur_bkt_is_empty()) {
 
-				++m_cur_l_ch;
+				++m_cur_l_bkt;
+			}
+
+			open_l_bkt();
+
+			return;
+		}
+
+		/// \brief move the pointers to the starting positions of the current L-type bucket in SA and LCP
+		///
+		/// If the readers span SA and LCP, skip the elements in between, otherwise re-create them for the bucket.
+		void open_l_bkt() {
+
+			if (!m_in_place) {
+
+				for (; m_l_pos < m_l_bkt_spos[m_cur_l_bkt]; ++m_l_pos) {
+
+					++(*m_sa_l_reader);
+
+					if (m_lcp_l_reader != nullptr) ++(*m_lcp_l_reader);
+				}
+
+				return;
 			}
 
-			// move the pointers to the starting positions of the non-empty L-type bucket in SA and LCP
 			delete m_sa_l_reader;
 
-			m_sa_l_reader = new typename size_vector_type::bufreader_type(m_sa->begin() + m_l_bkt_spos[m_cur_l_ch], m_sa->begin() + m_l_bkt_spos[m_cur_l_ch] + m_l_bkt_toscan[m_cur_l_ch]);
+			m_sa_l_reader = new ScanReader<size_vector_type>(*m_sa, m_sa_fn, m_l_bkt_spos[m_cur_l_bkt], m_l_bkt_spos[m_cur_l_bkt] + m_l_bkt_toscan[m_cur_l_bkt], m_config);
+
+			if (m_build || m_sa_only) return; // if building, LCP-values are read back from m_lcp_l_bkt_queue
 
 			delete m_lcp_l_reader;
 
-			m_lcp_l_reader = new typename size_vector_type::bufreader_type(m_lcp->begin() + m_l_bkt_spos[m_cur_l_ch], m_lcp->begin() + m_l_bkt_spos[m_cur_l_ch] + m_l_bkt_toscan[m_cur_l_ch]);
+			m_lcp_l_reader = new ScanReader<size_vector_type>(*m_lcp, m_lcp_fn, m_l_bkt_spos[m_cur_l_bkt], m_l_bkt_spos[m_cur_l_bkt] + m_l_bkt_toscan[m_cur_l_bkt], m_config);
 
 			return;
 		}
@@ -1156,10 +1998,10 @@ private:
 		void find_next_lms_bkt() {
 
 			// if finished reading current LMS bucket, then find a non-empty LMS bucket
-			// because there exist at least one element to be read, we must have m_lms_bkt_scanned[ch] == m_lms_bkt_toscan[ch] for some ch <= ch_max
+			// because there exist at least one element to be read, we must have m_lms_bkt_scanned[bkt] != m_lms_bkt_toscan[bkt] for some bkt < m_bkt_num
 			while (lms_cur_bkt_is_empty()) {
 
-				++m_cur_lms_ch;
+				++m_cur_lms_bkt;
 			}
 
 			// no need to relocate pointers to SA_LMS and LCP_LMS
@@ -1175,9 +2017,22 @@ private:
 
 			_sa_value = *(*m_sa_l_reader), ++(*m_sa_l_reader);
 
-			_lcp_value = *(*m_lcp_l_reader), ++(*m_lcp_l_reader);
+			if (m_build) {
+
+				_lcp_value = m_lcp_l_bkt_queue->pop(m_cur_l_bkt);
+			}
+			else if (m_sa_only) {
+
+				_lcp_value = 0;
+			}
+			else {
+
+				_lcp_value = *(*m_lcp_l_reader), ++(*m_lcp_l_reader);
+			}
+
+			++m_l_pos;
 
-			++m_l_bkt_scanned[m_cur_l_ch];
+			++m_l_bkt_scanned[m_cur_l_bkt];
 
 			++m_total_l_scanned;
 
@@ -1193,69 +2048,94 @@ private:
 
 			_sa_value = *(*m_sa_lms_reader), ++(*m_sa_lms_reader);
 
-			_lcp_value = *(*m_lcp_lms_reader), ++(*m_lcp_lms_reader);
+			if (m_sa_only) {
+
+				_lcp_value = 0;
+			}
+			else {
+
+				_lcp_value = *(*m_lcp_lms_reader), ++(*m_lcp_lms_reader);
+			}
 
-			++m_lms_bkt_scanned[m_cur_lms_ch];
+			++m_lms_bkt_scanned[m_cur_lms_bkt];
 
 			++m_total_lms_scanned;
 
 			return;
 		}
 
-		/// \brief fetch the SA-value for currently induced L-type suffix and the LCP-value for the suffix and its left neighbor in SA
+		/// \brief validate the SA-value for currently induced L-type suffix and the LCP-value for the suffix and its left neighbor in SA
 		/// 
-		/// retrieve the values from SA and LCP
-		void fetch_l_induced(const alphabet_type _ch, size_type& _sa_value, size_type& _lcp_value) {
+		/// retrieve the values from SA and LCP if read in place, otherwise defer the validation
+		/// If building, validate the SA-value and record the LCP-value instead, which is 0 for the leftmost suffix in the L-type bucket.
+		/// \param _check_lcp false if the suffix is the leftmost in the L-type bucket
+		bool check_l_induced(const uint64 _bkt, const size_type _sa_value, const size_type _lcp_value, const bool _check_lcp) {
 
-			_sa_value = *(*m_sa_l_bkt_reader[_ch]), ++(*m_sa_l_bkt_reader[_ch]);
+			if (!m_in_place) {
 
-			_lcp_value = *(*m_lcp_l_bkt_reader[_ch]), ++(*m_lcp_l_bkt_reader[_ch]);
+				if (m_l_bkt_induced[_bkt] == m_l_bkt_toscan[_bkt]) { // more suffixes than the bucket size
 
-			return;
-		}
+					std::cerr << "SA-value is wrong\n";
 
-		/// \brief return the initial character of suffixes in current scanned bucket
-		///
-		alphabet_type get_l_bkt_ch() {
+					return false;
+				}
 
-			return m_cur_l_ch;
-		}
+				const uint64 pos = m_l_bkt_spos[_bkt] + m_l_bkt_induced[_bkt]++;
 
-		/// \brief return the initial character of suffixes in current scanned bucket
-		//
-		alphabet_type get_lms_bkt_ch() {
+				if (_check_lcp && !m_sa_only) m_deferred_check->push_both(pos, _sa_value, _lcp_value); else m_deferred_check->push_sa(pos, _sa_value);
 
-			return m_cur_lms_ch;
-		}
+				return true;
+			}
 
-		/// \brief literally compare two suffixes pointed to by the starting positions 
-		///
-		uint64 bruteforce_compute_lcp(const size_type& _pos1, const size_type& _pos2) {
+			const size_type sa_value_fetch = m_sa_l_bkt_reader->next(_bkt);
+
+			if (_sa_value != sa_value_fetch) {
 
-			typename alphabet_vector_type::const_iterator it1(m_t->begin() + _pos1), it2(m_t->begin() + _pos2);
+				std::cerr << "SA-value is wrong\n";
 
-			uint64 lcp = 0;
+				return false;
+			}
 
-			if (_pos1 < _pos2) {
+			if (m_sa_only) return true;
 
-				for (; it2 != m_t->end(); ++it2, ++it1) {
+			if (m_build) {
 
-					if (*it1 != *it2) break;
+				m_lcp_l_bkt_queue->push(_bkt, _check_lcp ? _lcp_value : size_type(0)); // never full, as the SA-values are not
 
-					++lcp;
-				}
+				return true;
 			}
-			else {
 
-				for (; it1 != m_t->end(); ++it1, ++it2) {
+			const size_type lcp_value_fetch = m_lcp_l_bkt_reader->next(_bkt);
 
-					if (*it1 != *it2) break;
+			if (_check_lcp && _lcp_value != lcp_value_fetch) {
 
-					++lcp;
-				}
+				std::cerr << "LCP-value is wrong\n";
+
+				return false;
 			}
 
-			return lcp;
+			return true;
+		}
+
+		/// \brief return the bucket currently scanned
+		///
+		uint64 get_l_bkt() {
+
+			return m_cur_l_bkt;
+		}
+
+		/// \brief return the bucket currently scanned
+		//
+		uint64 get_lms_bkt() {
+
+			return m_cur_lms_bkt;
+		}
+
+		/// \brief compute the LCP-value of two suffixes pointed to by the starting positions, literally if short and by fingerprints if long
+		///
+		uint64 compute_lcp(const size_type& _pos1, const size_type& _pos2) {
+
+			return m_lce->compute(_pos1, _pos2);
 		}
 
 
@@ -1271,12 +2151,13 @@ private:
 
 			delete m_lcp_lms_reader; m_lcp_lms_reader = nullptr;
 
-			for (alphabet_extension_type ch = 0; ch <= ch_max; ++ch) {
+			delete m_sa_l_bkt_reader; m_sa_l_bkt_reader = nullptr;
 
-				delete m_sa_l_bkt_reader[ch]; m_sa_l_bkt_reader[ch] = nullptr;
+			delete m_lcp_l_bkt_reader; m_lcp_l_bkt_reader = nullptr;
 
-				delete m_lcp_l_bkt_reader[ch]; m_lcp_l_bkt_reader[ch] = nullptr;
-			}
+			delete m_deferred_check; m_deferred_check = nullptr;
+
+			delete m_lcp_l_bkt_queue; m_lcp_l_bkt_queue = nullptr;
 		}
 
 		/// \brief induce and check the order of L-type suffixes and their LCP values 
@@ -1284,32 +2165,32 @@ private:
 		/// The SA-value of currently scanned suffix (no matter L-type or LMS) can be directly retrieved from SA or SA_LMS. 
 		/// The question is how to retrieve the LCP-value of the suffix and the last scanned one (may not be the neighbor in SA). 
 		///	case 1: if currently scanned suffix is L-type, then retrieve the LCP-value following one of the two sub-cases as below:
-		///         sub-case (a): if the suffix is the leftmost in the L-type bucket, then perform a literal comparison between the suffix and the last scanned one to obtain their LCP-value.
+		///         sub-case (a): if the suffix is the leftmost in the L-type bucket, then compare the suffix and the last scanned one to obtain their LCP-value, see FingerprintLCE.
 		///	    sub-case (b): otherwise, the last scanned is also the left neighbor in SA, retrieve the LCP-value from LCP.
 		///	case 2: if currently scanned suffix is LMS, then retrieve the LCP-value following one of the two sub-cases as below:
-		///	    sub-case (a): if the suffix is the leftmost in the LMS bucket and the last scanned is L-type, then perform a literal comparison between the suffix and the last scanned to obtain their LCP-value.
+		///	    sub-case (a): if the suffix is the leftmost in the LMS bucket and the last scanned is L-type, then compare the suffix and the last scanned to obtain their LCP-value, see FingerprintLCE.
 		///	    sub-case (b): otherwise, the last scanned is also the left neighbor in SA_LMS, retrieve the LCP-value from LCP_LMS.
 		/// The SA-value of currently induced L-type suffix can be directly retrieved from SA or SA_LMS.
 		/// The question is how to retrieve the LCP-value of the suffix and the last induced.
 		///	case 1: if currently induced suffix is the leftmost in the L-type bucket, then do nothing.
 		///	case 2: otherwise, the LCP-value is 1 + RMQ_VALUE. 
-		bool run(triple2_less_sorter_1st_type* _pre_item_of_l_sorter, pair3_less_sorter_1st_type* _pre_item_of_lms_sorter) {
+		bool run(pair4_vector_type* _pre_item_of_l_vector, pair3_less_sorter_1st_type* _pre_item_of_lms_sorter) {
 
-			alphabet_type cur_bkt_ch, pre_ch;
+			uint64 cur_bkt, pre_bkt;
 
 			uint8 pre_t;
 
-			size_type sv_cur_scanned, lv_cur_scanned, sv_last_scanned, lv_last_scanned; // scanned SA-value & LCP-value
+			size_type sv_cur_scanned, lv_cur_scanned, sv_last_scanned; // scanned SA-value & LCP-value
 
-			size_type sv_induced, lv_induced, sv_induced_fetch, lv_induced_fetch; // induced SA-value & LCP-value
+			size_type sv_induced, lv_induced; // induced SA-value & LCP-value
 
-			RMQ rmq_l;
+			RMQ rmq_l(m_bkt_num, m_dense_rmq);
 
 			bool flag = true; // indicate whether or not the scanned suffix is the leftmost in the L-type/LMS bucket
 
-			bool flags[ch_max + 1]; // whether or not the induced suffix is the leftmost in the L-type bucket
+			std::vector<uint8> flags(m_bkt_num, 1); // whether or not the induced suffix is the leftmost in the L-type bucket
 
-			for (alphabet_extension_type ch = 0; ch <= ch_max; ++ch) flags[ch] = true;
+			typename pair4_vector_type::bufreader_type pre_item_of_l_reader(*_pre_item_of_l_vector);
 
 			{ // process the virtual sentinel
 
@@ -1324,28 +2205,19 @@ private:
 				// step 3: induce and validate the SA-value and LCP-value of the preceding suffix in T
 				auto rit = m_t->rbegin();
 
-				pre_ch = *rit, pre_t = L_TYPE; // the rightmost character must be L-type
-		
-				fetch_l_induced(pre_ch, sv_induced_fetch, lv_induced_fetch); // retrieve the induced value from SA & LCP 
+				pre_bkt = m_bkt_info.get_bkt(*rit), pre_t = L_TYPE; // the rightmost character must be L-type
 
 				sv_induced = sv_cur_scanned - 1; // induce SA-value from currently scanned
 
-				if (sv_induced_fetch != sv_induced) { // validate induced SA-value
-					
-					std::cerr << "SA-value is not correct\n";
-
-					return false;
-				}
-
 				// the induced suffix is the leftmost in the L-type bucket, skip computing & validating the LCP-value
-				flags[pre_ch] = false;
+				if (false == check_l_induced(pre_bkt, sv_induced, 0, false)) return false; // validate induced SA-value
+
+				flags[pre_bkt] = false;
 			
-				rmq_l.reset(pre_ch); // reset rmq
+				rmq_l.reset(pre_bkt); // reset rmq
 
 				// step 5: iterates
 				sv_last_scanned = sv_cur_scanned;
-
-				lv_last_scanned = lv_cur_scanned;
 			}
 
 			{ // process the remaing
@@ -1358,31 +2230,31 @@ private:
 					return false;
 				}
 
-				cur_bkt_ch = get_l_bkt_ch();
+				cur_bkt = get_l_bkt();
 
-				if (!lms_is_empty() && get_lms_bkt_ch() < cur_bkt_ch) {
+				if (!lms_is_empty() && get_lms_bkt() < cur_bkt) {
 
-					cur_bkt_ch = get_lms_bkt_ch();
+					cur_bkt = get_lms_bkt();
 				}
 
 				// scan buckets in sequence
 				while (true) {
 
 					// scan the L-type bucket
-					while (!l_cur_bkt_is_empty() && get_l_bkt_ch() == cur_bkt_ch) {
+					while (!l_cur_bkt_is_empty() && get_l_bkt() == cur_bkt) {
 
 						// step 1: retrieve SA-value & LCP-value from SA & LCP
 						fetch_l_scanned(sv_cur_scanned, lv_cur_scanned);
 
 						if (flag == true) {// leftmost in the L-type bucket, can not use the value from LCP
 
-							if (m_len == sv_last_scanned) { // last scanned suffix is the sentinel
+							if (m_len == sv_last_scanned || m_sa_only) { // last scanned suffix is the sentinel, or LCP-values are not validated
 							
 								lv_cur_scanned = 0;
 							}
-							else { // bruteforce, actually must be 0 if correct
+							else { // actually must be 0 if correct
 
-								lv_cur_scanned = bruteforce_compute_lcp(sv_last_scanned, sv_cur_scanned);
+								lv_cur_scanned = compute_lcp(sv_last_scanned, sv_cur_scanned);
 							}
 
 							flag = false;
@@ -1392,68 +2264,48 @@ private:
 						rmq_l.update(lv_cur_scanned);
 
 						// step 3: induce and validate
-						pre_ch = (*_pre_item_of_l_sorter)->second;
-
-						pre_t = (*_pre_item_of_l_sorter)->third;
-
-						++(*_pre_item_of_l_sorter);
+						pre_t = pre_item_of_l_reader->second;
 
 						if (pre_t == L_TYPE) {
 
-							fetch_l_induced(pre_ch, sv_induced_fetch, lv_induced_fetch);
+							pre_bkt = m_bkt_info.get_bkt(pre_item_of_l_reader->first);
 
 							sv_induced = sv_cur_scanned - 1;
 
-							if (sv_induced != sv_induced_fetch) {
-
-								std::cerr << "SA-value is wrong\n";
-
-								return false;
-							}
-
-							if (flags[pre_ch] == true) { // leftmost
-								
-								// skip computing & validating the LCP-value
-								flags[pre_ch] = false;
-							}
-							else {
-
-								lv_induced = rmq_l.get(pre_ch) + 1;
+							const bool is_leftmost = (flags[pre_bkt] != 0); // if leftmost, skip computing & validating the LCP-value
 
-								if (lv_induced != lv_induced_fetch) {
+							flags[pre_bkt] = false;
 
-									std::cerr << "LCP-value is wrong\n";
+							lv_induced = is_leftmost ? 0 : rmq_l.get(pre_bkt) + 1;
 
-									return false;
-								}
-							}
+							if (false == check_l_induced(pre_bkt, sv_induced, lv_induced, !is_leftmost)) return false;
 
-							rmq_l.reset(pre_ch); // reset rmq
+							rmq_l.reset(pre_bkt); // reset rmq
 						}
 
+						++pre_item_of_l_reader;
+
 						// iterates
 						sv_last_scanned = sv_cur_scanned;
-
-						lv_last_scanned = lv_cur_scanned;
 					}
 
 					flag = true;
 
 					// scan S-type bucket
-					while (!lms_cur_bkt_is_empty() && get_lms_bkt_ch() == cur_bkt_ch) {
+					while (!lms_cur_bkt_is_empty() && get_lms_bkt() == cur_bkt) {
 
 						// step 1: retrieve SA-value & LCP-value from SA_LMS & LCP_LMS
 						fetch_lms_scanned(sv_cur_scanned, lv_cur_scanned);
 
 						if (flag == true) { // leftmost in the LMS bucket, cannot use the value from LCP_LMS
 
-							if (m_len == sv_last_scanned) { // left neighbor is sentinel
+							if (m_len == sv_last_scanned || m_sa_only) { // left neighbor is sentinel, or LCP-values are not validated
 
 								lv_cur_scanned = 0;
 							}
 							else {
 
-								lv_cur_scanned = bruteforce_compute_lcp(sv_last_scanned, sv_cur_scanned);
+								lv_cur_scanned = compute_lcp(sv_last_scanned, sv_cur_scanned);
 							}
 
 							flag = false;
@@ -1463,45 +2315,25 @@ private:
 						rmq_l.update(lv_cur_scanned);
 
 						// step 3: the preceding must be L-type, induce and validate
-						pre_ch = (*_pre_item_of_lms_sorter)->second;
+						pre_bkt = m_bkt_info.get_bkt((*_pre_item_of_lms_sorter)->second);
 
 						++(*_pre_item_of_lms_sorter);
 
-						fetch_l_induced(pre_ch, sv_induced_fetch, lv_induced_fetch);
-
 						sv_induced = sv_cur_scanned - 1;
-	
-						if (sv_induced != sv_induced_fetch) {
-	
-							std::cerr << "SA-value is wrong\n";
-
-							return false;
-						}
-
-						if (flags[pre_ch] == true) { // leftmost 
-
-							// skip computing the LCP-value
-							flags[pre_ch] = false;
-						}
-						else {
 
-							lv_induced = rmq_l.get(pre_ch) + 1;
+						const bool is_leftmost = (flags[pre_bkt] != 0); // if leftmost, skip computing the LCP-value
 
-							if (lv_induced != lv_induced_fetch) {
+						flags[pre_bkt] = false;
 
-								std::cerr << "LCP-value is wrong\n";
+						lv_induced = is_leftmost ? 0 : rmq_l.get(pre_bkt) + 1;
 
-								return false;
-							}
-						}
+						if (false == check_l_induced(pre_bkt, sv_induced, lv_induced, !is_leftmost)) return false;
 
 						// reset RMQ
-						rmq_l.reset(pre_ch);
+						rmq_l.reset(pre_bkt);
 
 						// iterates
 						sv_last_scanned = sv_cur_scanned;
-
-						lv_last_scanned = lv_cur_scanned;
 					}
 
 					flag = true;
@@ -1511,15 +2343,15 @@ private:
 
 						find_next_l_bkt();
 
-						cur_bkt_ch = get_l_bkt_ch();
+						cur_bkt = get_l_bkt();
 
 						if (!lms_is_empty()) {
 
 							find_next_lms_bkt();
 
-							if (cur_bkt_ch > get_lms_bkt_ch()) {
+							if (cur_bkt > get_lms_bkt()) {
 
-								cur_bkt_ch = get_lms_bkt_ch();
+								cur_bkt = get_lms_bkt();
 							}
 						}
 					}
@@ -1527,7 +2359,7 @@ private:
 
 						find_next_lms_bkt();
 
-						cur_bkt_ch = get_lms_bkt_ch();
+						cur_bkt = get_lms_bkt();
 					}
 					else {
 
@@ -1536,10 +2368,14 @@ private:
 				}
 			}
 
-			assert(_pre_item_of_l_sorter->size() == 0);
+			assert(pre_item_of_l_reader.empty());
 
 			assert(_pre_item_of_lms_sorter->size() == 0);
 
+			if (m_build) return m_lcp_l_bkt_queue->finish();
+
+			if (!m_in_place) return m_deferred_check->run(m_sa, m_lcp);
+
 			return true;
 		}
 	};
@@ -1551,7 +2387,11 @@ private:
 
 	private:
 
-		const alphabet_type ch_max; ///< maximum character
+		const BktInfo& m_bkt_info; ///< bucket information
+
+		const uint64 m_bkt_num; ///< number of buckets
+
+		const bool m_in_place; ///< read the induced values in place if there are few buckets, otherwise validate them by m_deferred_check
 
 		alphabet_vector_type* m_t; ///< pointer to the input string
 
@@ -1559,6 +2399,8 @@ private:
 
 		size_vector_type* m_lcp; ///< pointer to the LCP array
 
+		bool m_dense_rmq; ///< use the dense mode of RMQ
+
 		std::vector<uint64> m_s_bkt_toscan; ///< number of S-type suffixes to be scanned in each bucket
 
 		std::vector<uint64> m_s_bkt_scanned; ///< number of S-type suffixes scanned in each bucket
@@ -1579,29 +2421,55 @@ private:
 
 		uint64 m_total_l_scanned; ///< total number of L-type suffixes already scanned
 
-		alphabet_type m_cur_s_ch; ///< S-type bucket currently being scanned
+		uint64 m_cur_s_bkt; ///< S-type bucket currently being scanned
+
+		uint64 m_cur_l_bkt; ///< L-type bucket currently being scanned
+
+		ScanReader<size_vector_type, true>* m_sa_rev_reader; ///< for scan, point to the SA-value for currently scanned suffix (retrieve from SA, leftward)
+
+		ScanReader<size_vector_type, true>* m_lcp_rev_reader; ///< for scan, point to the LCP-value for currently scanned suffix and its right neighbor in SA (retrieve from LCP, leftward)
+
+		BucketReaderPool<size_type>* m_sa_s_bkt_rev_reader; ///< for induce, point to the SA-value for the S-type suffix to be induced in each bucket (retrievd from SA, leftward)
+
+		BucketReaderPool<size_type>* m_lcp_s_bkt_rev_reader; ///< for induce, point to the LCP-value for the S-type suffix to be induced in each bucket (retrieved from LCP, leftward)
+
+		std::vector<size_type> m_last_lv_induced_fetch; ///< LCP-value of the last S-type suffix induced into each bucket, if read in place
 
-		alphabet_type m_cur_l_ch; ///< L-type bucket currently being scanned
+		std::vector<uint64> m_s_bkt_induced; ///< number of S-type suffixes induced into each bucket, if not read in place
 
-		typename size_vector_type::bufreader_reverse_type* m_sa_rev_reader; ///< for scan, point to the SA-value for currently scanned suffix (retrieve from SA, leftward)
+		DeferredCheck* m_deferred_check; ///< expected induced values, if not read in place
 
-		typename size_vector_type::bufreader_reverse_type* m_lcp_rev_reader; ///< for scan, point to the LCP-value for currently scanned suffix and its right neighbor in SA (retrieve from LCP, leftward)
+		const bool m_build; ///< build the LCP-values of the S-type suffixes instead of validating them
 
-		std::vector<typename size_vector_type::bufreader_reverse_type*> m_sa_s_bkt_rev_reader; ///< for induce, point to the SA-value for the S-type suffix to be induced in each bucket (retrievd from SA, leftward)
+		BucketQueuePool<size_type>* m_lcp_s_bkt_queue; ///< LCP-values induced into each S-type bucket, written to the LCP file in place and read back by the scan, if building
 
-		std::vector<typename size_vector_type::bufreader_reverse_type*> m_lcp_s_bkt_rev_reader; ///< for induce, point to the LCP-value for the S-type suffix to be induced in each bucket (retrieved from LCP, leftward)
+		FingerprintLCE<alphabet_vector_type, fingerprint_type>* m_lce; ///< LCP-values of the suffixes across the S/L boundaries of the buckets, not owned
+
+		const bool m_sa_only; ///< validate the SA-values of the S-type suffixes only, LCP is not given
 
 	public:	
 		/// \brief ctor
 		///
+		/// If building, _lcp maps _lcp_fn, which already holds the LCP-values of the L-type suffixes built by RScan.
+		/// If validating SA alone, _lcp is nullptr.
 		LScan(BktInfo& _bkt_info, 
 			alphabet_vector_type* _t, 
 			size_vector_type* _sa, 
-			size_vector_type* _lcp) :
-			ch_max(std::numeric_limits<alphabet_type>::max()), 
+			size_vector_type* _lcp,
+			const std::string& _sa_fn,
+			const std::string& _lcp_fn,
+			FingerprintLCE<alphabet_vector_type, fingerprint_type>* _lce,
+			const Config& _config) :
+			m_bkt_info(_bkt_info), 
+			m_bkt_num(_bkt_info.get_bkt_num()), 
+			m_in_place(m_bkt_num <= MAX_BKT_READER_NUM), 
 			m_t(_t), 
 			m_sa(_sa), 
-			m_lcp(_lcp) {
+			m_lcp(_lcp),
+			m_dense_rmq(_config.rmq_dense),
+			m_build(_config.build_lcp),
+			m_lce(_lce),
+			m_sa_only(_config.sa_only) {
 
 			//
 			m_total_s_toscan = m_total_s_scanned = 0;
@@ -1609,88 +2477,105 @@ private:
 			m_total_l_toscan = m_total_l_scanned = 0;
 
 			//
-			m_s_bkt_toscan.resize(ch_max + 1, 0);
+			m_s_bkt_toscan.resize(m_bkt_num, 0);
 	
-			m_s_bkt_scanned.resize(ch_max + 1, 0);
+			m_s_bkt_scanned.resize(m_bkt_num, 0);
 
-			m_l_bkt_toscan.resize(ch_max + 1, 0);
+			m_l_bkt_toscan.resize(m_bkt_num, 0);
 
-			m_l_bkt_scanned.resize(ch_max + 1, 0);
+			m_l_bkt_scanned.resize(m_bkt_num, 0);
 
-			m_s_bkt_spos.resize(ch_max + 1, 0);
+			m_s_bkt_spos.resize(m_bkt_num, 0);
 
-			m_l_bkt_spos.resize(ch_max + 1, 0);
+			m_l_bkt_spos.resize(m_bkt_num, 0);
 
 			uint64 spos = 0;
 
-			for (alphabet_extension_type ch = 0; ch <= ch_max; ++ch) {
+			for (uint64 bkt = 0; bkt < m_bkt_num; ++bkt) {
 
-				m_s_bkt_toscan[ch] = _bkt_info.get_s_bkt_size(ch);
+				m_s_bkt_toscan[bkt] = _bkt_info.get_s_bkt_size(bkt);
 
-				m_l_bkt_toscan[ch] = _bkt_info.get_l_bkt_size(ch);
+				m_l_bkt_toscan[bkt] = _bkt_info.get_l_bkt_size(bkt);
 
-				m_total_s_toscan += m_s_bkt_toscan[ch];
+				m_total_s_toscan += m_s_bkt_toscan[bkt];
 
-				m_total_l_toscan += m_l_bkt_toscan[ch];
+				m_total_l_toscan += m_l_bkt_toscan[bkt];
 
-				m_l_bkt_spos[ch] = spos;
+				m_l_bkt_spos[bkt] = spos;
 
-				m_s_bkt_spos[ch] = spos + m_l_bkt_toscan[ch];
+				m_s_bkt_spos[bkt] = spos + m_l_bkt_toscan[bkt];
 
-				spos += _bkt_info.get_bkt_size(ch);				
+				spos += _bkt_info.get_bkt_size(bkt);				
 			}
 
 			//
-			for (alphabet_extension_type ch = ch_max; ch >= 0; --ch) { // find rightmost non-empty S-type bucket
+			m_cur_s_bkt = m_cur_l_bkt = 0;
 
-				if (m_s_bkt_toscan[ch] != 0) { 
+			for (uint64 bkt = m_bkt_num; bkt-- > 0; ) { // find rightmost non-empty S-type bucket
+
+				if (m_s_bkt_toscan[bkt] != 0) { 
 					
-					m_cur_s_ch = static_cast<alphabet_type>(ch); 
+					m_cur_s_bkt = bkt; 
 					
 					break; 
 				}
-
-				if (ch == 0) break;
 			}
 
 			// determine rightmost non-empty L-type bucket
-			for (alphabet_extension_type ch = ch_max; ch >= 0; --ch) { // find rightmost non-empty L-type bucket
+			for (uint64 bkt = m_bkt_num; bkt-- > 0; ) { // find rightmost non-empty L-type bucket
 
-				if (m_l_bkt_toscan[ch] != 0) { 
+				if (m_l_bkt_toscan[bkt] != 0) { 
 					
-					m_cur_l_ch = static_cast<alphabet_type>(ch);
+					m_cur_l_bkt = bkt;
 
 					break; 
 				}
-
-				if (ch == 0) break;
 			}
 
 			//
-			m_sa_rev_reader = new typename size_vector_type::bufreader_reverse_type(*m_sa);
+			m_sa_rev_reader = new ScanReader<size_vector_type, true>(*m_sa, _sa_fn, _config);
 
-			m_lcp_rev_reader = new typename size_vector_type::bufreader_reverse_type(*m_lcp);
+			m_lcp_rev_reader = m_sa_only ? nullptr : new ScanReader<size_vector_type, true>(*m_lcp, _lcp_fn, _config);
 
-			m_sa_s_bkt_rev_reader.resize(ch_max + 1);
+			const uint64 scan_num = _config.concurrent_scan ? 2 : 1; // RScan and LScan share the memory if running concurrently
 
-			m_lcp_s_bkt_rev_reader.resize(ch_max + 1);
+			m_deferred_check = nullptr;
 
-			for (alphabet_extension_type ch = 0; ch <= ch_max; ++ch) {
+			m_sa_s_bkt_rev_reader = m_lcp_s_bkt_rev_reader = nullptr;
 
-				if (m_s_bkt_toscan[ch] != 0) {
+			m_lcp_s_bkt_queue = nullptr;
 
-					m_sa_s_bkt_rev_reader[ch] = new typename size_vector_type::bufreader_reverse_type(m_sa->begin() + m_s_bkt_spos[ch], m_sa->begin() + m_s_bkt_spos[ch] + m_s_bkt_toscan[ch]);
+			if (m_build) { // requires m_in_place, checked by the caller, the budget is shared by SA and LCP
 
-					m_lcp_s_bkt_rev_reader[ch] = new typename size_vector_type::bufreader_reverse_type(m_lcp->begin() + m_s_bkt_spos[ch], m_lcp->begin() + m_s_bkt_spos[ch] + m_s_bkt_toscan[ch]);
-				}
-				else {
+				m_sa_s_bkt_rev_reader = new BucketReaderPool<size_type>(_sa_fn, m_s_bkt_spos, m_s_bkt_toscan, true, _config.bkt_buf_size / 2, _config.io_uring);
 
-					m_sa_s_bkt_rev_reader[ch] = nullptr;
+				m_lcp_s_bkt_queue = new BucketQueuePool<size_type>(_lcp_fn, m_s_bkt_spos, m_s_bkt_toscan, true, _config.bkt_buf_size / 2);
 
-					m_lcp_s_bkt_rev_reader[ch] = nullptr;
-				}
+				return;
+			}
+
+			if (!m_in_place) {
+
+				m_s_bkt_induced.resize(m_bkt_num, 0);
+
+				m_deferred_check = new DeferredCheck(MAIN_MEM_AVAIL / 4 / scan_num);
+
+				return;
+			}
+
+			if (m_sa_only) {
+
+				m_sa_s_bkt_rev_reader = new BucketReaderPool<size_type>(_sa_fn, m_s_bkt_spos, m_s_bkt_toscan, true, _config.bkt_buf_size / scan_num, _config.io_uring);
+
+				return;
 			}
 
+			m_last_lv_induced_fetch.resize(m_bkt_num, 0);
+
+			// the budget is shared by SA and LCP
+			m_sa_s_bkt_rev_reader = new BucketReaderPool<size_type>(_sa_fn, m_s_bkt_spos, m_s_bkt_toscan, true, _config.bkt_buf_size / 2 / scan_num, _config.io_uring);
+
+			m_lcp_s_bkt_rev_reader = new BucketReaderPool<size_type>(_lcp_fn, m_s_bkt_spos, m_s_bkt_toscan, true, _config.bkt_buf_size / 2 / scan_num, _config.io_uring);
 		}
 
 		/// \brief check if no more LMS to be scanned
@@ -1710,14 +2595,14 @@ private:
 		///
 		bool s_cur_bkt_is_empty() {
 
-			return m_s_bkt_scanned[m_cur_s_ch] == m_s_bkt_toscan[m_cur_s_ch];
+			return m_s_bkt_scanned[m_cur_s_bkt] == m_s_bkt_toscan[m_cur_s_bkt];
 		}
 
 		/// \brief check if no more L-type suffixes to be scanned in current bucket
 		///
 		bool l_cur_bkt_is_empty() {
 
-			return m_l_bkt_scanned[m_cur_l_ch] == m_l_bkt_toscan[m_cur_l_ch];
+			return m_l_bkt_scanned[m_cur_l_bkt] == m_l_bkt_toscan[m_cur_l_bkt];
 		}
 
 		/// \brief find next non-empty S-bucket
@@ -1725,7 +2610,7 @@ private:
 		/// \note guarantee there remains S-type suffixes to be scanned before calling the function
 		void find_next_s_bkt() {
 
-			while (s_cur_bkt_is_empty()) --m_cur_s_ch;
+			while (s_cur_bkt_is_empty()) --m_cur_s_bkt;
 
 			return;
 		}
@@ -1735,7 +2620,7 @@ private:
 		/// \note guarantee there remains L-type suffixes to be scanned before calling the function
 		void find_next_l_bkt() {
 
-			while (l_cur_bkt_is_empty()) --m_cur_l_ch;
+			while (l_cur_bkt_is_empty()) --m_cur_l_bkt;
 
 			return;
 		}
@@ -1746,9 +2631,16 @@ private:
 
 			_sa_value = *(*m_sa_rev_reader), ++(*m_sa_rev_reader);
 
-			_lcp_value = *(*m_lcp_rev_reader), ++(*m_lcp_rev_reader);
+			if (m_sa_only) {
+
+				_lcp_value = 0;
+			}
+			else {
+
+				_lcp_value = *(*m_lcp_rev_reader), ++(*m_lcp_rev_reader);
+			}
 
-			++m_s_bkt_scanned[m_cur_s_ch];
+			++m_s_bkt_scanned[m_cur_s_bkt];
 
 			++m_total_s_scanned;
 
@@ -1762,68 +2654,116 @@ private:
 
 			_sa_value = *(*m_sa_rev_reader), ++(*m_sa_rev_reader);
 
-			_lcp_value = *(*m_lcp_rev_reader), ++(*m_lcp_rev_reader);
+			if (m_sa_only) {
+
+				_lcp_value = 0;
+			}
+			else {
+
+				_lcp_value = *(*m_lcp_rev_reader), ++(*m_lcp_rev_reader);
+			}
 
-			++m_l_bkt_scanned[m_cur_l_ch];
+			++m_l_bkt_scanned[m_cur_l_bkt];
 
 			++m_total_l_scanned;
 
 			return;
 		}
 
-		/// \brief fetch the SA-value for currently induced S-type suffix and the LCP-value for the suffix and its right neighbor in SA 
+		/// \brief validate the SA-value for currently induced S-type suffix and the LCP-value for the last suffix induced into the same bucket and its left neighbor in SA
 		///
-		void fetch_s_induced(const alphabet_type _ch, size_type& _sa_value, size_type& _lcp_value) {
+		/// The latter is the LCP-value of the two induced suffixes. 
+		/// Retrieve the values from SA and LCP if read in place, otherwise defer the validation.
+		/// If building, validate the former and record the latter instead.
+		/// \param _check_lcp false if the suffix is the rightmost in the S-type bucket
+		bool check_s_induced(const uint64 _bkt, const size_type _sa_value, const size_type _lcp_value, const bool _check_lcp) {
 
-			_sa_value = *(*m_sa_s_bkt_rev_reader[_ch]), ++(*m_sa_s_bkt_rev_reader[_ch]);
+			if (!m_in_place) {
 
-			_lcp_value = *(*m_lcp_s_bkt_rev_reader[_ch]), ++(*m_lcp_s_bkt_rev_reader[_ch]);
+				if (m_s_bkt_induced[_bkt] == m_s_bkt_toscan[_bkt]) { // more suffixes than the bucket size
 
-			return;
-		}
+					std::cerr << "SA-value is wrong\n";
 
-		/// \brief get ch for the S-type bucket currently being scanned
-		///
-		alphabet_type get_s_bkt_ch() {
+					return false;
+				}
 
-			return m_cur_s_ch;
-		}
+				const uint64 pos = m_s_bkt_spos[_bkt] + m_s_bkt_toscan[_bkt] - 1 - m_s_bkt_induced[_bkt]++;
 
-		/// \brief get ch for the LMS bucket currently being scanned
-		///
-		alphabet_type get_l_bkt_ch() {
+				m_deferred_check->push_sa(pos, _sa_value);
+
+				if (_check_lcp && !m_sa_only) m_deferred_check->push_lcp(pos + 1, _lcp_value);
+
+				return true;
+			}
+
+			const size_type sa_value_fetch = m_sa_s_bkt_rev_reader->next(_bkt);
+
+			if (_sa_value != sa_value_fetch) {
+
+				std::cerr << "SA-value is wrong\n";
+
+				return false;
+			}
 
-			return m_cur_l_ch;
+			if (m_sa_only) return true;
+
+			if (m_build) {
+
+				if (_check_lcp) m_lcp_s_bkt_queue->push(_bkt, _lcp_value); // never full, as the SA-values are not
+
+				return true;
+			}
+
+			const size_type lcp_value_fetch = m_lcp_s_bkt_rev_reader->next(_bkt);
+
+			if (_check_lcp && _lcp_value != m_last_lv_induced_fetch[_bkt]) {
+
+				std::cerr << "LCP-value is wrong\n";
+
+				return false;
+			}
+
+			m_last_lv_induced_fetch[_bkt] = lcp_value_fetch;
+
+			return true;
 		}
 
-		/// \brief literally compare two suffixes pointed to by the starting positions 
+		/// \brief read back the LCP-value for the S-type suffix just scanned and its left neighbor in SA, if building
 		///
-		uint64 bruteforce_compute_lcp(const size_type& _pos1, const size_type& _pos2) {
+		/// The value was recorded when inducing the left neighbor, which happens no later than scanning the suffix.
+		/// If the suffix is the leftmost in the S-type bucket, the value is computed by compute_lcp() and recorded here.
+		/// \note call after inducing from the suffix
+		size_type fetch_s_built(const size_type _sa_value) {
 
-			typename alphabet_vector_type::const_iterator it1(m_t->begin() + _pos1), it2(m_t->begin() + _pos2);
+			if (m_s_bkt_scanned[m_cur_s_bkt] == m_s_bkt_toscan[m_cur_s_bkt]) { // leftmost in the S-type bucket
 
-			uint64 lcp = 0;
+				const size_type lcp_value = m_sa_rev_reader->empty() ? 0 : compute_lcp(*(*m_sa_rev_reader), _sa_value); // the left neighbor is next to scan
 
-			if (_pos1 < _pos2) {
+				m_lcp_s_bkt_queue->push(m_cur_s_bkt, lcp_value);
+			}
 
-				for (; it2 != m_t->end(); ++it2, ++it1) {
+			return m_lcp_s_bkt_queue->pop(m_cur_s_bkt);
+		}
 
-					if (*it1 != *it2) break;
+		/// \brief get the S-type bucket currently being scanned
+		///
+		uint64 get_s_bkt() {
 
-					++lcp;
-				}
-			}
-			else {
+			return m_cur_s_bkt;
+		}
 
-				for (; it1 != m_t->end(); ++it1, ++it2) {
+		/// \brief get the L-type bucket currently being scanned
+		///
+		uint64 get_l_bkt() {
 
-					if (*it1 != *it2) break;
+			return m_cur_l_bkt;
+		}
 
-					++lcp;
-				}
-			}
+		/// \brief compute the LCP-value of two suffixes pointed to by the starting positions, literally if short and by fingerprints if long
+		///
+		uint64 compute_lcp(const size_type& _pos1, const size_type& _pos2) {
 
-			return lcp;
+			return m_lce->compute(_pos1, _pos2);
 		}
 
 		/// \brief dtor
@@ -1834,56 +2774,51 @@ private:
 
 			delete m_lcp_rev_reader; m_lcp_rev_reader = nullptr;
 
-			for (alphabet_extension_type ch = 0; ch <= ch_max; ++ch) {
+			delete m_sa_s_bkt_rev_reader; m_sa_s_bkt_rev_reader = nullptr;
 
-				delete m_sa_s_bkt_rev_reader[ch]; m_sa_s_bkt_rev_reader[ch] = nullptr;
+			delete m_lcp_s_bkt_rev_reader; m_lcp_s_bkt_rev_reader = nullptr;
 
-				delete m_lcp_s_bkt_rev_reader[ch]; m_lcp_s_bkt_rev_reader[ch] = nullptr;
-			}
+			delete m_deferred_check; m_deferred_check = nullptr;
+
+			delete m_lcp_s_bkt_queue; m_lcp_s_bkt_queue = nullptr;
 		}
 
 		/// \brief induce and check the order of S-type suffixes and their LCP-values
 		///
 		bool run(triple2_great_sorter_1st_type* _pre_item_of_s_sorter, pair4_vector_type* _pre_item_of_l_vector) {
 
-			alphabet_type cur_bkt_ch, pre_ch;
+			uint64 cur_bkt, pre_bkt;
 
 			uint8 pre_t;
 
 			size_type sv_cur_scanned, lv_cur_scanned, sv_last_scanned = 0, lv_last_scanned = 0;
 
-			size_type sv_induced, lv_induced, sv_induced_fetch, lv_induced_fetch;
+			size_type sv_induced, lv_induced;
 
-			RMQ rmq_s;
+			RMQ rmq_s(m_bkt_num, m_dense_rmq);
 
 			bool is_rightmost = true; // indicate currently scanned is the rightmost in SA
 
 			bool flag = true; // indicate currently scanned is the rightmost in the S-type/L-type bucket
 
-			bool flags[ch_max + 1]; // indicate currently induced S-type suffix is the rightmost in the S-type bucket
-
-			for (alphabet_extension_type ch = 0; ch <= ch_max; ++ch) flags[ch] = true;
-
-			size_type last_lv_induced_fetch[ch_max + 1]; // record the LCP-value of last induced S-type suffix in the bucket
-
-			for (alphabet_extension_type ch = 0; ch <= ch_max; ++ch) last_lv_induced_fetch[ch] = 0;
+			std::vector<uint8> flags(m_bkt_num, 1); // indicate currently induced S-type suffix is the rightmost in the S-type bucket
 
 			typename pair4_vector_type::bufreader_reverse_type* pre_item_of_l_rev_reader = new typename pair4_vector_type::bufreader_reverse_type(*_pre_item_of_l_vector);
 
 			// largest suffix must be L-type
-			if (get_l_bkt_ch() <= get_s_bkt_ch()) {
+			if (get_l_bkt() <= get_s_bkt()) {
 
 				std::cerr << "the largest suffix must be L-type.\n";
 
 				return false;
 			}
 
-			cur_bkt_ch = get_l_bkt_ch();
+			cur_bkt = get_l_bkt();
 
 			while (true) {
 
 				// scan S-type bucket
-				while (!s_cur_bkt_is_empty() && get_s_bkt_ch() == cur_bkt_ch) {
+				while (!s_cur_bkt_is_empty() && get_s_bkt() == cur_bkt) {
 			
 					// step 1: retrieve SA-value and LCP-value
 					fetch_s_scanned(sv_cur_scanned, lv_cur_scanned);
@@ -1891,7 +2826,7 @@ private:
 					if (flag == true) { // rightmost in the S-type bucket
 			
 						// check lv_last scanned, must be 0 if correct
-						if (bruteforce_compute_lcp(sv_cur_scanned, sv_last_scanned) != lv_last_scanned) { 
+						if (!m_sa_only && compute_lcp(sv_cur_scanned, sv_last_scanned) != lv_last_scanned) { 
 
 							std::cerr << "LCP-value is wrong\n";
 
@@ -1902,49 +2837,32 @@ private:
 					}
 
 					// step 2: induce & validate
-					pre_ch = (*_pre_item_of_s_sorter)->second;
-
 					pre_t = (*_pre_item_of_s_sorter)->third;
 
-					++(*_pre_item_of_s_sorter);
-
 					if (pre_t == S_TYPE) {
 
-						fetch_s_induced(pre_ch, sv_induced_fetch, lv_induced_fetch);
+						pre_bkt = m_bkt_info.get_bkt((*_pre_item_of_s_sorter)->second);
 
 						sv_induced = sv_cur_scanned - 1;
 
-						if (sv_induced != sv_induced_fetch) {
-
-							std::cerr << "SA-value is wrong\n";
-
-							return false;
-						}
-						
-						if (flags[pre_ch] == true) { // rightmost in the S-type bucket
-
-							// do not validate LCP-value here, cache the LCP-value
-							flags[pre_ch] = false; 
-						}
-						else { // now the S-type bucket has at least two suffixes
-
-							// check the LCP-value of the two S-type suffixes induced into the bucket
-							lv_induced = rmq_s.get(pre_ch) + 1; 
+						// if rightmost in the S-type bucket, do not validate LCP-value here
+						// otherwise, the S-type bucket has at least two suffixes, check the LCP-value of the two S-type suffixes induced into the bucket
+						const bool is_rightmost_induced = (flags[pre_bkt] != 0);
 
-							if (lv_induced != last_lv_induced_fetch[pre_ch]) {
+						flags[pre_bkt] = false;
 
-								std::cerr << "LCP-value is wrong\n";
+						lv_induced = is_rightmost_induced ? 0 : rmq_s.get(pre_bkt) + 1; 
 
-								return false;
-							}
-						}
-						
-						last_lv_induced_fetch[pre_ch] = lv_induced_fetch;
+						if (false == check_s_induced(pre_bkt, sv_induced, lv_induced, !is_rightmost_induced)) return false;
 
 						// reset rmq
-						rmq_s.reset(pre_ch);
+						rmq_s.reset(pre_bkt);
 					}		
 
+					++(*_pre_item_of_s_sorter);
+
+					if (m_build) lv_cur_scanned = fetch_s_built(sv_cur_scanned); // known after inducing from the suffix
+
 					// step 3: update rmq
 					rmq_s.update(lv_cur_scanned);
 		
@@ -1957,7 +2875,7 @@ private:
 				flag = true;
 	
 				// scan L-type bucket
-				while (!l_cur_bkt_is_empty() && get_l_bkt_ch() == cur_bkt_ch) {
+				while (!l_cur_bkt_is_empty() && get_l_bkt() == cur_bkt) {
 
 					// step 1: retrieve SA-value and LCP-value
 					fetch_l_scanned(sv_cur_scanned, lv_cur_scanned);
@@ -1968,10 +2886,10 @@ private:
 
 							is_rightmost = false;
 						}
-						else {
+						else if (!m_sa_only && (!m_build || m_s_bkt_toscan[cur_bkt] == 0)) { // if building, lv_last_scanned of an S-type suffix is already computed by fetch_s_built()
 
 							// check the correctness of lv_last_scanned
-							if (bruteforce_compute_lcp(sv_cur_scanned, sv_last_scanned) != lv_last_scanned) {
+							if (compute_lcp(sv_cur_scanned, sv_last_scanned) != lv_last_scanned) {
 	
 								std::cerr << "LCP-value is wrong\n";
 	
@@ -1983,49 +2901,30 @@ private:
 					}
 
 					// step 2: induce & validate
-					pre_ch = (*pre_item_of_l_rev_reader)->first;
-
 					pre_t = (*pre_item_of_l_rev_reader)->second;
 
-					++(*pre_item_of_l_rev_reader);
-
 					if (pre_t == S_TYPE) {
 
-						fetch_s_induced(pre_ch, sv_induced_fetch, lv_induced_fetch);
+						pre_bkt = m_bkt_info.get_bkt((*pre_item_of_l_rev_reader)->first);
 
 						sv_induced = sv_cur_scanned - 1;
 
-						if (sv_induced != sv_induced_fetch) {
-
-							std::cerr << "SA-value is wrong\n";
-
-							return false;
-						}
-
-						if (flags[pre_ch] == true) { // rightmost in the S-type bucket
-				
-							flags[pre_ch] = false;
-						}
-						else {
-
-							// check the LCP-value of currently induced suffix and the last suffix induced
-							// into the same S-type bucket
-							lv_induced = rmq_s.get(pre_ch) + 1; 
+						// if not rightmost in the S-type bucket, check the LCP-value of currently induced suffix and the last suffix induced
+						// into the same S-type bucket
+						const bool is_rightmost_induced = (flags[pre_bkt] != 0);
 
-							if (lv_induced != last_lv_induced_fetch[pre_ch]) {
-
-								std::cerr << "LCP-value is wrong\n";
+						flags[pre_bkt] = false;
 
-								return false;
-							}
-						}
+						lv_induced = is_rightmost_induced ? 0 : rmq_s.get(pre_bkt) + 1; 
 
-						last_lv_induced_fetch[pre_ch] = lv_induced_fetch;	
+						if (false == check_s_induced(pre_bkt, sv_induced, lv_induced, !is_rightmost_induced)) return false;
 
 						// reset rmq
-						rmq_s.reset(pre_ch);
+						rmq_s.reset(pre_bkt);
 					}
 
+					++(*pre_item_of_l_rev_reader);
+
 					// step 3: update rmq
 					rmq_s.update(lv_cur_scanned);
 
@@ -2042,15 +2941,15 @@ private:
 
 					find_next_s_bkt();
 
-					cur_bkt_ch = get_s_bkt_ch();
+					cur_bkt = get_s_bkt();
 
 					if (!l_is_empty()) {
 
 						find_next_l_bkt();
 
-						if (cur_bkt_ch < get_l_bkt_ch()) {
+						if (cur_bkt < get_l_bkt()) {
 
-							cur_bkt_ch = get_l_bkt_ch();
+							cur_bkt = get_l_bkt();
 						}
 					}
 				}
@@ -2058,7 +2957,7 @@ private:
 
 					find_next_l_bkt();
 
-					cur_bkt_ch = get_l_bkt_ch();
+					cur_bkt = get_l_bkt();
 				}
 				else {
 
@@ -2068,6 +2967,10 @@ private:
 
 			delete pre_item_of_l_rev_reader; pre_item_of_l_rev_reader = nullptr;
 
+			if (m_build) return m_lcp_s_bkt_queue->finish();
+
+			if (!m_in_place) return m_deferred_check->run(m_sa, m_lcp);
+
 			return true;
 		}
 
@@ -2089,6 +2992,16 @@ private:
 
 	uint64 m_len;
 
+	std::string m_t_fn; ///< T file, reopened by LScan if running concurrently
+
+	std::string m_sa_fn; ///< SA file, also read by the bucket readers
+
+	std::string m_lcp_fn; ///< LCP file, also read by the bucket readers
+
+	Config m_config; ///< run-time settings
+
+	TmpFilePool* m_tmp_pool; ///< temporary files of the vectors written asynchronously, nullptr if not used
+
 #ifdef TEST_VALIDATE4
 	Test<alphabet_type, alphabet_extension_type, size_type>* test;
 #endif
@@ -2096,7 +3009,13 @@ private:
 public:	
 	/// \brief ctor
 	///
-	Validate4(const std::string& _t_fn, const std::string& _sa_fn, const std::string& _lcp_fn){
+	Validate4(const std::string& _t_fn, const std::string& _sa_fn, const std::string& _lcp_fn, const Config& _config = Config()) : m_t_fn(_t_fn), m_sa_fn(_sa_fn), m_lcp_fn(_lcp_fn), m_config(_config) {
+
+		m_config.t_fn = _t_fn; // read by the asynchronous streams over T
+
+		m_tmp_pool = m_config.async_io ? new TmpFilePool(_t_fn + ".tmp") : nullptr;
+
+		map_inputs();
 
 		m_t_file = new stxxl::syscall_file(_t_fn, stxxl::syscall_file::RDWR | stxxl::syscall_file::DIRECT);
 
@@ -2106,6 +3025,19 @@ public:
 
 		m_sa = new size_vector_type(m_sa_file);
 
+		m_lcp_file = nullptr, m_lcp = nullptr;
+
+#ifdef TEST_VALIDATE4
+		if (m_config.sa_only) {
+
+			std::cerr << "TEST_VALIDATE4 requires LCP\n";
+
+			exit(EXIT_FAILURE);
+		}
+#endif
+
+		if (m_config.build_lcp || m_config.sa_only) return; // the LCP file is created by build() or not given
+
 		m_lcp_file = new stxxl::syscall_file(_lcp_fn, stxxl::syscall_file::RDWR | stxxl::syscall_file::DIRECT);
 
 		m_lcp = new size_vector_type(m_lcp_file);		
@@ -2115,13 +3047,228 @@ public:
 #endif
 	}
 
+private:
+
+	/// \brief map T, SA and LCP if --mmap=on, or if --mmap=auto and they fit in half of the available memory
+	///
+	/// The scan readers, the bucket readers and the prefix fingerprints then read the mappings in place.
+	/// The LCP file to be built is not mapped, as it is written during the run.
+	void map_inputs() {
+
+		if (m_config.mmap_mode == "off") return;
+
+		std::vector<std::string> fns = {m_t_fn, m_sa_fn};
+
+		if (!m_config.build_lcp && !m_config.sa_only) fns.push_back(m_lcp_fn);
+
+		uint64 bytes = 0;
+
+		for (uint64 i = 0; i < fns.size(); ++i) bytes += BasicIO::file_size(fns[i]);
+
+		if (m_config.mmap_mode == "auto" && bytes > utility::available_memory() / 2) return;
+
+		// only T is scanned sequentially, SA and LCP are also read by the bucket readers
+		for (uint64 i = 0; i < fns.size(); ++i) utility::mapped_files().insert(fns[i], fns[i] == m_t_fn);
+
+		std::cerr << "Mapped input: " << bytes << " bytes\n";
+	}
+
+	/// \brief classify the suffixes, select the LMS ones and generate preceding items, see RetrievePre
+	void retrieve_pre(pair1_less_sorter_1st_type*& _lms_sorter, uint64& _lms_num, pair3_less_sorter_1st_type*& _pre_item_of_lms_sorter, triple2_less_sorter_1st_type*& _pre_item_of_l_sorter, triple2_great_sorter_1st_type*& _pre_item_of_s_sorter) {
+
+		RetrievePre retrieve_pre(m_t, m_sa, _lms_sorter, _lms_num, _pre_item_of_lms_sorter, _pre_item_of_l_sorter, _pre_item_of_s_sorter, m_bkt_info, m_sa_fn, m_config);
+	}
+
+	/// \brief generate SA_LMS and compute LCP_LMS without LCP, exit if SA_LMS is not sorted
+	///
+	/// \note the sorter is consumed and deleted
+	void build_lms(pair1_less_sorter_1st_type*& _lms_sorter, const uint64 _lms_num, size_vector_type*& _sa_lms, size_vector_type*& _lcp_lms) {
+
+		LMSBuild lms_build(m_t, _lms_sorter, _lms_num, m_config);
+
+		lms_build.run();
+
+		if (false == lms_build.check_order()) {
+
+			std::cerr << "SA_LMS is wrong.\n";
+
+			exit(0);
+		}
+		else {
+
+			std::cerr << "SA_LMS is right.\n";
+		}
+
+		_sa_lms = lms_build.get_sa_lms();
+
+		_lcp_lms = lms_build.get_lcp_lms();
+
+		delete _lms_sorter; _lms_sorter = nullptr;
+	}
+
+	/// \brief redirect preceding items of L-type suffixes to an external memory vector, RScan and LScan read it by their own readers
+	///
+	/// With --async-io, the vector is written to a temporary file in the background while the sorter merges.
+	///
+	/// \note the sorter is consumed and deleted
+	pair4_vector_type* redirect_pre_item_of_l(triple2_less_sorter_1st_type*& _pre_item_of_l_sorter) {
+
+		// only record pre_ch & pre_t
+		ScanWriter<pair4_vector_type>* pre_item_of_l_writer = new ScanWriter<pair4_vector_type>(_pre_item_of_l_sorter->size(), m_tmp_pool, m_config);
+
+		for (; !_pre_item_of_l_sorter->empty(); ++(*_pre_item_of_l_sorter)) {
+
+			const triple2_type& tuple = *(*_pre_item_of_l_sorter);
+
+			(*pre_item_of_l_writer) << pair4_type(tuple.second, tuple.third);
+		}
+
+		pair4_vector_type* pre_item_of_l_vector = pre_item_of_l_writer->finish();
+
+		delete pre_item_of_l_writer; pre_item_of_l_writer = nullptr;
+
+		delete _pre_item_of_l_sorter; _pre_item_of_l_sorter = nullptr;
+
+		pre_item_of_l_vector->flush(); // write back the cached pages, the two readers then only read from the disk
+
+		return pre_item_of_l_vector;
+	}
+
+	/// \brief build LCP from T and SA, instead of validating it
+	///
+	/// LCP_LMS is computed by LMSBuild. RScan and LScan then induce the remaining LCP-values as they do for validation, 
+	/// and write them to the LCP file bucket by bucket. The LCP-values of the L-type suffixes are read back by LScan, thus the scans run one by one.
+	/// SA is still validated on the way.
+	/// \note require at most MAX_BKT_READER_NUM buckets, i.e., the in-place regime of the scans
+	bool build() {
+
+		triple2_less_sorter_1st_type *pre_item_of_l_sorter = nullptr;
+
+		triple2_great_sorter_1st_type *pre_item_of_s_sorter = nullptr;
+
+		pair3_less_sorter_1st_type *pre_item_of_lms_sorter = nullptr;
+
+		pair1_less_sorter_1st_type *lms_sorter = nullptr;
+
+		uint64 lms_num = 0;
+
+		// classify the suffixes, select the LMS ones and generate preceding items
+		retrieve_pre(lms_sorter, lms_num, pre_item_of_lms_sorter, pre_item_of_l_sorter, pre_item_of_s_sorter);
+
+		m_bkt_info.display();
+
+		if (m_bkt_info.get_bkt_num() > MAX_BKT_READER_NUM) {
+
+			std::cerr << "Building LCP requires at most " << MAX_BKT_READER_NUM << " buckets\n";
+
+			exit(EXIT_FAILURE);
+		}
+
+		size_vector_type* sa_lms = nullptr, *lcp_lms = nullptr;
+
+		// generate SA_LMS and compute LCP_LMS
+		build_lms(lms_sorter, lms_num, sa_lms, lcp_lms);
+
+		// create the LCP file as large as SA, the scans fill it bucket by bucket
+		{
+			std::FILE* fp = std::fopen(m_lcp_fn.c_str(), "wb");
+
+			if (fp == nullptr || std::fclose(fp) != 0 || truncate(m_lcp_fn.c_str(), m_sa->size() * sizeof(size_type)) != 0) {
+
+				std::perror(m_lcp_fn.c_str());
+
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		pair4_vector_type* pre_item_of_l_vector = redirect_pre_item_of_l(pre_item_of_l_sorter);
+
+		bool is_right = false;
+
+		FingerprintLCE<alphabet_vector_type, fingerprint_type> lce(*m_t, m_config); // shared by the two scans
+
+		{ // compute LCP-values for L-type suffixes and their left neighbor in SA
+
+			const auto start = std::chrono::steady_clock::now();
+
+			{
+				RScan r_scan(m_bkt_info, m_t, m_sa, nullptr, sa_lms, lcp_lms, m_sa_fn, m_lcp_fn, &lce, m_config);
+
+				is_right = r_scan.run(pre_item_of_l_vector, pre_item_of_lms_sorter);
+			}
+
+			delete sa_lms; sa_lms = nullptr;
+
+			delete lcp_lms; lcp_lms = nullptr;
+
+			delete pre_item_of_lms_sorter; pre_item_of_lms_sorter = nullptr;
+
+			std::cerr << "RScan time: " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s\n";
+		}
+
+		if (is_right) { // compute LCP-values for S-type suffixes and their right neighbor in SA, LScan reads those of the L-type suffixes
+
+			const auto start = std::chrono::steady_clock::now();
+
+			m_lcp_file = new stxxl::syscall_file(m_lcp_fn, stxxl::syscall_file::RDWR | stxxl::syscall_file::DIRECT);
+
+			m_lcp = new size_vector_type(m_lcp_file);
+
+			{
+				LScan l_scan(m_bkt_info, m_t, m_sa, m_lcp, m_sa_fn, m_lcp_fn, &lce, m_config);
+
+				is_right = l_scan.run(pre_item_of_s_sorter, pre_item_of_l_vector);
+			}
+
+			std::cerr << "LScan time: " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s\n";
+		}
+
+		delete pre_item_of_l_vector; pre_item_of_l_vector = nullptr;
+
+		delete pre_item_of_s_sorter; pre_item_of_s_sorter = nullptr;
+
+		if (false == is_right) {
+
+			std::cerr << "SA is wrong, LCP is not built\n";
+
+			return false;
+		}
+
+		std::cerr << "LCP is built into " << m_lcp_fn << std::endl;
+
+		return true;
+	}
+
+public:
+
 	bool run() {
 
+		if (m_config.build_lcp) return build();
+
+		triple2_less_sorter_1st_type *pre_item_of_l_sorter = nullptr;
+
+		triple2_great_sorter_1st_type *pre_item_of_s_sorter = nullptr;
+
+		pair3_less_sorter_1st_type *pre_item_of_lms_sorter = nullptr;
+
+		pair1_less_sorter_1st_type *lms_sorter = nullptr;
+
+		uint64 lms_num = 0;
+
+		// classify the suffixes, select the LMS ones and generate preceding items
+		retrieve_pre(lms_sorter, lms_num, pre_item_of_lms_sorter, pre_item_of_l_sorter, pre_item_of_s_sorter);
+
 		size_vector_type* sa_lms = nullptr, *lcp_lms = nullptr;
 
-		{ // generate and validate SA_LMS and LCP_LMS
+		if (m_config.sa_only) { // generate and validate SA_LMS, LCP_LMS is only used for the validation
+
+			build_lms(lms_sorter, lms_num, sa_lms, lcp_lms);
+
+			delete lcp_lms; lcp_lms = nullptr;
+		}
+		else { // generate and validate SA_LMS and LCP_LMS
 
-			LMSValidate lms_validate(m_t, m_sa, m_lcp);
+			LMSValidate lms_validate(m_t, m_sa, m_lcp, lms_sorter, lms_num, m_lcp_fn, m_tmp_pool, m_config);
 
 			if (false == lms_validate.run()) {
 	
@@ -2137,6 +3284,8 @@ public:
 			sa_lms = lms_validate.get_sa_lms();
 
 			lcp_lms = lms_validate.get_lcp_lms();
+
+			delete lms_sorter; lms_sorter = nullptr;
 		}
 
 #ifdef TEST_VALIDATE4
@@ -2154,19 +3303,21 @@ public:
 		}		
 #endif
 
-		triple2_less_sorter_1st_type *pre_item_of_l_sorter = nullptr;
+		m_bkt_info.display();
 
-		triple2_great_sorter_1st_type *pre_item_of_s_sorter = nullptr;
+		if (m_bkt_info.get_bkt_num() > MAX_BKT_READER_NUM) {
 
-		pair3_less_sorter_1st_type *pre_item_of_lms_sorter = nullptr;
+			std::cerr << "Induced values: validated after the induction\n";
+		}
 
-		{ // generate preceding items
+		if (m_config.rmq_dense && m_bkt_info.get_bkt_num() <= RMQ::DENSE_NUM) {
 
-			RetrievePre retrieve_pre(m_t, m_sa, pre_item_of_lms_sorter, pre_item_of_l_sorter, pre_item_of_s_sorter, m_bkt_info);
+			std::cerr << "RMQ: dense, kernel: " << MinBroadcast::get().m_name << std::endl;
 		}
+		else {
 
-
-		m_bkt_info.display();
+			std::cerr << "RMQ: stack\n";
+		}
 
 #ifdef TEST_VALIDATE4
 
@@ -2185,71 +3336,140 @@ public:
 		}
 #endif
 
-		{ // validate SA-values for L-type suffixes and LCP-values for these suffixes and their left neighbor in SA
-	
-			RScan r_scan(m_bkt_info, m_t, m_sa, m_lcp, sa_lms, lcp_lms);
+		pair4_vector_type* pre_item_of_l_vector = redirect_pre_item_of_l(pre_item_of_l_sorter);
 
-			if (false == r_scan.run(pre_item_of_l_sorter, pre_item_of_lms_sorter)) {
+		// LScan reads T, SA and LCP by its own streams if running concurrently with RScan
+		stxxl::syscall_file* l_t_file = nullptr, *l_sa_file = nullptr, *l_lcp_file = nullptr;
 
-				std::cerr << "RScan is wrong\n";
+		alphabet_vector_type* l_t = m_t;
 
-				exit(0);
+		size_vector_type* l_sa = m_sa, *l_lcp = m_lcp;
+
+		if (m_config.concurrent_scan) {
+
+			l_t_file = new stxxl::syscall_file(m_t_fn, stxxl::syscall_file::RDONLY | stxxl::syscall_file::DIRECT);
+
+			l_t = new alphabet_vector_type(l_t_file);
+
+			l_sa_file = new stxxl::syscall_file(m_sa_fn, stxxl::syscall_file::RDONLY | stxxl::syscall_file::DIRECT);
+
+			l_sa = new size_vector_type(l_sa_file);
+
+			if (!m_config.sa_only) {
+
+				l_lcp_file = new stxxl::syscall_file(m_lcp_fn, stxxl::syscall_file::RDONLY | stxxl::syscall_file::DIRECT);
+
+				l_lcp = new size_vector_type(l_lcp_file);
 			}
-			else {
+		}
+
+		// one set of fingerprint samples for the LCE queries of both scans, loaded or recorded before they run concurrently
+		FingerprintLCE<alphabet_vector_type, fingerprint_type> r_lce(*m_t, m_config);
+
+		FingerprintLCE<alphabet_vector_type, fingerprint_type>* l_lce = &r_lce;
+
+		if (m_config.concurrent_scan) {
+
+			r_lce.prepare();
+
+			l_lce = new FingerprintLCE<alphabet_vector_type, fingerprint_type>(*l_t, r_lce);
+		}
+
+		bool r_right = false, l_right = false;
+
+		double r_time = 0, l_time = 0;
+
+		// validate SA-values for L-type suffixes and LCP-values for these suffixes and their left neighbor in SA
+		auto r_task = [&]() {
 
-				std::cerr << "RScan is right\n";
+			const auto start = std::chrono::steady_clock::now();
+
+			{
+				RScan r_scan(m_bkt_info, m_t, m_sa, m_lcp, sa_lms, lcp_lms, m_sa_fn, m_lcp_fn, &r_lce, m_config);
+
+				r_right = r_scan.run(pre_item_of_l_vector, pre_item_of_lms_sorter);
 			}
 
+			// only used by RScan
 			delete sa_lms; sa_lms = nullptr;
 
 			delete lcp_lms; lcp_lms = nullptr;
 
 			delete pre_item_of_lms_sorter; pre_item_of_lms_sorter = nullptr;
+
+			r_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		};
+
+		// validate SA-values for S-type suffixes and LCP-values for these suffixes and their right neighbor in SA
+		auto l_task = [&]() {
+
+			const auto start = std::chrono::steady_clock::now();
+
+			LScan l_scan(m_bkt_info, l_t, l_sa, l_lcp, m_sa_fn, m_lcp_fn, l_lce, m_config);
+
+			l_right = l_scan.run(pre_item_of_s_sorter, pre_item_of_l_vector);
+
+			l_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		};
+
+		if (m_config.concurrent_scan) {
+
+			run_parallel(2, [&](const uint64 _k) { if (_k == 0) r_task(); else l_task(); });
 		}
-	
-		{ // validate SA-values for S-type suffixes and LCP-values for these suffixes and their right neighbor in SA
+		else {
 
-			// redirect preceding items of L-type suffixes to an external memory vector
-			pre_item_of_l_sorter->sort(); // resort
+			r_task();
 
-			pair4_vector_type* pre_item_of_l_vector = new pair4_vector_type(); // only record pre_ch & pre_t
+			if (r_right) l_task();
+		}
 
-			pre_item_of_l_vector->resize(pre_item_of_l_sorter->size());
+		std::cerr << "RScan time: " << r_time << " s\n";
 
-			typename pair4_vector_type::bufwriter_type* pre_item_of_l_writer = new typename pair4_vector_type::bufwriter_type(*pre_item_of_l_vector);
+		if (false == r_right) {
 
-			for (; !pre_item_of_l_sorter->empty(); ++(*pre_item_of_l_sorter)) {
+			std::cerr << "RScan is wrong\n";
 
-				const triple2_type& tuple = *(*pre_item_of_l_sorter);
+			exit(0);
+		}
+		else {
 
-				(*pre_item_of_l_writer) << pair4_type(tuple.second, tuple.third);
-			}
+			std::cerr << "RScan is right\n";
+		}
 
-			(*pre_item_of_l_writer).finish();
+		std::cerr << "LScan time: " << l_time << " s\n";
 
-			delete pre_item_of_l_writer; pre_item_of_l_writer = nullptr;
+		if (false == l_right) {
 
-			delete pre_item_of_l_sorter; pre_item_of_l_sorter = nullptr;
+			std::cerr << "LScan is wrong\n";
 
-			//
-			LScan l_scan(m_bkt_info, m_t, m_sa, m_lcp);
+			exit(0);
+		}
+		else {
 
-			if (false == l_scan.run(pre_item_of_s_sorter, pre_item_of_l_vector)) {
+			std::cerr << "LScan is right\n";
+		}
 
-				std::cerr << "LScan is wrong\n";
+		if (m_config.concurrent_scan) {
 
-				exit(0);
-			}
-			else {
+			delete l_lce; l_lce = nullptr;
 
-				std::cerr << "LScan is right\n";
-			}
+			delete l_t; l_t = nullptr;
+
+			delete l_t_file; l_t_file = nullptr;
+
+			delete l_sa; l_sa = nullptr;
+
+			delete l_sa_file; l_sa_file = nullptr;
 
-			delete pre_item_of_l_vector; pre_item_of_l_vector = nullptr;
+			delete l_lcp; l_lcp = nullptr;
 
-			delete pre_item_of_s_sorter; pre_item_of_s_sorter = nullptr;
+			delete l_lcp_file; l_lcp_file = nullptr;
 		}
 
+		delete pre_item_of_l_vector; pre_item_of_l_vector = nullptr;
+
+		delete pre_item_of_s_sorter; pre_item_of_s_sorter = nullptr;
+
 		return true;
 	}
 
@@ -2266,6 +3486,10 @@ public:
 		delete m_lcp; m_lcp = nullptr;
 
 		delete m_lcp_file; m_lcp_file = nullptr;
+
+		delete m_tmp_pool; m_tmp_pool = nullptr;
+
+		utility::mapped_files().clear();
 	}
 };
 